@@ -0,0 +1,368 @@
+#include "AlgebraicMultigrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Matrix = AlgebraicMultigrid::Matrix;
+constexpr int kRhs = AlgebraicMultigrid::kRhs;
+
+Matrix transpose(const Matrix &A) {
+  Matrix T;
+  T.rows = A.cols;
+  T.cols = A.rows;
+  T.rowStart.assign(T.rows + 1, 0);
+  for (int c : A.colIdx)
+    T.rowStart[c + 1]++;
+  for (int i = 0; i < T.rows; ++i)
+    T.rowStart[i + 1] += T.rowStart[i];
+  T.colIdx.resize(A.colIdx.size());
+  T.vals.resize(A.vals.size());
+  std::vector<int> cursor(T.rowStart.begin(), T.rowStart.end() - 1);
+  // Walking A's rows in order leaves T's columns sorted
+  for (int i = 0; i < A.rows; ++i) {
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      int pos = cursor[A.colIdx[k]]++;
+      T.colIdx[pos] = i;
+      T.vals[pos] = A.vals[k];
+    }
+  }
+  return T;
+}
+
+// Sparse product with a dense accumulator row
+Matrix multiply(const Matrix &A, const Matrix &B) {
+  Matrix C;
+  C.rows = A.rows;
+  C.cols = B.cols;
+  C.rowStart.assign(C.rows + 1, 0);
+  std::vector<double> acc(B.cols, 0.0);
+  std::vector<int> marker(B.cols, -1);
+  std::vector<int> touched;
+  for (int i = 0; i < A.rows; ++i) {
+    touched.clear();
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      const double a = A.vals[k];
+      const int j = A.colIdx[k];
+      for (int l = B.rowStart[j]; l < B.rowStart[j + 1]; ++l) {
+        int c = B.colIdx[l];
+        if (marker[c] != i) {
+          marker[c] = i;
+          acc[c] = 0.0;
+          touched.push_back(c);
+        }
+        acc[c] += a * B.vals[l];
+      }
+    }
+    std::sort(touched.begin(), touched.end());
+    for (int c : touched) {
+      C.colIdx.push_back(c);
+      C.vals.push_back(acc[c]);
+    }
+    C.rowStart[i + 1] = (int)C.colIdx.size();
+  }
+  return C;
+}
+
+double diagonal(const Matrix &A, int i) {
+  for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+    if (A.colIdx[k] == i)
+      return A.vals[k];
+  }
+  return 0.0;
+}
+
+// Greedy aggregation over the strong connections; returns the aggregate of
+// every unknown and sets count.
+std::vector<int> aggregate(const Matrix &A, const std::vector<double> &diag,
+                           int &count) {
+  const int n = A.rows;
+  auto strong = [&](int i, int k) {
+    int j = A.colIdx[k];
+    return j != i && std::abs(A.vals[k]) >=
+                         AlgebraicMultigrid::kStrength *
+                             std::sqrt(std::abs(diag[i] * diag[j]));
+  };
+
+  std::vector<int> agg(n, -1);
+  count = 0;
+
+  // 1. Seed an aggregate at every node whose strong neighbourhood is free
+  for (int i = 0; i < n; ++i) {
+    if (agg[i] >= 0)
+      continue;
+    bool free = true;
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1] && free; ++k) {
+      if (strong(i, k) && agg[A.colIdx[k]] >= 0)
+        free = false;
+    }
+    if (!free)
+      continue;
+    agg[i] = count;
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      if (strong(i, k))
+        agg[A.colIdx[k]] = count;
+    }
+    ++count;
+  }
+
+  // 2. Attach leftovers to the aggregate they are most strongly tied to
+  std::vector<int> seeded = agg;
+  for (int i = 0; i < n; ++i) {
+    if (agg[i] >= 0)
+      continue;
+    double best = 0.0;
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      int j = A.colIdx[k];
+      if (strong(i, k) && seeded[j] >= 0 && std::abs(A.vals[k]) > best) {
+        best = std::abs(A.vals[k]);
+        agg[i] = seeded[j];
+      }
+    }
+  }
+
+  // 3. Whatever is left (weakly connected nodes) forms its own aggregates
+  for (int i = 0; i < n; ++i) {
+    if (agg[i] >= 0)
+      continue;
+    agg[i] = count;
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      if (strong(i, k) && agg[A.colIdx[k]] < 0)
+        agg[A.colIdx[k]] = count;
+    }
+    ++count;
+  }
+  return agg;
+}
+
+// P = (I - omega D^-1 A) P_tent with P_tent the aggregate indicator
+Matrix smoothedProlongation(const Matrix &A, const std::vector<double> &diag,
+                            const std::vector<int> &agg, int count) {
+  // Gershgorin bound on the spectral radius of D^-1 A
+  double rho = 0.0;
+  for (int i = 0; i < A.rows; ++i) {
+    double sum = 0.0;
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k)
+      sum += std::abs(A.vals[k]);
+    rho = std::max(rho, sum / diag[i]);
+  }
+  const double omega = rho > 0.0 ? 4.0 / (3.0 * rho) : 0.0;
+
+  Matrix P;
+  P.rows = A.rows;
+  P.cols = count;
+  P.rowStart.assign(P.rows + 1, 0);
+  std::vector<double> acc(count, 0.0);
+  std::vector<int> marker(count, -1);
+  std::vector<int> touched;
+  for (int i = 0; i < A.rows; ++i) {
+    touched.clear();
+    auto add = [&](int c, double v) {
+      if (marker[c] != i) {
+        marker[c] = i;
+        acc[c] = 0.0;
+        touched.push_back(c);
+      }
+      acc[c] += v;
+    };
+    add(agg[i], 1.0);
+    const double scale = omega / diag[i];
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k)
+      add(agg[A.colIdx[k]], -scale * A.vals[k]);
+    std::sort(touched.begin(), touched.end());
+    for (int c : touched) {
+      if (acc[c] == 0.0)
+        continue;
+      P.colIdx.push_back(c);
+      P.vals.push_back(acc[c]);
+    }
+    P.rowStart[i + 1] = (int)P.colIdx.size();
+  }
+  return P;
+}
+
+// y += M x over interleaved columns
+void multiplyAdd(const Matrix &M, const std::vector<double> &x,
+                 std::vector<double> &y) {
+  for (int i = 0; i < M.rows; ++i) {
+    double acc[kRhs] = {0.0, 0.0, 0.0};
+    for (int k = M.rowStart[i]; k < M.rowStart[i + 1]; ++k) {
+      const double m = M.vals[k];
+      const double *xc = &x[kRhs * M.colIdx[k]];
+      acc[0] += m * xc[0];
+      acc[1] += m * xc[1];
+      acc[2] += m * xc[2];
+    }
+    for (int c = 0; c < kRhs; ++c)
+      y[kRhs * i + c] += acc[c];
+  }
+}
+
+} // namespace
+
+AlgebraicMultigrid::AlgebraicMultigrid(const Matrix &A) {
+  if (A.rows == 0)
+    return;
+
+  Level fine;
+  fine.A = A;
+  _levels.push_back(std::move(fine));
+
+  while (true) {
+    Level &level = _levels.back();
+    const int n = level.A.rows;
+    std::vector<double> diag(n);
+    level.invDiag.resize(n);
+    for (int i = 0; i < n; ++i) {
+      diag[i] = diagonal(level.A, i);
+      level.invDiag[i] = 1.0 / diag[i];
+    }
+    level.x.assign((size_t)kRhs * n, 0.0);
+    level.b.assign((size_t)kRhs * n, 0.0);
+    level.r.assign((size_t)kRhs * n, 0.0);
+
+    if (n <= kMaxCoarseSize || (int)_levels.size() == kMaxLevels)
+      break;
+
+    int count = 0;
+    std::vector<int> agg = aggregate(level.A, diag, count);
+    if (count > 0.9 * n) // Not coarsening any more
+      break;
+
+    Level coarse;
+    level.P = smoothedProlongation(level.A, diag, agg, count);
+    level.R = transpose(level.P);
+    coarse.A = multiply(level.R, multiply(level.A, level.P));
+    _levels.push_back(std::move(coarse));
+  }
+
+  factorCoarsest();
+}
+
+void AlgebraicMultigrid::factorCoarsest() {
+  const Matrix &A = _levels.back().A;
+  const int n = A.rows;
+  _coarseFactor.assign((size_t)n * n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k)
+      _coarseFactor[(size_t)i * n + A.colIdx[k]] = A.vals[k];
+  }
+
+  double *L = _coarseFactor.data();
+  for (int j = 0; j < n; ++j) {
+    const double original = L[(size_t)j * n + j];
+    double d = original;
+    for (int k = 0; k < j; ++k)
+      d -= L[(size_t)j * n + k] * L[(size_t)j * n + k];
+    // Guard against a singular coarse operator (an unanchored component)
+    const double ljj = std::sqrt(d > 1e-12 * original ? d : original);
+    L[(size_t)j * n + j] = ljj;
+    for (int i = j + 1; i < n; ++i) {
+      double s = L[(size_t)i * n + j];
+      for (int k = 0; k < j; ++k)
+        s -= L[(size_t)i * n + k] * L[(size_t)j * n + k];
+      L[(size_t)i * n + j] = s / ljj;
+    }
+    for (int k = j + 1; k < n; ++k)
+      L[(size_t)j * n + k] = 0.0;
+  }
+}
+
+void AlgebraicMultigrid::solveCoarsest(const Level &level) const {
+  const int n = level.A.rows;
+  const double *L = _coarseFactor.data();
+  std::vector<double> &x = level.x;
+  x = level.b;
+  // Forward with L, then backward with L^T
+  for (int i = 0; i < n; ++i) {
+    for (int k = 0; k < i; ++k) {
+      for (int c = 0; c < kRhs; ++c)
+        x[kRhs * i + c] -= L[(size_t)i * n + k] * x[kRhs * k + c];
+    }
+    for (int c = 0; c < kRhs; ++c)
+      x[kRhs * i + c] /= L[(size_t)i * n + i];
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    for (int k = i + 1; k < n; ++k) {
+      for (int c = 0; c < kRhs; ++c)
+        x[kRhs * i + c] -= L[(size_t)k * n + i] * x[kRhs * k + c];
+    }
+    for (int c = 0; c < kRhs; ++c)
+      x[kRhs * i + c] /= L[(size_t)i * n + i];
+  }
+}
+
+void AlgebraicMultigrid::smoothForward(const Level &level) {
+  const Matrix &A = level.A;
+  for (int i = 0; i < A.rows; ++i) {
+    double acc[kRhs] = {level.b[kRhs * i], level.b[kRhs * i + 1],
+                        level.b[kRhs * i + 2]};
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      int j = A.colIdx[k];
+      if (j == i)
+        continue;
+      for (int c = 0; c < kRhs; ++c)
+        acc[c] -= A.vals[k] * level.x[kRhs * j + c];
+    }
+    for (int c = 0; c < kRhs; ++c)
+      level.x[kRhs * i + c] = acc[c] * level.invDiag[i];
+  }
+}
+
+void AlgebraicMultigrid::smoothBackward(const Level &level) {
+  const Matrix &A = level.A;
+  for (int i = A.rows - 1; i >= 0; --i) {
+    double acc[kRhs] = {level.b[kRhs * i], level.b[kRhs * i + 1],
+                        level.b[kRhs * i + 2]};
+    for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k) {
+      int j = A.colIdx[k];
+      if (j == i)
+        continue;
+      for (int c = 0; c < kRhs; ++c)
+        acc[c] -= A.vals[k] * level.x[kRhs * j + c];
+    }
+    for (int c = 0; c < kRhs; ++c)
+      level.x[kRhs * i + c] = acc[c] * level.invDiag[i];
+  }
+}
+
+void AlgebraicMultigrid::cycle(size_t k) const {
+  const Level &level = _levels[k];
+  if (k + 1 == _levels.size()) {
+    solveCoarsest(level);
+    return;
+  }
+
+  smoothForward(level);
+
+  // r = b - A x, restricted as the coarse right-hand side
+  level.r = level.b;
+  for (int i = 0; i < level.A.rows; ++i) {
+    for (int l = level.A.rowStart[i]; l < level.A.rowStart[i + 1]; ++l) {
+      const double a = level.A.vals[l];
+      const int j = level.A.colIdx[l];
+      for (int c = 0; c < kRhs; ++c)
+        level.r[kRhs * i + c] -= a * level.x[kRhs * j + c];
+    }
+  }
+
+  const Level &coarse = _levels[k + 1];
+  std::fill(coarse.b.begin(), coarse.b.end(), 0.0);
+  multiplyAdd(level.R, level.r, coarse.b);
+  std::fill(coarse.x.begin(), coarse.x.end(), 0.0);
+  cycle(k + 1);
+  multiplyAdd(level.P, coarse.x, level.x);
+
+  smoothBackward(level);
+}
+
+void AlgebraicMultigrid::apply(const std::vector<double> &b,
+                               std::vector<double> &x) const {
+  if (_levels.empty())
+    return;
+  const Level &fine = _levels.front();
+  std::copy(b.begin(), b.begin() + fine.b.size(), fine.b.begin());
+  std::fill(fine.x.begin(), fine.x.end(), 0.0);
+  cycle(0);
+  std::copy(fine.x.begin(), fine.x.end(), x.begin());
+}
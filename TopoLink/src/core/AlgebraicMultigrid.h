@@ -0,0 +1,70 @@
+#ifndef ALGEBRAICMULTIGRID_H
+#define ALGEBRAICMULTIGRID_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Smoothed-aggregation algebraic multigrid for sparse SPD systems.
+ *
+ * Built for the face-group Laplacians, which have no grid structure to
+ * coarsen geometrically. Each level groups strongly connected unknowns
+ * into aggregates, smooths the piecewise-constant prolongation with one
+ * damped Jacobi step and forms the Galerkin coarse operator P^T A P. The
+ * coarsest level is solved densely.
+ *
+ * The setup depends only on the matrix, so one hierarchy serves any number
+ * of right-hand sides. Vectors hold kRhs interleaved columns, matching
+ * SparseSolver.
+ */
+class AlgebraicMultigrid {
+public:
+  static constexpr int kRhs = 3;
+  static constexpr int kMaxCoarseSize = 40;
+  static constexpr int kMaxLevels = 20;
+  static constexpr double kStrength = 0.08;
+
+  /** @brief Compressed sparse row matrix, columns sorted within a row. */
+  struct Matrix {
+    int rows = 0;
+    int cols = 0;
+    std::vector<int> rowStart;
+    std::vector<int> colIdx;
+    std::vector<double> vals;
+  };
+
+  /** @brief Builds the hierarchy for the symmetric positive definite A. */
+  explicit AlgebraicMultigrid(const Matrix &A);
+
+  /**
+   * @brief Applies one V-cycle to A x = b starting from x = 0.
+   *
+   * Symmetric Gauss-Seidel smoothing keeps the cycle a symmetric operator,
+   * so it can precondition conjugate gradients.
+   */
+  void apply(const std::vector<double> &b, std::vector<double> &x) const;
+
+  int numLevels() const { return (int)_levels.size(); }
+  int levelSize(int level) const { return _levels[level].A.rows; }
+
+private:
+  struct Level {
+    Matrix A;
+    std::vector<double> invDiag;
+    Matrix P; // prolongation from the next coarser level
+    Matrix R; // P^T
+    // Scratch for the cycle
+    mutable std::vector<double> x, b, r;
+  };
+
+  static void smoothForward(const Level &level);
+  static void smoothBackward(const Level &level);
+  void cycle(size_t k) const;
+  void factorCoarsest();
+  void solveCoarsest(const Level &level) const;
+
+  std::vector<Level> _levels;
+  std::vector<double> _coarseFactor; // dense Cholesky factor, row-major
+};
+
+#endif // ALGEBRAICMULTIGRID_H
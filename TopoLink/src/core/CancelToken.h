@@ -0,0 +1,63 @@
+#ifndef CANCELTOKEN_H
+#define CANCELTOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Stop request shared between a long computation and whoever
+ * started it.
+ *
+ * The computation polls stopRequested() at points where it can stop with a
+ * usable result, e.g. once per sweep. A stop is requested either explicitly
+ * through cancel(), from any thread, or by a wall-clock deadline passing.
+ * Both are kept apart so the computation can tell a user abort (discard
+ * unfinished work) from a spent time budget (keep the best result so far).
+ */
+class CancelToken {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /** @brief Clears the cancel request and the deadline. */
+  void reset() {
+    _cancelled = false;
+    _deadline = 0;
+  }
+
+  void cancel() { _cancelled = true; }
+
+  /**
+   * @brief Requests a stop once seconds have passed from now; zero or less
+   * removes the deadline.
+   */
+  void setTimeBudget(double seconds) {
+    if (!(seconds > 0.0)) {
+      _deadline = 0;
+      return;
+    }
+    auto budget = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+    _deadline = (Clock::now() + budget).time_since_epoch().count();
+  }
+
+  bool isCancelled() const { return _cancelled; }
+
+  bool isExpired() const {
+    int64_t deadline = _deadline;
+    return deadline != 0 && Clock::now().time_since_epoch().count() >= deadline;
+  }
+
+  bool stopRequested() const { return isCancelled() || isExpired(); }
+
+  /** @brief Null-safe stopRequested() for optional tokens. */
+  static bool shouldStop(const CancelToken *token) {
+    return token && token->stopRequested();
+  }
+
+private:
+  std::atomic<bool> _cancelled{false};
+  std::atomic<int64_t> _deadline{0}; // Clock ticks since epoch; 0 = none
+};
+
+#endif // CANCELTOKEN_H
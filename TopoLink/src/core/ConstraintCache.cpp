@@ -0,0 +1,80 @@
+#include "ConstraintCache.h"
+
+#include <BRep_Builder.hxx>
+#include <QMutexLocker>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <algorithm>
+
+void ConstraintCache::setGeometryMaps(const void *faceMap,
+                                      const void *edgeMap) {
+  QMutexLocker locker(&_mutex);
+  _faceMap = faceMap;
+  _edgeMap = edgeMap;
+  _targets.clear();
+  _stats = Stats();
+}
+
+ConstraintCache::TargetPtr ConstraintCache::find(const QList<int> &ids,
+                                                 bool isEdge) {
+  return find(std::vector<int>(ids.begin(), ids.end()), isEdge);
+}
+
+ConstraintCache::TargetPtr ConstraintCache::find(std::vector<int> key,
+                                                 bool isEdge) {
+  std::sort(key.begin(), key.end());
+  key.erase(std::unique(key.begin(), key.end()), key.end());
+
+  QMutexLocker locker(&_mutex);
+  auto it = _targets.find({isEdge, key});
+  if (it != _targets.end()) {
+    ++_stats.hits;
+    return it->second;
+  }
+
+  // Built under the lock: construction only gathers sub-shapes, the
+  // expensive surface setup happens lazily on first projection
+  ++_stats.misses;
+  TopoDS_Shape shape = buildShape(key, isEdge);
+  TargetPtr target;
+  if (!shape.IsNull())
+    target = std::make_shared<const ProjectionTarget>(shape);
+  _targets.emplace(std::make_pair(isEdge, std::move(key)), target);
+  return target;
+}
+
+void ConstraintCache::clear() {
+  QMutexLocker locker(&_mutex);
+  _targets.clear();
+  _stats = Stats();
+}
+
+ConstraintCache::Stats ConstraintCache::stats() const {
+  QMutexLocker locker(&_mutex);
+  return _stats;
+}
+
+TopoDS_Shape ConstraintCache::buildShape(const std::vector<int> &ids,
+                                         bool isEdge) const {
+  if (ids.empty())
+    return TopoDS_Shape();
+  if (!_faceMap || !_edgeMap)
+    return TopoDS_Shape();
+
+  TopoDS_Compound comp;
+  BRep_Builder B;
+  B.MakeCompound(comp);
+  bool added = false;
+
+  const TopTools_IndexedMapOfShape *map =
+      static_cast<const TopTools_IndexedMapOfShape *>(isEdge ? _edgeMap
+                                                             : _faceMap);
+
+  for (int id : ids) {
+    if (id > 0 && id <= map->Extent()) {
+      B.Add(comp, map->FindKey(id));
+      added = true;
+    }
+  }
+  return added ? comp : TopoDS_Shape();
+}
@@ -0,0 +1,60 @@
+#ifndef CONSTRAINTCACHE_H
+#define CONSTRAINTCACHE_H
+
+#include "ProjectionTarget.h"
+#include <QList>
+#include <QMutex>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Constraint compounds with their projection setup, keyed by the set
+ * of CAD face or edge IDs they are built from.
+ *
+ * Many edges and faces share a constraint (the same CAD face, or the same
+ * curve between two node groups), so each distinct ID set is turned into a
+ * compound and a ProjectionTarget once and then shared. Targets are
+ * immutable apart from their internal evaluator pool, so one entry may be
+ * used by any number of threads at once. find() is thread-safe.
+ */
+class ConstraintCache {
+public:
+  using TargetPtr = std::shared_ptr<const ProjectionTarget>;
+
+  struct Stats {
+    int hits = 0;
+    int misses = 0;
+  };
+
+  /**
+   * @brief Sets the ID -> shape lookups (TopTools_IndexedMapOfShape*, not
+   * owned) and drops all entries and counts.
+   */
+  void setGeometryMaps(const void *faceMap, const void *edgeMap);
+
+  /**
+   * @brief Target for the given IDs; order and repeats do not matter.
+   * @return Null if none of the IDs names a shape
+   */
+  TargetPtr find(const QList<int> &ids, bool isEdge);
+  TargetPtr find(std::vector<int> ids, bool isEdge);
+
+  /** @brief Drops all entries and resets the counts. */
+  void clear();
+
+  Stats stats() const;
+
+private:
+  TopoDS_Shape buildShape(const std::vector<int> &ids, bool isEdge) const;
+
+  const void *_faceMap = nullptr;
+  const void *_edgeMap = nullptr;
+
+  mutable QMutex _mutex;
+  std::map<std::pair<bool, std::vector<int>>, TargetPtr> _targets;
+  Stats _stats;
+};
+
+#endif // CONSTRAINTCACHE_H
@@ -0,0 +1,82 @@
+#include "ConvergenceTelemetry.h"
+#include <QMutexLocker>
+#include <unordered_map>
+
+namespace {
+
+std::atomic<uint64_t> nextSerial{1};
+
+int roundUpToPowerOfTwo(int n) {
+  int p = 1;
+  while (p < n)
+    p <<= 1;
+  return p;
+}
+
+} // namespace
+
+struct ConvergenceTelemetry::Ring {
+  explicit Ring(int capacity) : slots(capacity), mask(capacity - 1) {}
+
+  std::vector<Sample> slots;
+  const uint64_t mask;
+  // Producer and consumer positions on separate cache lines
+  alignas(64) std::atomic<uint64_t> tail{0}; // Next slot to write
+  alignas(64) std::atomic<uint64_t> head{0}; // Next slot to read
+  std::atomic<uint64_t> dropped{0};
+};
+
+ConvergenceTelemetry::ConvergenceTelemetry(int capacity)
+    : _serial(nextSerial.fetch_add(1)),
+      _capacity(roundUpToPowerOfTwo(capacity)) {}
+
+ConvergenceTelemetry::~ConvergenceTelemetry() {}
+
+ConvergenceTelemetry::Ring *ConvergenceTelemetry::localRing() {
+  // Serials are never reused, so entries of destroyed instances are
+  // simply never looked up again
+  thread_local std::unordered_map<uint64_t, Ring *> rings;
+  auto it = rings.find(_serial);
+  if (it != rings.end())
+    return it->second;
+
+  QMutexLocker locker(&_mutex);
+  _rings.push_back(std::make_unique<Ring>(_capacity));
+  Ring *ring = _rings.back().get();
+  rings.emplace(_serial, ring);
+  return ring;
+}
+
+bool ConvergenceTelemetry::push(const Sample &sample) {
+  Ring *ring = localRing();
+  uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+  if (tail - ring->head.load(std::memory_order_acquire) > ring->mask) {
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  ring->slots[tail & ring->mask] = sample;
+  ring->tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+int ConvergenceTelemetry::drain(std::vector<Sample> &out) {
+  QMutexLocker locker(&_mutex);
+  int count = 0;
+  for (const auto &ring : _rings) {
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    for (uint64_t k = head; k != tail; ++k)
+      out.push_back(ring->slots[k & ring->mask]);
+    count += (int)(tail - head);
+    ring->head.store(tail, std::memory_order_release);
+  }
+  return count;
+}
+
+uint64_t ConvergenceTelemetry::dropped() const {
+  QMutexLocker locker(&_mutex);
+  uint64_t total = 0;
+  for (const auto &ring : _rings)
+    total += ring->dropped.load(std::memory_order_relaxed);
+  return total;
+}
@@ -0,0 +1,65 @@
+#ifndef CONVERGENCETELEMETRY_H
+#define CONVERGENCETELEMETRY_H
+
+#include <QMutex>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Per-iteration solver errors passed from worker threads to a
+ * polling reader without locks or events.
+ *
+ * Every thread that pushes gets its own single-producer single-consumer
+ * ring, so a push is a plain store and an atomic publish. One reader,
+ * typically a GUI timer, drains all rings at its own rate. A ring that is
+ * full drops the new sample and counts it; the samples are meant for live
+ * display, so the complete history has to be kept elsewhere.
+ */
+class ConvergenceTelemetry {
+public:
+  struct Sample {
+    int id;        // -edgeId for edges, face ID for faces
+    int iteration;
+    double error;
+  };
+
+  /** @param capacity Samples per thread, rounded up to a power of two */
+  explicit ConvergenceTelemetry(int capacity = 1 << 14);
+  ~ConvergenceTelemetry();
+
+  ConvergenceTelemetry(const ConvergenceTelemetry &) = delete;
+  ConvergenceTelemetry &operator=(const ConvergenceTelemetry &) = delete;
+
+  /**
+   * @brief Queues a sample; safe from any number of threads at once.
+   *
+   * Wait-free except for a thread's first push, which registers its ring.
+   * @return False if the thread's ring was full and the sample dropped
+   */
+  bool push(const Sample &sample);
+
+  /**
+   * @brief Appends every queued sample to out, ring by ring and in push
+   * order within a ring. Only one thread may drain at a time.
+   * @return Number of samples appended
+   */
+  int drain(std::vector<Sample> &out);
+
+  /** @brief Samples dropped so far because a ring was full. */
+  uint64_t dropped() const;
+
+private:
+  struct Ring;
+
+  Ring *localRing();
+
+  const uint64_t _serial; // Tells instances apart in the thread caches
+  const int _capacity;
+
+  mutable QMutex _mutex; // Guards the list, not the rings
+  std::vector<std::unique_ptr<Ring>> _rings;
+};
+
+#endif // CONVERGENCETELEMETRY_H
@@ -1,82 +1,519 @@
 #include "EllipticSolver.h"
+#include "CancelToken.h"
+#include "FastPoissonSolver.h"
+#include "MultigridSolver.h"
+#include "ProjectionSchedule.h"
+#include "RelaxationControl.h"
+#include "StencilKernels.h"
+#include <QtConcurrent>
+#include <algorithm>
 #include <cmath>
 
+namespace {
+
+// Rows handed to one worker per colour sweep. Fixed (not derived from the
+// thread count) so the work split is identical on every machine.
+constexpr int kRowsPerTask = 8;
+
+// Average of the up to four neighbours of point (i, j); false if it has
+// none
+inline bool neighbourAverage(const StructuredGrid &grid, int i, int j,
+                             gp_XYZ &average) {
+  const int M = grid.rows() - 1;
+  const int N = grid.cols() - 1;
+  const int stride = grid.stride();
+  const int k = i * stride + j;
+  const double *x = grid.x();
+  const double *y = grid.y();
+  const double *z = grid.z();
+
+  double sx = 0.0, sy = 0.0, sz = 0.0;
+  int count = 0;
+
+  if (i > 0) {
+    sx += x[k - stride];
+    sy += y[k - stride];
+    sz += z[k - stride];
+    count++;
+  }
+  if (i < M) {
+    sx += x[k + stride];
+    sy += y[k + stride];
+    sz += z[k + stride];
+    count++;
+  }
+  if (j > 0) {
+    sx += x[k - 1];
+    sy += y[k - 1];
+    sz += z[k - 1];
+    count++;
+  }
+  if (j < N) {
+    sx += x[k + 1];
+    sy += y[k + 1];
+    sz += z[k + 1];
+    count++;
+  }
+
+  if (count == 0)
+    return false;
+  average.SetCoord(sx / count, sy / count, sz / count);
+  return true;
+}
+
+// Relaxes free point (i, j) towards the average of its neighbours and returns
+// the squared displacement. Fixed points are left untouched.
+inline double relaxPoint(StructuredGrid &grid, int i, int j, double omega,
+                         const EllipticSolver::ConstraintFunc &constraintFunc) {
+  const int k = grid.index(i, j);
+  if (grid.isFixedAt(k))
+    return 0.0;
+
+  gp_XYZ target;
+  if (!neighbourAverage(grid, i, j, target))
+    return 0.0;
+
+  double *x = grid.x();
+  double *y = grid.y();
+  double *z = grid.z();
+
+  gp_Pnt oldPnt(x[k], y[k], z[k]);
+  gp_Pnt newPnt(oldPnt.XYZ() * (1.0 - omega) + target * omega);
+
+  if (constraintFunc) {
+    newPnt = constraintFunc(i, j, newPnt);
+  }
+
+  x[k] = newPnt.X();
+  y[k] = newPnt.Y();
+  z[k] = newPnt.Z();
+
+  return oldPnt.SquareDistance(newPnt);
+}
+
+// Surface state of the points of a parametric solve: parameters and the
+// tangents (6 doubles per point) of their last evaluation
+struct SurfaceState {
+  std::vector<double> &uv;
+  std::vector<double> tangents;
+  const EllipticSolver::SurfaceFunc &surface;
+};
+
+inline void storePoint(StructuredGrid &grid, SurfaceState &state, int k,
+                       const gp_Pnt &p, const gp_Vec &du, const gp_Vec &dv) {
+  grid.x()[k] = p.X();
+  grid.y()[k] = p.Y();
+  grid.z()[k] = p.Z();
+  double *t = &state.tangents[6 * (size_t)k];
+  t[0] = du.X();
+  t[1] = du.Y();
+  t[2] = du.Z();
+  t[3] = dv.X();
+  t[4] = dv.Y();
+  t[5] = dv.Z();
+}
+
+// Parametric counterpart of relaxPoint: solves the 2x2 normal equations
+// [E F; F G] (du, dv) = (Xu . d, Xv . d) for the relaxed 3D step d, moves
+// (u, v) and evaluates the surface there. Points where the metric is
+// singular (e.g. at a pole) stay where they are.
+inline double relaxParametric(StructuredGrid &grid, SurfaceState &state,
+                              int i, int j, double omega) {
+  const int k = grid.index(i, j);
+  if (grid.isFixedAt(k))
+    return 0.0;
+
+  gp_XYZ target;
+  if (!neighbourAverage(grid, i, j, target))
+    return 0.0;
+
+  gp_Pnt oldPnt(grid.x()[k], grid.y()[k], grid.z()[k]);
+  const double *t = &state.tangents[6 * (size_t)k];
+  gp_XYZ xu(t[0], t[1], t[2]);
+  gp_XYZ xv(t[3], t[4], t[5]);
+  gp_XYZ d = (target - oldPnt.XYZ()) * omega;
+
+  double E = xu.Dot(xu);
+  double F = xu.Dot(xv);
+  double G = xv.Dot(xv);
+  double det = E * G - F * F;
+  if (!(det > 1e-14 * E * G))
+    return 0.0;
+  double a = xu.Dot(d);
+  double b = xv.Dot(d);
+
+  double &u = state.uv[2 * (size_t)k];
+  double &v = state.uv[2 * (size_t)k + 1];
+  u += (G * a - F * b) / det;
+  v += (E * b - F * a) / det;
+
+  gp_Pnt newPnt;
+  gp_Vec du, dv;
+  state.surface(u, v, newPnt, du, dv);
+  storePoint(grid, state, k, newPnt, du, dv);
+  return oldPnt.SquareDistance(newPnt);
+}
+
+// Largest distance of a free point from its position in lastProjected,
+// which is then brought up to date
+double trackMotion(const StructuredGrid &grid, StructuredGrid &lastProjected) {
+  double maxDistSq = 0.0;
+  for (int i = 0; i < grid.rows(); ++i) {
+    for (int j = 0; j < grid.cols(); ++j) {
+      if (grid.isFixed(i, j))
+        continue;
+      gp_Pnt p = grid.point(i, j);
+      maxDistSq =
+          std::max(maxDistSq, p.SquareDistance(lastProjected.point(i, j)));
+      lastProjected.setPoint(i, j, p);
+    }
+  }
+  return std::sqrt(maxDistSq);
+}
+
+} // namespace
+
 std::vector<double> EllipticSolver::smoothGrid(
     std::vector<std::vector<gp_Pnt>> &grid,
     const std::vector<std::vector<bool>> &isFixed, const Params &params,
     std::function<gp_Pnt(int, int, const gp_Pnt &)> constraintFunc,
     std::function<void(int, double)> progressFunc) {
 
-  std::vector<double> convergence;
   if (grid.empty() || grid[0].empty())
+    return {};
+
+  StructuredGrid flat = StructuredGrid::fromNested(grid, isFixed);
+  std::vector<double> convergence =
+      smoothGrid(flat, params, constraintFunc, progressFunc);
+  flat.toNested(grid);
+  return convergence;
+}
+
+std::vector<double> EllipticSolver::smoothGrid(
+    StructuredGrid &grid, const Params &params,
+    std::function<gp_Pnt(int, int, const gp_Pnt &)> constraintFunc,
+    std::function<void(int, double)> progressFunc, double *relaxationUsed) {
+
+  std::vector<double> convergence;
+  if (grid.empty())
+    return convergence;
+
+  if (params.directSolve && !constraintFunc &&
+      FastPoissonSolver::canSolve(grid)) {
+    double maxDist = FastPoissonSolver::solve(grid);
+    convergence.push_back(maxDist);
+    if (progressFunc) {
+      progressFunc(0, maxDist);
+    }
     return convergence;
+  }
+
+  if (params.method == Method::Multigrid)
+    return smoothMultigrid(grid, params, constraintFunc, progressFunc);
 
   convergence.reserve(params.iterations);
 
+  RelaxationControl control(params.autoRelaxation
+                                ? optimalRelaxation(grid.rows(), grid.cols())
+                                : params.relaxation);
+
+  // Scheduled projection: unconstrained sweeps between projecting ones.
+  // Projection corrections are tracked per row, which only ever belongs to
+  // one worker at a time.
+  ProjectionSchedule schedule(params.projectionInterval,
+                              params.maxProjectionInterval);
+  const bool scheduled = constraintFunc && schedule.adaptive();
+  StructuredGrid lastProjected;
+  std::vector<double> rowDrift;
+  const ConstraintFunc noConstraint;
+  ConstraintFunc trackedConstraint;
+  if (scheduled) {
+    lastProjected = grid;
+    rowDrift.assign(grid.rows(), 0.0);
+    trackedConstraint = [&](int i, int j, const gp_Pnt &p) {
+      gp_Pnt q = constraintFunc(i, j, p);
+      rowDrift[i] = std::max(rowDrift[i], p.SquareDistance(q));
+      return q;
+    };
+  }
+
   for (int it = 0; it < params.iterations; ++it) {
-    double maxDist = iterate(grid, isFixed, params.relaxation, constraintFunc);
+    const bool project =
+        !scheduled || schedule.projects(it, params.iterations);
+    if (scheduled && project)
+      std::fill(rowDrift.begin(), rowDrift.end(), 0.0);
+
+    const ConstraintFunc &sweepConstraint =
+        !scheduled ? constraintFunc
+                   : (project ? trackedConstraint : noConstraint);
+    const double sweepDist =
+        sweep(grid, control.omega(), sweepConstraint, params.ordering);
+    double maxDist = sweepDist;
+    if (scheduled && project) {
+      double drift = *std::max_element(rowDrift.begin(), rowDrift.end());
+      maxDist = trackMotion(grid, lastProjected);
+      schedule.projected(std::sqrt(drift), maxDist);
+    } else if (scheduled) {
+      schedule.skipped();
+    }
     convergence.push_back(maxDist);
+    if (relaxationUsed)
+      *relaxationUsed = control.omega();
     if (progressFunc) {
       progressFunc(it, maxDist);
     }
-    if (maxDist < 1e-9) // Converged
+    if (project && maxDist < params.tolerance) // Converged
+      break;
+    if (project && CancelToken::shouldStop(params.cancel))
       break;
+    if (params.autoRelaxation)
+      control.update(sweepDist);
   }
   return convergence;
 }
 
-double EllipticSolver::iterate(
-    std::vector<std::vector<gp_Pnt>> &grid,
-    const std::vector<std::vector<bool>> &isFixed, double omega,
-    std::function<gp_Pnt(int, int, const gp_Pnt &)> constraintFunc) {
-  int M = grid.size() - 1;
-  int N = grid[0].size() - 1;
-  double maxDisplacement = 0.0;
+double EllipticSolver::optimalRelaxation(int rows, int cols) {
+  const int M = rows - 1;
+  const int N = cols - 1;
+  if (M < 2 || N < 2) // No interior points
+    return 1.0;
+  double rho = 0.5 * (std::cos(M_PI / M) + std::cos(M_PI / N));
+  return RelaxationControl::optimalOmega(rho);
+}
 
-  // Gauss-Seidel with SOR
-  for (int i = 0; i <= M; ++i) {
-    for (int j = 0; j <= N; ++j) {
-      if (isFixed[i][j])
+std::vector<double> EllipticSolver::smoothParametric(
+    StructuredGrid &grid, std::vector<double> &uv, const Params &params,
+    const SurfaceFunc &surface, std::function<void(int, double)> progressFunc,
+    double *relaxationUsed) {
+
+  std::vector<double> convergence;
+  if (grid.empty())
+    return convergence;
+
+  const int rows = grid.rows();
+  const int cols = grid.cols();
+  const size_t n = (size_t)rows * grid.stride();
+  uv.resize(2 * n, 0.0);
+  SurfaceState state{uv, std::vector<double>(6 * n, 0.0), surface};
+
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      int k = grid.index(i, j);
+      if (grid.isFixedAt(k))
         continue;
+      gp_Pnt p;
+      gp_Vec du, dv;
+      surface(uv[2 * (size_t)k], uv[2 * (size_t)k + 1], p, du, dv);
+      storePoint(grid, state, k, p, du, dv);
+    }
+  }
 
-      // Average of neighbors
-      gp_XYZ sum(0, 0, 0);
-      int count = 0;
+  const int numTasks = (rows + kRowsPerTask - 1) / kRowsPerTask;
+  std::vector<double> taskMax(numTasks, 0.0);
+  std::vector<int> tasks(numTasks);
+  for (int t = 0; t < numTasks; ++t)
+    tasks[t] = t;
 
-      if (i > 0) {
-        sum += grid[i - 1][j].XYZ();
-        count++;
-      }
-      if (i < M) {
-        sum += grid[i + 1][j].XYZ();
-        count++;
+  // Same sweep orders as iterate() and iterateRedBlack()
+  auto sweepOnce = [&](double omega) {
+    double maxDisplacement = 0.0;
+    if (params.ordering != Ordering::RedBlack) {
+      for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+          maxDisplacement = std::max(
+              maxDisplacement, relaxParametric(grid, state, i, j, omega));
+        }
       }
-      if (j > 0) {
-        sum += grid[i][j - 1].XYZ();
-        count++;
+      return std::sqrt(maxDisplacement);
+    }
+
+    for (int colour = 0; colour < 2; ++colour) {
+      auto sweepRows = [&](int t) {
+        double localMax = 0.0;
+        int iEnd = std::min(rows, (t + 1) * kRowsPerTask);
+        for (int i = t * kRowsPerTask; i < iEnd; ++i) {
+          for (int j = (i + colour) % 2; j < cols; j += 2) {
+            localMax =
+                std::max(localMax, relaxParametric(grid, state, i, j, omega));
+          }
+        }
+        taskMax[t] = localMax;
+      };
+
+      if (numTasks > 1) {
+        QtConcurrent::blockingMap(tasks, sweepRows);
+      } else {
+        sweepRows(0);
       }
-      if (j < N) {
-        sum += grid[i][j + 1].XYZ();
-        count++;
+
+      for (double m : taskMax) {
+        if (m > maxDisplacement)
+          maxDisplacement = m;
       }
+    }
+    return std::sqrt(maxDisplacement);
+  };
+
+  convergence.reserve(params.iterations);
+  RelaxationControl control(params.autoRelaxation
+                                ? optimalRelaxation(rows, cols)
+                                : params.relaxation);
 
-      if (count > 0) {
-        gp_Pnt oldPnt = grid[i][j];
-        gp_Pnt target(sum / (double)count);
-        gp_XYZ newVal = oldPnt.XYZ() * (1.0 - omega) + target.XYZ() * omega;
-        gp_Pnt newPnt(newVal);
+  for (int it = 0; it < params.iterations; ++it) {
+    double maxDist = sweepOnce(control.omega());
+    convergence.push_back(maxDist);
+    if (relaxationUsed)
+      *relaxationUsed = control.omega();
+    if (progressFunc) {
+      progressFunc(it, maxDist);
+    }
+    if (maxDist < params.tolerance) // Converged
+      break;
+    if (CancelToken::shouldStop(params.cancel))
+      break;
+    if (params.autoRelaxation)
+      control.update(maxDist);
+  }
+  return convergence;
+}
 
-        if (constraintFunc) {
-          newPnt = constraintFunc(i, j, newPnt);
-        }
+std::vector<double> EllipticSolver::smoothMultigrid(
+    StructuredGrid &grid, const Params &params,
+    const ConstraintFunc &constraintFunc,
+    const std::function<void(int, double)> &progressFunc) {
+  std::vector<double> convergence;
+  MultigridSolver multigrid(grid);
 
-        grid[i][j] = newPnt;
+  // Over-relaxation hurts smoothing of high frequencies, so the multigrid
+  // smoother is plain Gauss-Seidel in the requested ordering.
+  auto fineSmooth = [&](StructuredGrid &g) {
+    sweep(g, 1.0, constraintFunc, params.ordering);
+  };
 
-        double distSq = oldPnt.SquareDistance(newPnt);
-        if (distSq > maxDisplacement) {
-          maxDisplacement = distSq;
+  for (int it = 0; it < params.iterations; ++it) {
+    double maxDist = multigrid.vCycle(grid, fineSmooth, constraintFunc);
+    convergence.push_back(maxDist);
+    if (progressFunc) {
+      progressFunc(it, maxDist);
+    }
+    if (maxDist < params.tolerance) // Converged
+      break;
+    if (CancelToken::shouldStop(params.cancel))
+      break;
+  }
+  return convergence;
+}
+
+double EllipticSolver::sweep(StructuredGrid &grid, double omega,
+                             const ConstraintFunc &constraintFunc,
+                             Ordering ordering) {
+  return ordering == Ordering::RedBlack
+             ? iterateRedBlack(grid, omega, constraintFunc)
+             : iterate(grid, omega, constraintFunc);
+}
+
+double EllipticSolver::iterate(StructuredGrid &grid, double omega,
+                               const ConstraintFunc &constraintFunc) {
+  const int M = grid.rows() - 1;
+  const int N = grid.cols() - 1;
+  double maxDisplacement = 0.0;
+  auto track = [&](double distSq) {
+    if (distSq > maxDisplacement) {
+      maxDisplacement = distSq;
+    }
+  };
+
+  // Interior rows of unconstrained grids go through the SIMD kernel;
+  // boundary rows and columns stay scalar. Projected grids stay scalar
+  // too: each point must be projected before its right neighbour reads it.
+  const bool useKernel = !constraintFunc && N >= 2;
+  std::vector<double> scratch(useKernel ? 3 * (N - 1) : 0);
+
+  // Gauss-Seidel with SOR
+  for (int i = 0; i <= M; ++i) {
+    if (useKernel && i > 0 && i < M) {
+      track(relaxPoint(grid, i, 0, omega, constraintFunc));
+      track(StencilKernels::relaxLexicographic(grid, i, 1, N, omega,
+                                               scratch.data()));
+      track(relaxPoint(grid, i, N, omega, constraintFunc));
+      continue;
+    }
+    for (int j = 0; j <= N; ++j) {
+      track(relaxPoint(grid, i, j, omega, constraintFunc));
+    }
+  }
+  return std::sqrt(maxDisplacement);
+}
+
+double EllipticSolver::iterateRedBlack(StructuredGrid &grid, double omega,
+                                       const ConstraintFunc &constraintFunc) {
+  const int rows = grid.rows();
+  const int N = grid.cols() - 1;
+  // Points of one colour never read each other, so projecting a row right
+  // after the kernel relaxed it gives the same result as projecting each
+  // point inline
+  const bool useKernel = N >= 2;
+  const int numTasks = (rows + kRowsPerTask - 1) / kRowsPerTask;
+
+  // One slot per task; reduced in task order after each colour so the
+  // result never depends on thread scheduling.
+  std::vector<double> taskMax(numTasks, 0.0);
+  std::vector<int> tasks(numTasks);
+  for (int t = 0; t < numTasks; ++t)
+    tasks[t] = t;
+
+  double maxDisplacement = 0.0;
+
+  for (int colour = 0; colour < 2; ++colour) {
+    auto sweepRows = [&](int t) {
+      double localMax = 0.0;
+      int iEnd = std::min(rows, (t + 1) * kRowsPerTask);
+      auto track = [&](double distSq) {
+        if (distSq > localMax)
+          localMax = distSq;
+      };
+      std::vector<gp_Pnt> before; // Interior points of a row, if projected
+      for (int i = t * kRowsPerTask; i < iEnd; ++i) {
+        // Points of this colour satisfy (i + j) % 2 == colour
+        if (useKernel && i > 0 && i < rows - 1) {
+          if (i % 2 == colour)
+            track(relaxPoint(grid, i, 0, omega, constraintFunc));
+          if (!constraintFunc) {
+            track(
+                StencilKernels::relaxRedBlack(grid, i, 1, N, colour, omega));
+          } else {
+            before.clear();
+            for (int j = 1; j < N; ++j)
+              before.push_back(grid.point(i, j));
+            StencilKernels::relaxRedBlack(grid, i, 1, N, colour, omega);
+            for (int j = 2 - (i + colour) % 2; j < N; j += 2) {
+              if (grid.isFixed(i, j))
+                continue;
+              gp_Pnt q = constraintFunc(i, j, grid.point(i, j));
+              grid.setPoint(i, j, q);
+              track(before[j - 1].SquareDistance(q));
+            }
+          }
+          if ((i + N) % 2 == colour)
+            track(relaxPoint(grid, i, N, omega, constraintFunc));
+          continue;
+        }
+        for (int j = (i + colour) % 2; j < grid.cols(); j += 2) {
+          track(relaxPoint(grid, i, j, omega, constraintFunc));
         }
       }
+      taskMax[t] = localMax;
+    };
+
+    if (numTasks > 1) {
+      QtConcurrent::blockingMap(tasks, sweepRows);
+    } else {
+      sweepRows(0);
+    }
+
+    for (double m : taskMax) {
+      if (m > maxDisplacement)
+        maxDisplacement = m;
     }
   }
   return std::sqrt(maxDisplacement);
@@ -1,19 +1,58 @@
 #ifndef ELLIPTICSOLVER_H
 #define ELLIPTICSOLVER_H
 
+#include "StructuredGrid.h"
 #include <functional>
 #include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
 #include <vector>
 
+class CancelToken;
+
 /**
  * @brief Simple iterative elliptic solver (SOR) for grid smoothing.
  */
 class EllipticSolver {
 public:
+  using ConstraintFunc = std::function<gp_Pnt(int, int, const gp_Pnt &)>;
+
+  /**
+   * @brief Evaluates a parametric surface: position and first derivatives
+   * at (u, v). May clamp u and v to the surface's parameter domain.
+   */
+  using SurfaceFunc =
+      std::function<void(double &u, double &v, gp_Pnt &p, gp_Vec &du,
+                         gp_Vec &dv)>;
+
+  enum class Ordering {
+    Lexicographic, // In-place Gauss-Seidel, row by row (single thread)
+    RedBlack       // Checkerboard colours, each colour split across threads
+  };
+
+  enum class Method {
+    SOR,      // Plain relaxation sweeps, one per iteration
+    Multigrid // Geometric multigrid V-cycles, one per iteration
+  };
+
   struct Params {
     int iterations = 1000;
-    double relaxation = 0.9;
+    double relaxation = 0.9; // SOR only; multigrid smooths with Gauss-Seidel
+    bool autoRelaxation = false; // Ignore relaxation; see optimalRelaxation
     double bcRelaxation = 0.1;
+    Ordering ordering = Ordering::Lexicographic;
+    Method method = Method::SOR;
+    bool directSolve = true; // Exact DST solve when nothing is projected
+    // SOR only: sweeps from one projecting sweep to the next, adapted
+    // within [1, maxProjectionInterval]; see ProjectionSchedule. A maximum
+    // of 1 projects every point as soon as it is relaxed.
+    int projectionInterval = 1;
+    int maxProjectionInterval = 1;
+    // Converged once a sweep (a projecting one, if scheduled) or V-cycle
+    // moves no point further than this
+    double tolerance = 1e-9;
+    // Optional; polled after every sweep (with scheduled projection, every
+    // projecting sweep) or V-cycle, which returns the grid as it is
+    const CancelToken *cancel = nullptr;
   };
 
   /**
@@ -30,11 +69,83 @@ public:
       std::function<gp_Pnt(int, int, const gp_Pnt &)> constraintFunc = nullptr,
       std::function<void(int, double)> progressFunc = nullptr);
 
+  /**
+   * @brief Smooths a flat structured grid in place.
+   *
+   * Same algorithm as the nested overload; fixed points are taken from the
+   * grid's packed mask. With Ordering::RedBlack the constraint function is
+   * called concurrently from worker threads and must be thread-safe.
+   *
+   * Without a constraint function, on a grid whose fixed points are exactly
+   * its boundary, the converged grid is computed directly (see
+   * FastPoissonSolver) unless params.directSolve is false. The returned
+   * history then has a single entry.
+   *
+   * With params.autoRelaxation the SOR sweeps start from
+   * optimalRelaxation() and back off if the displacements keep growing
+   * (see RelaxationControl). relaxationUsed, if given, receives the factor
+   * of the last SOR sweep; it is left alone when no SOR sweep runs.
+   *
+   * With params.maxProjectionInterval above 1 only every few SOR sweeps
+   * call the constraint function; the others run unconstrained. The
+   * history then records, for projecting sweeps, the largest motion since
+   * the previous projecting sweep, and convergence is only declared on
+   * them.
+   *
+   * Interior rows of SOR sweeps go through StencilKernels, except in
+   * lexicographic sweeps that project, where a point must be projected
+   * before its right-hand neighbour reads it; those stay scalar. Red-black
+   * sweeps that project relax a row with the kernel and then project its
+   * points, which gives the same result since points of one colour never
+   * read each other. Multigrid smoothing follows the same rules.
+   */
+  static std::vector<double> smoothGrid(
+      StructuredGrid &grid, const Params &params,
+      std::function<gp_Pnt(int, int, const gp_Pnt &)> constraintFunc = nullptr,
+      std::function<void(int, double)> progressFunc = nullptr,
+      double *relaxationUsed = nullptr);
+
+  /**
+   * @brief Near-optimal SOR factor for a rows x cols grid with fixed
+   * boundary, from the Jacobi spectral radius of the 5-point Laplacian,
+   * (cos(pi / M) + cos(pi / N)) / 2 for M x N intervals.
+   */
+  static double optimalRelaxation(int rows, int cols);
+
+  /**
+   * @brief Smooths a grid lying on one parametric surface by moving its
+   * points in surface parameters instead of projecting them.
+   *
+   * Each free point takes a Gauss-Newton step in (u, v) towards the
+   * relaxed average of its neighbours, using the surface metric
+   * (first fundamental form) at its current position, and is then
+   * evaluated on the surface. Points therefore never leave the surface and
+   * no closest-point search is needed. uv holds the parameters of point
+   * (i, j) at uv[2 * grid.index(i, j)] and uv[2 * grid.index(i, j) + 1];
+   * entries of fixed points are ignored. Free points are moved onto
+   * surface(u, v) before the first sweep.
+   *
+   * Uses SOR sweeps in params.ordering, with params.autoRelaxation as in
+   * smoothGrid(); params.method and params.directSolve are ignored. With
+   * Ordering::RedBlack the surface function is called concurrently.
+   */
+  static std::vector<double>
+  smoothParametric(StructuredGrid &grid, std::vector<double> &uv,
+                   const Params &params, const SurfaceFunc &surface,
+                   std::function<void(int, double)> progressFunc = nullptr,
+                   double *relaxationUsed = nullptr);
+
 private:
-  static double
-  iterate(std::vector<std::vector<gp_Pnt>> &grid,
-          const std::vector<std::vector<bool>> &isFixed, double omega,
-          std::function<gp_Pnt(int, int, const gp_Pnt &)> constraintFunc);
+  static std::vector<double>
+  smoothMultigrid(StructuredGrid &grid, const Params &params,
+                  const ConstraintFunc &constraintFunc,
+                  const std::function<void(int, double)> &progressFunc);
+  static double sweep(StructuredGrid &grid, double omega,
+                      const ConstraintFunc &constraintFunc, Ordering ordering);
+  static double iterate(StructuredGrid &grid, double omega,
+                        const ConstraintFunc &constraintFunc);
+  static double iterateRedBlack(StructuredGrid &grid, double omega,
+                                const ConstraintFunc &constraintFunc);
 };
 
 #endif // ELLIPTICSOLVER_H
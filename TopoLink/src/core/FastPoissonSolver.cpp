@@ -0,0 +1,205 @@
+#include "FastPoissonSolver.h"
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// In-place iterative radix-2 FFT; data.size() must be a power of two
+void fftRadix2(std::vector<Complex> &data, bool inverse) {
+  const size_t n = data.size();
+  for (size_t i = 1, j = 0; i < n; ++i) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap(data[i], data[j]);
+  }
+  for (size_t len = 2; len <= n; len <<= 1) {
+    double angle = 2.0 * M_PI / len * (inverse ? 1.0 : -1.0);
+    Complex wLen(std::cos(angle), std::sin(angle));
+    for (size_t i = 0; i < n; i += len) {
+      Complex w(1.0, 0.0);
+      for (size_t k = 0; k < len / 2; ++k) {
+        Complex u = data[i + k];
+        Complex v = data[i + k + len / 2] * w;
+        data[i + k] = u + v;
+        data[i + k + len / 2] = u - v;
+        w *= wLen;
+      }
+    }
+  }
+  if (inverse) {
+    for (Complex &c : data)
+      c /= (double)n;
+  }
+}
+
+/**
+ * @brief DST-I of a fixed length n, X_k = sum_j x_j sin(pi j k / (n + 1)).
+ *
+ * Computed as the imaginary part of an FFT of the odd extension (length
+ * 2(n + 1)). Lengths that are not a power of two go through Bluestein's
+ * chirp-z algorithm, whose chirp and its transform are set up once here.
+ */
+class SineTransform {
+public:
+  explicit SineTransform(int n) : _n(n), _len(2 * (n + 1)) {
+    _pow2 = (_len & (_len - 1)) == 0;
+    if (_pow2)
+      return;
+
+    _fftLen = 1;
+    while (_fftLen < 2 * _len - 1)
+      _fftLen <<= 1;
+    _chirp.resize(_len);
+    for (int k = 0; k < _len; ++k) {
+      // k^2 mod 2*len keeps the angle small for long transforms
+      long long k2 = (long long)k * k % (2LL * _len);
+      double angle = M_PI * k2 / _len;
+      _chirp[k] = Complex(std::cos(angle), -std::sin(angle));
+    }
+    _chirpFft.assign(_fftLen, Complex(0.0, 0.0));
+    _chirpFft[0] = std::conj(_chirp[0]);
+    for (int k = 1; k < _len; ++k) {
+      _chirpFft[k] = std::conj(_chirp[k]);
+      _chirpFft[_fftLen - k] = std::conj(_chirp[k]);
+    }
+    fftRadix2(_chirpFft, false);
+  }
+
+  // Transforms n values spaced by stride, in place
+  void apply(double *values, int stride) {
+    _buffer.assign(_len, Complex(0.0, 0.0));
+    for (int j = 1; j <= _n; ++j) {
+      double v = values[(j - 1) * stride];
+      _buffer[j] = v;
+      _buffer[_len - j] = -v;
+    }
+    fft();
+    for (int k = 1; k <= _n; ++k)
+      values[(k - 1) * stride] = -0.5 * _buffer[k].imag();
+  }
+
+private:
+  void fft() {
+    if (_pow2) {
+      fftRadix2(_buffer, false);
+      return;
+    }
+    _work.assign(_fftLen, Complex(0.0, 0.0));
+    for (int k = 0; k < _len; ++k)
+      _work[k] = _buffer[k] * _chirp[k];
+    fftRadix2(_work, false);
+    for (int k = 0; k < _fftLen; ++k)
+      _work[k] *= _chirpFft[k];
+    fftRadix2(_work, true);
+    for (int k = 0; k < _len; ++k)
+      _buffer[k] = _work[k] * _chirp[k];
+  }
+
+  int _n;
+  int _len;
+  bool _pow2 = false;
+  int _fftLen = 0;
+  std::vector<Complex> _chirp;
+  std::vector<Complex> _chirpFft;
+  std::vector<Complex> _buffer;
+  std::vector<Complex> _work;
+};
+
+} // namespace
+
+bool FastPoissonSolver::canSolve(const StructuredGrid &grid) {
+  if (grid.rows() < 3 || grid.cols() < 3)
+    return false;
+  const int M = grid.rows() - 1;
+  const int N = grid.cols() - 1;
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      bool boundary = (i == 0 || i == M || j == 0 || j == N);
+      if (grid.isFixed(i, j) != boundary)
+        return false;
+    }
+  }
+  return true;
+}
+
+double FastPoissonSolver::solve(StructuredGrid &grid) {
+  const int M = grid.rows() - 1;
+  const int N = grid.cols() - 1;
+  const int n = M - 1; // interior rows
+  const int m = N - 1; // interior columns
+  const int stride = grid.stride();
+
+  SineTransform dstRows(m);
+  SineTransform dstCols(n);
+
+  // Eigenvalues of the 1D second difference with Dirichlet ends
+  std::vector<double> lambda(n), mu(m);
+  for (int p = 0; p < n; ++p)
+    lambda[p] = 2.0 - 2.0 * std::cos(M_PI * (p + 1) / M);
+  for (int q = 0; q < m; ++q)
+    mu[q] = 2.0 - 2.0 * std::cos(M_PI * (q + 1) / N);
+  const double scale = (2.0 / M) * (2.0 / N);
+
+  std::vector<double> f((size_t)n * m);
+  double maxDisplacement = 0.0;
+  double *coords[3] = {grid.x(), grid.y(), grid.z()};
+  std::vector<double> solved[3];
+
+  for (int c = 0; c < 3; ++c) {
+    const double *u = coords[c];
+
+    // 4 u - (sum of neighbours) = 0, with fixed neighbours moved right
+    for (int i = 1; i <= n; ++i) {
+      for (int j = 1; j <= m; ++j) {
+        int k = i * stride + j;
+        double b = 0.0;
+        if (i == 1)
+          b += u[k - stride];
+        if (i == n)
+          b += u[k + stride];
+        if (j == 1)
+          b += u[k - 1];
+        if (j == m)
+          b += u[k + 1];
+        f[(i - 1) * m + (j - 1)] = b;
+      }
+    }
+
+    for (int i = 0; i < n; ++i)
+      dstRows.apply(&f[i * m], 1);
+    for (int j = 0; j < m; ++j)
+      dstCols.apply(&f[j], m);
+
+    for (int p = 0; p < n; ++p) {
+      for (int q = 0; q < m; ++q)
+        f[p * m + q] *= scale / (lambda[p] + mu[q]);
+    }
+
+    for (int i = 0; i < n; ++i)
+      dstRows.apply(&f[i * m], 1);
+    for (int j = 0; j < m; ++j)
+      dstCols.apply(&f[j], m);
+
+    solved[c] = f;
+  }
+
+  for (int i = 1; i <= n; ++i) {
+    for (int j = 1; j <= m; ++j) {
+      int k = i * stride + j;
+      int s = (i - 1) * m + (j - 1);
+      gp_Pnt oldPnt(coords[0][k], coords[1][k], coords[2][k]);
+      gp_Pnt newPnt(solved[0][s], solved[1][s], solved[2][s]);
+      double distSq = oldPnt.SquareDistance(newPnt);
+      if (distSq > maxDisplacement)
+        maxDisplacement = distSq;
+      grid.setPoint(i, j, newPnt);
+    }
+  }
+  return std::sqrt(maxDisplacement);
+}
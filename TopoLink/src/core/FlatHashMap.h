@@ -0,0 +1,108 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Open-addressing hash map from 64-bit keys to small values, kept in
+ * one flat array.
+ *
+ * Linear probing with backward-shift deletion, so there are no tombstones
+ * and a lookup touches a few neighbouring entries instead of following
+ * bucket chains. The table doubles at 3/4 load. Key kEmptyKey is reserved.
+ */
+template <typename V> class FlatHashMap {
+public:
+  static constexpr uint64_t kEmptyKey = UINT64_MAX;
+
+  /** @brief Value under key, or null. Valid until the map next changes. */
+  V *find(uint64_t key) {
+    if (_size == 0)
+      return nullptr;
+    for (size_t i = indexOf(key);; i = (i + 1) & _mask) {
+      if (_entries[i].first == key)
+        return &_entries[i].second;
+      if (_entries[i].first == kEmptyKey)
+        return nullptr;
+    }
+  }
+  const V *find(uint64_t key) const {
+    return const_cast<FlatHashMap *>(this)->find(key);
+  }
+
+  /** @brief Sets the value under key, adding the key if it is new. */
+  void insert_or_assign(uint64_t key, const V &value) {
+    if ((_size + 1) * 4 > _entries.size() * 3)
+      rehash(_entries.empty() ? 16 : _entries.size() * 2);
+    size_t i = indexOf(key);
+    while (_entries[i].first != kEmptyKey && _entries[i].first != key)
+      i = (i + 1) & _mask;
+    if (_entries[i].first == kEmptyKey)
+      ++_size;
+    _entries[i] = {key, value};
+  }
+
+  /** @return False if key was not present */
+  bool erase(uint64_t key) {
+    if (_size == 0)
+      return false;
+    size_t i = indexOf(key);
+    while (_entries[i].first != key) {
+      if (_entries[i].first == kEmptyKey)
+        return false;
+      i = (i + 1) & _mask;
+    }
+    // Shift later members of the probe run back into the hole
+    for (size_t j = (i + 1) & _mask; _entries[j].first != kEmptyKey;
+         j = (j + 1) & _mask) {
+      size_t home = indexOf(_entries[j].first);
+      if (((j - home) & _mask) >= ((j - i) & _mask)) {
+        _entries[i] = _entries[j];
+        i = j;
+      }
+    }
+    _entries[i].first = kEmptyKey;
+    --_size;
+    return true;
+  }
+
+  void clear() {
+    _entries.clear();
+    _mask = 0;
+    _size = 0;
+  }
+
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+
+private:
+  size_t indexOf(uint64_t key) const {
+    // splitmix64 finaliser: packed ID pairs are far from uniform
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return (size_t)key & _mask;
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<std::pair<uint64_t, V>> old(capacity, {kEmptyKey, V()});
+    old.swap(_entries);
+    _mask = capacity - 1;
+    _size = 0;
+    for (const auto &entry : old) {
+      if (entry.first != kEmptyKey)
+        insert_or_assign(entry.first, entry.second);
+    }
+  }
+
+  std::vector<std::pair<uint64_t, V>> _entries; // Power-of-two size
+  size_t _mask = 0;
+  size_t _size = 0;
+};
+
+#endif // FLATHASHMAP_H
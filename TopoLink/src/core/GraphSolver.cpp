@@ -1,70 +1,428 @@
 #include "GraphSolver.h"
+#include "CancelToken.h"
+#include "ProjectionSchedule.h"
+#include "RelaxationControl.h"
+#include <QtConcurrent>
+#include <algorithm>
 #include <cmath>
 #include <gp_XYZ.hxx>
 
+namespace {
+
+// Nodes handed to one worker per colour. Fixed (not derived from the thread
+// count) so the work split is identical on every machine.
+constexpr int kNodesPerTask = 256;
+
+using ConstraintFunc = std::function<gp_Pnt(int, const gp_Pnt &)>;
+
+// Relaxes free node i towards the average of its neighbours and returns the
+// squared displacement.
+inline double relaxNode(GraphSolver::Graph &graph, int i, double relaxation,
+                        const ConstraintFunc &constraintFunc) {
+  if (graph.fixed[i])
+    return 0.0;
+
+  const int begin = graph.offsets[i];
+  const int end = graph.offsets[i + 1];
+  if (begin == end)
+    return 0.0;
+
+  double *x = graph.x.data();
+  double *y = graph.y.data();
+  double *z = graph.z.data();
+
+  gp_XYZ sum(0, 0, 0);
+  for (int k = begin; k < end; ++k) {
+    int neighborIdx = graph.neighbors[k];
+    sum += gp_XYZ(x[neighborIdx], y[neighborIdx], z[neighborIdx]);
+  }
+
+  gp_Pnt oldPnt(x[i], y[i], z[i]);
+  gp_Pnt target(sum / (double)(end - begin));
+
+  // Relaxation
+  gp_XYZ newVal =
+      oldPnt.XYZ() * (1.0 - relaxation) + target.XYZ() * relaxation;
+  gp_Pnt newPnt(newVal);
+
+  // Constraint Projection
+  if (constraintFunc) {
+    newPnt = constraintFunc(i, newPnt);
+  }
+
+  // Update in place (Gauss-Seidel)
+  x[i] = newPnt.X();
+  y[i] = newPnt.Y();
+  z[i] = newPnt.Z();
+
+  return oldPnt.SquareDistance(newPnt);
+}
+
+// Largest distance of a free node from its position in last, which is
+// then brought up to date
+double trackMotion(const GraphSolver::Graph &graph, GraphSolver::Graph &last) {
+  double maxDistSq = 0.0;
+  for (int i = 0; i < graph.size(); ++i) {
+    if (graph.fixed[i])
+      continue;
+    gp_Pnt p = graph.point(i);
+    maxDistSq = std::max(maxDistSq, p.SquareDistance(last.point(i)));
+    last.setPoint(i, p);
+  }
+  return std::sqrt(maxDistSq);
+}
+
+} // namespace
+
+int GraphSolver::Graph::addNode(const gp_Pnt &p, bool isFixed) {
+  x.push_back(p.X());
+  y.push_back(p.Y());
+  z.push_back(p.Z());
+  fixed.push_back(isFixed ? 1 : 0);
+  return size() - 1;
+}
+
+void GraphSolver::Graph::setLinks(
+    const std::vector<std::pair<int, int>> &links) {
+  const int n = size();
+
+  // Count, prefix-sum, scatter
+  offsets.assign(n + 1, 0);
+  for (const auto &link : links) {
+    if (link.first == link.second)
+      continue;
+    offsets[link.first + 1]++;
+    offsets[link.second + 1]++;
+  }
+  for (int i = 0; i < n; ++i)
+    offsets[i + 1] += offsets[i];
+
+  neighbors.resize(offsets[n]);
+  std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+  for (const auto &link : links) {
+    if (link.first == link.second)
+      continue;
+    neighbors[cursor[link.first]++] = link.second;
+    neighbors[cursor[link.second]++] = link.first;
+  }
+
+  // Sort each row and squeeze out duplicates in place
+  int write = 0;
+  int begin = 0;
+  for (int i = 0; i < n; ++i) {
+    int end = offsets[i + 1];
+    std::sort(neighbors.begin() + begin, neighbors.begin() + end);
+    offsets[i] = write;
+    for (int k = begin; k < end; ++k) {
+      if (write == offsets[i] || neighbors[write - 1] != neighbors[k])
+        neighbors[write++] = neighbors[k];
+    }
+    begin = end;
+  }
+  offsets[n] = write;
+  neighbors.resize(write);
+}
+
+std::vector<int> GraphSolver::reorderRCM(Graph &graph) {
+  const int n = graph.size();
+  std::vector<int> order;
+  order.reserve(n);
+  std::vector<uint8_t> visited(n, 0);
+
+  // Candidate start nodes, lowest degree first
+  std::vector<int> byDegree(n);
+  for (int i = 0; i < n; ++i)
+    byDegree[i] = i;
+  std::stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b) {
+    return graph.degree(a) < graph.degree(b);
+  });
+
+  auto lessDegree = [&](int a, int b) {
+    int da = graph.degree(a);
+    int db = graph.degree(b);
+    return da != db ? da < db : a < b;
+  };
+
+  // Breadth-first search from start, appending to order; returns the index
+  // in order where the last level begins.
+  std::vector<int> level;
+  auto bfs = [&](int start) -> size_t {
+    size_t head = order.size();
+    size_t lastLevel = head;
+    order.push_back(start);
+    visited[start] = 1;
+    size_t levelEnd = order.size();
+    while (head < order.size()) {
+      if (head == levelEnd) {
+        lastLevel = head;
+        levelEnd = order.size();
+      }
+      int node = order[head++];
+      level.clear();
+      for (int k = graph.offsets[node]; k < graph.offsets[node + 1]; ++k) {
+        int nb = graph.neighbors[k];
+        if (!visited[nb]) {
+          visited[nb] = 1;
+          level.push_back(nb);
+        }
+      }
+      std::sort(level.begin(), level.end(), lessDegree);
+      order.insert(order.end(), level.begin(), level.end());
+    }
+    return lastLevel;
+  };
+
+  for (int candidate : byDegree) {
+    if (visited[candidate])
+      continue;
+
+    // One pseudo-peripheral refinement: restart from the lowest-degree node
+    // of the farthest level.
+    size_t componentBegin = order.size();
+    size_t lastLevel = bfs(candidate);
+    int start = *std::min_element(order.begin() + lastLevel, order.end(),
+                                  lessDegree);
+    for (size_t k = componentBegin; k < order.size(); ++k)
+      visited[order[k]] = 0;
+    order.resize(componentBegin);
+    bfs(start);
+  }
+
+  std::reverse(order.begin(), order.end());
+  std::vector<int> newIndex(n);
+  for (int k = 0; k < n; ++k)
+    newIndex[order[k]] = k;
+
+  // Permute nodes and rebuild the rows under the new numbering
+  Graph permuted;
+  permuted.x.resize(n);
+  permuted.y.resize(n);
+  permuted.z.resize(n);
+  permuted.fixed.resize(n);
+  permuted.offsets.resize(n + 1);
+  permuted.neighbors.resize(graph.neighbors.size());
+  permuted.offsets[0] = 0;
+  for (int k = 0; k < n; ++k) {
+    int old = order[k];
+    permuted.x[k] = graph.x[old];
+    permuted.y[k] = graph.y[old];
+    permuted.z[k] = graph.z[old];
+    permuted.fixed[k] = graph.fixed[old];
+    int begin = permuted.offsets[k];
+    int out = begin;
+    for (int e = graph.offsets[old]; e < graph.offsets[old + 1]; ++e)
+      permuted.neighbors[out++] = newIndex[graph.neighbors[e]];
+    std::sort(permuted.neighbors.begin() + begin,
+              permuted.neighbors.begin() + out);
+    permuted.offsets[k + 1] = out;
+  }
+  graph = std::move(permuted);
+  return newIndex;
+}
+
+GraphSolver::Colouring GraphSolver::colourGreedy(const Graph &graph) {
+  const int n = graph.size();
+  std::vector<int> colour(n, -1);
+  std::vector<int> takenBy; // takenBy[c] == i: colour c is used next to i
+  int numColours = 0;
+
+  for (int i = 0; i < n; ++i) {
+    for (int k = graph.offsets[i]; k < graph.offsets[i + 1]; ++k) {
+      int c = colour[graph.neighbors[k]];
+      if (c >= 0)
+        takenBy[c] = i;
+    }
+    int c = 0;
+    while (c < numColours && takenBy[c] == i)
+      ++c;
+    if (c == numColours) {
+      takenBy.push_back(-1);
+      ++numColours;
+    }
+    colour[i] = c;
+  }
+
+  // Bucket by colour; nodes stay in ascending order within a colour
+  Colouring result;
+  result.offsets.assign(numColours + 1, 0);
+  for (int i = 0; i < n; ++i)
+    result.offsets[colour[i] + 1]++;
+  for (int c = 0; c < numColours; ++c)
+    result.offsets[c + 1] += result.offsets[c];
+  result.nodes.resize(n);
+  std::vector<int> cursor(result.offsets.begin(), result.offsets.end() - 1);
+  for (int i = 0; i < n; ++i)
+    result.nodes[cursor[colour[i]]++] = i;
+  return result;
+}
+
 std::vector<double> GraphSolver::smoothGraph(
-    std::vector<Node> &nodes, const Params &params,
+    Graph &graph, const Params &params,
     std::function<gp_Pnt(int, const gp_Pnt &)> constraintFunc,
-    std::function<void(int, double)> progressFunc) {
+    std::function<void(int, double)> progressFunc,
+    const Colouring *colouring, double *relaxationUsed) {
 
   std::vector<double> convergence;
-  if (nodes.empty())
+  if (graph.size() == 0)
     return convergence;
 
   convergence.reserve(params.iterations);
-  int N = nodes.size();
+  int N = graph.size();
+
+  Colouring localColouring;
+  if (params.ordering == Ordering::Coloured && !colouring) {
+    localColouring = colourGreedy(graph);
+    colouring = &localColouring;
+  }
+
+  // Work split for the coloured sweeps: fixed-size chunks of each colour
+  struct Task {
+    int slot; // index within its colour, for the reduction
+    int begin;
+    int end;
+  };
+  std::vector<std::vector<Task>> tasksByColour;
+  if (params.ordering == Ordering::Coloured) {
+    tasksByColour.resize(colouring->numColours());
+    for (int c = 0; c < colouring->numColours(); ++c) {
+      for (int b = colouring->offsets[c]; b < colouring->offsets[c + 1];
+           b += kNodesPerTask) {
+        int slot = (int)tasksByColour[c].size();
+        tasksByColour[c].push_back(
+            {slot, b, std::min(b + kNodesPerTask, colouring->offsets[c + 1])});
+      }
+    }
+  }
 
   // Double buffering for positions to avoid order-dependency bias
   // (Jacobi-style) or use Gauss-Seidel. Let's use Gauss-Seidel for faster
   // convergence, same as EllipticSolver.
 
+  RelaxationControl control(params.autoRelaxation ? 1.0 : params.relaxation);
+  int sweepsAtOmega = 0;
+  bool backedOff = false;
+
+  // Scheduled projection: unconstrained sweeps between projecting ones
+  // (see ProjectionSchedule). Corrections are tracked per node, so the
+  // coloured workers never share a slot.
+  ProjectionSchedule schedule(params.projectionInterval,
+                              params.maxProjectionInterval);
+  const bool scheduled = constraintFunc && schedule.adaptive();
+  const ConstraintFunc noConstraint;
+  ConstraintFunc trackedConstraint;
+  Graph lastProjected;
+  std::vector<double> nodeDrift;
+  if (scheduled) {
+    lastProjected = graph;
+    nodeDrift.assign(N, 0.0);
+    trackedConstraint = [&](int i, const gp_Pnt &p) {
+      gp_Pnt q = constraintFunc(i, p);
+      nodeDrift[i] = p.SquareDistance(q);
+      return q;
+    };
+  }
+  std::vector<double> sweepHistory;
+  sweepHistory.reserve(params.iterations);
+
   for (int it = 0; it < params.iterations; ++it) {
     double maxDisplacement = 0.0;
+    const double omega = control.omega();
+    const bool project =
+        !scheduled || schedule.projects(it, params.iterations);
+    if (scheduled && project)
+      std::fill(nodeDrift.begin(), nodeDrift.end(), 0.0);
+    const ConstraintFunc &sweepConstraint =
+        !scheduled ? constraintFunc
+                   : (project ? trackedConstraint : noConstraint);
 
-    for (int i = 0; i < N; ++i) {
-      if (nodes[i].isFixed)
-        continue;
+    if (params.ordering == Ordering::Coloured) {
+      // Nodes of one colour only read other colours, so each colour can be
+      // split across threads. Per-task maxima are reduced in task order.
+      for (std::vector<Task> &tasks : tasksByColour) {
+        std::vector<double> taskMax(tasks.size(), 0.0);
+        auto sweepTask = [&](const Task &task) {
+          double localMax = 0.0;
+          for (int k = task.begin; k < task.end; ++k) {
+            double distSq =
+                relaxNode(graph, colouring->nodes[k], omega, sweepConstraint);
+            if (distSq > localMax)
+              localMax = distSq;
+          }
+          taskMax[task.slot] = localMax;
+        };
 
-      const auto &neighbors = nodes[i].neighbors;
-      if (neighbors.empty())
-        continue;
+        if (tasks.size() > 1) {
+          QtConcurrent::blockingMap(tasks, sweepTask);
+        } else if (!tasks.empty()) {
+          sweepTask(tasks[0]);
+        }
 
-      gp_XYZ sum(0, 0, 0);
-      for (int neighborIdx : neighbors) {
-        sum += nodes[neighborIdx].pos.XYZ();
+        for (double m : taskMax) {
+          if (m > maxDisplacement)
+            maxDisplacement = m;
+        }
       }
-
-      gp_Pnt oldPnt = nodes[i].pos;
-      gp_Pnt target(sum / (double)neighbors.size());
-
-      // Relaxation
-      gp_XYZ newVal = oldPnt.XYZ() * (1.0 - params.relaxation) +
-                      target.XYZ() * params.relaxation;
-      gp_Pnt newPnt(newVal);
-
-      // Constraint Projection
-      if (constraintFunc) {
-        newPnt = constraintFunc(i, newPnt);
+    } else {
+      for (int i = 0; i < N; ++i) {
+        double distSq = relaxNode(graph, i, omega, sweepConstraint);
+        if (distSq > maxDisplacement) {
+          maxDisplacement = distSq;
+        }
       }
+    }
 
-      // Update in place (Gauss-Seidel)
-      nodes[i].pos = newPnt;
+    // The factor is estimated from the sweep displacements, not from the
+    // motion between projecting sweeps
+    const double sweepDist = std::sqrt(maxDisplacement);
+    sweepHistory.push_back(sweepDist);
 
-      double distSq = oldPnt.SquareDistance(newPnt);
-      if (distSq > maxDisplacement) {
-        maxDisplacement = distSq;
-      }
+    double maxDist = sweepDist;
+    if (scheduled && project) {
+      double drift = *std::max_element(nodeDrift.begin(), nodeDrift.end());
+      maxDist = trackMotion(graph, lastProjected);
+      schedule.projected(std::sqrt(drift), maxDist);
+    } else if (scheduled) {
+      schedule.skipped();
     }
-
-    double maxDist = std::sqrt(maxDisplacement);
     convergence.push_back(maxDist);
+    if (relaxationUsed)
+      *relaxationUsed = omega;
 
     if (progressFunc) {
       progressFunc(it, maxDist);
     }
 
-    if (maxDist < 1e-9) // Converged
+    if (project && maxDist < params.tolerance) // Converged
       break;
+    if (project && CancelToken::shouldStop(params.cancel))
+      break;
+
+    if (params.autoRelaxation) {
+      ++sweepsAtOmega;
+      if (control.update(sweepDist)) {
+        backedOff = true; // Stop raising omega once it has diverged
+        sweepsAtOmega = 0;
+      } else if (!backedOff && sweepsAtOmega >= kEstimateSweeps) {
+        // Decay rate over the last half window, then the factor that would
+        // be optimal for the spectral radius it implies. The estimate only
+        // ever raises omega, approaching the optimum from below.
+        const int span = kEstimateSweeps / 2;
+        double rate =
+            std::pow(sweepDist / sweepHistory[it - span], 1.0 / span);
+        double before = std::pow(sweepHistory[it - span] /
+                                     sweepHistory[it - 2 * span + 1],
+                                 1.0 / (span - 1));
+        bool steady = std::abs(rate - before) < 0.05 * (1.0 - rate);
+        if (steady && rate < 1.0 && rate > omega - 1.0) {
+          double next = RelaxationControl::optimalOmega(
+              RelaxationControl::jacobiRadius(rate, omega));
+          if (next > omega + 1e-3) {
+            control = RelaxationControl(next);
+            sweepsAtOmega = 0;
+          }
+        }
+      }
+    }
   }
   return convergence;
 }
@@ -1,41 +1,142 @@
 #ifndef GRAPHSOLVER_H
 #define GRAPHSOLVER_H
 
+#include <cstdint>
 #include <functional>
 #include <gp_Pnt.hxx>
+#include <utility>
 #include <vector>
 
+class CancelToken;
+
 /**
  * @brief General iterative solver for graph-based smoothing.
  * Used for smoothing groups of faces where internal edges should be relaxed.
  */
 class GraphSolver {
 public:
-  struct Node {
-    gp_Pnt pos;
-    bool isFixed;
-    std::vector<int> neighbors; // Indices into the nodes vector
+  /**
+   * @brief Graph in compressed sparse row form with SoA positions.
+   *
+   * The neighbours of node i are neighbors[offsets[i] .. offsets[i + 1]),
+   * sorted and without duplicates or self-loops.
+   */
+  struct Graph {
+    std::vector<int> offsets;
+    std::vector<int> neighbors;
+    std::vector<double> x, y, z;
+    std::vector<uint8_t> fixed;
+
+    int size() const { return (int)x.size(); }
+    int degree(int i) const { return offsets[i + 1] - offsets[i]; }
+    bool isFixed(int i) const { return fixed[i] != 0; }
+    gp_Pnt point(int i) const { return gp_Pnt(x[i], y[i], z[i]); }
+    void setPoint(int i, const gp_Pnt &p) {
+      x[i] = p.X();
+      y[i] = p.Y();
+      z[i] = p.Z();
+    }
+
+    /** @brief Appends a node and returns its index. */
+    int addNode(const gp_Pnt &p, bool isFixed);
+
+    /**
+     * @brief Builds the adjacency from undirected links.
+     *
+     * Each link connects both ways; repeated links and self-loops are
+     * dropped. Call once all nodes have been added.
+     */
+    void setLinks(const std::vector<std::pair<int, int>> &links);
+  };
+
+  /**
+   * @brief Partition of the nodes into independent sets.
+   *
+   * No two nodes of one colour are neighbours. Nodes of colour c are
+   * nodes[offsets[c] .. offsets[c + 1]), in ascending index order.
+   */
+  struct Colouring {
+    std::vector<int> offsets;
+    std::vector<int> nodes;
+
+    int numColours() const {
+      return offsets.empty() ? 0 : (int)offsets.size() - 1;
+    }
+  };
+
+  static constexpr int kEstimateSweeps = 8;
+
+  enum class Ordering {
+    Sequential, // In-place Gauss-Seidel in node order (single thread)
+    Coloured    // Colour by colour, each colour split across threads
   };
 
   struct Params {
     int iterations = 1000;
     double relaxation = 0.5; // Lower default for graphs to maintain stability
+    bool autoRelaxation = false; // Estimate SOR factor from the sweeps
+    Ordering ordering = Ordering::Sequential;
+    // Sweeps from one projecting sweep to the next, adapted within
+    // [1, maxProjectionInterval] (see ProjectionSchedule). A maximum of 1
+    // projects every node as soon as it is relaxed.
+    int projectionInterval = 1;
+    int maxProjectionInterval = 1;
+    // Converged once a projecting sweep moves no node further than this
+    double tolerance = 1e-9;
+    // Optional; polled after every projecting sweep, which returns the
+    // graph as it is
+    const CancelToken *cancel = nullptr;
   };
 
+  /**
+   * @brief Renumbers the graph in reverse Cuthill-McKee order.
+   *
+   * Keeps neighbours close together in memory for the sweeps. Positions,
+   * fixed flags and adjacency are permuted in place.
+   *
+   * @return New index of every old node index
+   */
+  static std::vector<int> reorderRCM(Graph &graph);
+
+  /**
+   * @brief Greedy colouring in node order (smallest colour not taken by a
+   * neighbour).
+   *
+   * Depends only on the adjacency, so it stays valid for as long as the
+   * connectivity does, whatever happens to positions and fixed flags.
+   */
+  static Colouring colourGreedy(const Graph &graph);
+
   /**
    * @brief Smooths a general graph of nodes.
    *
-   * @param nodes List of graph nodes (positions and connectivity)
+   * @param graph Node positions and connectivity, updated in place
    * @param params Solver parameters
    * @param constraintFunc Optional function to project points back to geometry
    * @param progressFunc Optional callback for progress reporting
+   * @param colouring Colouring for Ordering::Coloured; computed on the fly
+   * if null. With that ordering the constraint function is called from
+   * worker threads and must be thread-safe.
+   * @param relaxationUsed Optional; receives the relaxation factor of the
+   * last sweep
    * @return std::vector<double> Convergence history (max displacement per
    * iteration)
+   *
+   * With params.autoRelaxation the sweeps start as plain Gauss-Seidel.
+   * Once the displacement decay rate has been steady for kEstimateSweeps
+   * sweeps, the Jacobi spectral radius it implies gives a new SOR factor,
+   * and so on while that raises omega. It backs off if the iteration
+   * diverges (see RelaxationControl).
+   *
+   * With params.maxProjectionInterval above 1 only every few sweeps call
+   * the constraint function, as in EllipticSolver::smoothGrid(), and only
+   * those can count as converged.
    */
   static std::vector<double> smoothGraph(
-      std::vector<Node> &nodes, const Params &params,
+      Graph &graph, const Params &params,
       std::function<gp_Pnt(int, const gp_Pnt &)> constraintFunc = nullptr,
-      std::function<void(int, double)> progressFunc = nullptr);
+      std::function<void(int, double)> progressFunc = nullptr,
+      const Colouring *colouring = nullptr, double *relaxationUsed = nullptr);
 };
 
 #endif // GRAPHSOLVER_H
@@ -49,12 +49,12 @@ bool MeshExporter::exportToVTK(const QString &filename, const Topology *topo,
   for (auto it = smoothedFaces.begin(); it != smoothedFaces.end(); ++it) {
     int faceId = it.key();
     const Smoother::SmoothedFace &sf = it.value();
-    const auto &grid = sf.grid;
-    if (grid.empty() || grid[0].empty())
+    const StructuredGrid &grid = sf.grid; // Read the solver buffer in place
+    if (grid.empty())
       continue;
 
-    int M = grid.size() - 1;
-    int N = grid[0].size() - 1;
+    int M = grid.rows() - 1;
+    int N = grid.cols() - 1;
 
     // Get Face Group ID
     int faceGroupId = 0;
@@ -67,7 +67,7 @@ bool MeshExporter::exportToVTK(const QString &filename, const Topology *topo,
 
     for (int i = 0; i <= M; ++i) {
       for (int j = 0; j <= N; ++j) {
-        const gp_Pnt &p = grid[i][j];
+        const gp_Pnt p = grid.point(i, j);
         if (pointMap.find(p) == pointMap.end()) {
           int newIdx = (int)allPoints.size();
           pointMap[p] = newIdx;
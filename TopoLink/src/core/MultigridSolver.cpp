@@ -0,0 +1,335 @@
+#include "MultigridSolver.h"
+#include <algorithm>
+#include <cmath>
+
+MultigridSolver::MultigridSolver(const StructuredGrid &grid)
+    : _rows(grid.rows()), _cols(grid.cols()) {
+  if (grid.empty())
+    return;
+
+  Axis fineI = uniformAxis(_rows);
+  Axis fineJ = uniformAxis(_cols);
+
+  while (true) {
+    const Axis &pi = _levels.empty() ? fineI : _levels.back().ai;
+    const Axis &pj = _levels.empty() ? fineJ : _levels.back().aj;
+    bool halveI = pi.n - 1 >= kMinIntervals;
+    bool halveJ = pj.n - 1 >= kMinIntervals;
+    if (!halveI && !halveJ)
+      break;
+
+    Level level;
+    level.ai = coarsen(pi, halveI);
+    level.aj = coarsen(pj, halveJ);
+    level.rows = level.ai.n;
+    level.cols = level.aj.n;
+
+    // A coarse point is fixed when the finer point it sits on is fixed
+    size_t n = (size_t)level.rows * level.cols;
+    level.fixed.assign(n, 0);
+    for (int I = 0; I < level.rows; ++I) {
+      for (int J = 0; J < level.cols; ++J) {
+        int pI = level.ai.parent[I];
+        int pJ = level.aj.parent[J];
+        bool fixed =
+            _levels.empty()
+                ? grid.isFixed(pI, pJ)
+                : _levels.back().fixed[pI * _levels.back().cols + pJ] != 0;
+        level.fixed[I * level.cols + J] = fixed ? 1 : 0;
+      }
+    }
+    level.e.assign(n, gp_XYZ(0.0, 0.0, 0.0));
+    level.r.assign(n, gp_XYZ(0.0, 0.0, 0.0));
+    level.res.assign(n, gp_XYZ(0.0, 0.0, 0.0));
+    _levels.push_back(std::move(level));
+  }
+
+  _fineResidual.assign((size_t)_rows * _cols, gp_XYZ(0.0, 0.0, 0.0));
+}
+
+MultigridSolver::Axis MultigridSolver::uniformAxis(int n) {
+  Axis axis;
+  axis.n = n;
+  axis.coord.resize(n);
+  for (int i = 0; i < n; ++i)
+    axis.coord[i] = i;
+  return axis;
+}
+
+MultigridSolver::Axis MultigridSolver::coarsen(const Axis &fine, bool halve) {
+  Axis c;
+  int Mf = fine.n - 1;
+  c.n = halve ? (Mf + 1) / 2 + 1 : fine.n;
+  c.parent.resize(c.n);
+  c.coord.resize(c.n);
+  for (int I = 0; I < c.n; ++I) {
+    c.parent[I] = halve ? std::min(2 * I, Mf) : I;
+    c.coord[I] = fine.coord[c.parent[I]];
+  }
+
+  // Linear interpolation between the coarse points bracketing each fine one
+  c.lo.resize(fine.n);
+  c.hi.resize(fine.n);
+  c.t.resize(fine.n);
+  int I = 0;
+  for (int i = 0; i < fine.n; ++i) {
+    while (I + 1 < c.n && c.parent[I + 1] <= i)
+      ++I;
+    if (c.parent[I] == i || I + 1 >= c.n) {
+      c.lo[i] = c.hi[i] = I;
+      c.t[i] = 0.0;
+    } else {
+      c.lo[i] = I;
+      c.hi[i] = I + 1;
+      c.t[i] = (fine.coord[i] - c.coord[I]) / (c.coord[I + 1] - c.coord[I]);
+    }
+  }
+
+  // Restriction is the transposed interpolation, each row scaled to sum to 1
+  c.restriction.assign(c.n, {});
+  for (int i = 0; i < fine.n; ++i) {
+    c.restriction[c.lo[i]].emplace_back(i, 1.0 - c.t[i]);
+    if (c.hi[i] != c.lo[i])
+      c.restriction[c.hi[i]].emplace_back(i, c.t[i]);
+  }
+  for (auto &row : c.restriction) {
+    double sum = 0.0;
+    for (const auto &w : row)
+      sum += w.second;
+    if (sum > 0.0) {
+      for (auto &w : row)
+        w.second /= sum;
+    }
+  }
+
+  computeWeights(c);
+  return c;
+}
+
+void MultigridSolver::computeWeights(Axis &axis) {
+  // Second difference on a non-uniform axis; reduces to weight 1 for each
+  // neighbour on the unit-spaced finest grid, matching the SOR stencil.
+  axis.wPrev.assign(axis.n, 0.0);
+  axis.wNext.assign(axis.n, 0.0);
+  for (int I = 0; I < axis.n; ++I) {
+    bool hasPrev = I > 0;
+    bool hasNext = I + 1 < axis.n;
+    double a = hasPrev ? axis.coord[I] - axis.coord[I - 1] : 0.0;
+    double b = hasNext ? axis.coord[I + 1] - axis.coord[I] : 0.0;
+    if (hasPrev && hasNext) {
+      axis.wPrev[I] = 2.0 / (a * (a + b));
+      axis.wNext[I] = 2.0 / (b * (a + b));
+    } else if (hasPrev) {
+      axis.wPrev[I] = 1.0 / (a * a);
+    } else if (hasNext) {
+      axis.wNext[I] = 1.0 / (b * b);
+    }
+  }
+}
+
+void MultigridSolver::restrictTo(const std::vector<gp_XYZ> &fine,
+                                 int fineRows, int fineCols, Level &coarse) {
+  // Separable: along j first, then along i
+  _rowPass.assign((size_t)fineRows * coarse.cols, gp_XYZ(0.0, 0.0, 0.0));
+  for (int i = 0; i < fineRows; ++i) {
+    for (int J = 0; J < coarse.cols; ++J) {
+      gp_XYZ sum(0.0, 0.0, 0.0);
+      for (const auto &w : coarse.aj.restriction[J])
+        sum += fine[i * fineCols + w.first] * w.second;
+      _rowPass[i * coarse.cols + J] = sum;
+    }
+  }
+  for (int I = 0; I < coarse.rows; ++I) {
+    for (int J = 0; J < coarse.cols; ++J) {
+      int k = I * coarse.cols + J;
+      if (coarse.fixed[k]) {
+        coarse.r[k] = gp_XYZ(0.0, 0.0, 0.0);
+        continue;
+      }
+      gp_XYZ sum(0.0, 0.0, 0.0);
+      for (const auto &w : coarse.ai.restriction[I])
+        sum += _rowPass[w.first * coarse.cols + J] * w.second;
+      coarse.r[k] = sum;
+    }
+  }
+}
+
+gp_XYZ MultigridSolver::interpolate(const Level &coarse, int i, int j) {
+  const Axis &ai = coarse.ai;
+  const Axis &aj = coarse.aj;
+  double ti = ai.t[i];
+  double tj = aj.t[j];
+  const std::vector<gp_XYZ> &e = coarse.e;
+  int c = coarse.cols;
+
+  gp_XYZ v = e[ai.lo[i] * c + aj.lo[j]] * ((1.0 - ti) * (1.0 - tj));
+  if (tj > 0.0)
+    v += e[ai.lo[i] * c + aj.hi[j]] * ((1.0 - ti) * tj);
+  if (ti > 0.0) {
+    v += e[ai.hi[i] * c + aj.lo[j]] * (ti * (1.0 - tj));
+    if (tj > 0.0)
+      v += e[ai.hi[i] * c + aj.hi[j]] * (ti * tj);
+  }
+  return v;
+}
+
+void MultigridSolver::relax(Level &level) {
+  // Gauss-Seidel on A e = r, A e = sum of w * (e - e_neighbour)
+  const Axis &ai = level.ai;
+  const Axis &aj = level.aj;
+  const int c = level.cols;
+  for (int I = 0; I < level.rows; ++I) {
+    for (int J = 0; J < c; ++J) {
+      int k = I * c + J;
+      if (level.fixed[k])
+        continue;
+      double diag = 0.0;
+      gp_XYZ sum = level.r[k];
+      if (I > 0) {
+        sum += level.e[k - c] * ai.wPrev[I];
+        diag += ai.wPrev[I];
+      }
+      if (I + 1 < level.rows) {
+        sum += level.e[k + c] * ai.wNext[I];
+        diag += ai.wNext[I];
+      }
+      if (J > 0) {
+        sum += level.e[k - 1] * aj.wPrev[J];
+        diag += aj.wPrev[J];
+      }
+      if (J + 1 < c) {
+        sum += level.e[k + 1] * aj.wNext[J];
+        diag += aj.wNext[J];
+      }
+      if (diag > 0.0)
+        level.e[k] = sum / diag;
+    }
+  }
+}
+
+void MultigridSolver::residual(Level &level) {
+  const Axis &ai = level.ai;
+  const Axis &aj = level.aj;
+  const int c = level.cols;
+  for (int I = 0; I < level.rows; ++I) {
+    for (int J = 0; J < c; ++J) {
+      int k = I * c + J;
+      if (level.fixed[k]) {
+        level.res[k] = gp_XYZ(0.0, 0.0, 0.0);
+        continue;
+      }
+      gp_XYZ rk = level.r[k];
+      const gp_XYZ &ek = level.e[k];
+      if (I > 0)
+        rk += (level.e[k - c] - ek) * ai.wPrev[I];
+      if (I + 1 < level.rows)
+        rk += (level.e[k + c] - ek) * ai.wNext[I];
+      if (J > 0)
+        rk += (level.e[k - 1] - ek) * aj.wPrev[J];
+      if (J + 1 < c)
+        rk += (level.e[k + 1] - ek) * aj.wNext[J];
+      level.res[k] = rk;
+    }
+  }
+}
+
+void MultigridSolver::cycleLevel(size_t k) {
+  Level &level = _levels[k];
+  std::fill(level.e.begin(), level.e.end(), gp_XYZ(0.0, 0.0, 0.0));
+
+  if (k + 1 == _levels.size()) {
+    for (int s = 0; s < kCoarsestSweeps; ++s)
+      relax(level);
+    return;
+  }
+
+  for (int s = 0; s < kPreSmooth; ++s)
+    relax(level);
+
+  residual(level);
+  Level &coarse = _levels[k + 1];
+  restrictTo(level.res, level.rows, level.cols, coarse);
+  cycleLevel(k + 1);
+
+  for (int I = 0; I < level.rows; ++I) {
+    for (int J = 0; J < level.cols; ++J) {
+      int idx = I * level.cols + J;
+      if (!level.fixed[idx])
+        level.e[idx] += interpolate(coarse, I, J);
+    }
+  }
+
+  for (int s = 0; s < kPostSmooth; ++s)
+    relax(level);
+}
+
+double MultigridSolver::vCycle(StructuredGrid &grid,
+                               const SmoothFunc &fineSmooth,
+                               const ConstraintFunc &constraintFunc) {
+  if (grid.empty())
+    return 0.0;
+
+  _startX.assign(grid.x(), grid.x() + (size_t)_rows * grid.stride());
+  _startY.assign(grid.y(), grid.y() + (size_t)_rows * grid.stride());
+  _startZ.assign(grid.z(), grid.z() + (size_t)_rows * grid.stride());
+
+  for (int s = 0; s < kPreSmooth; ++s)
+    fineSmooth(grid);
+
+  if (!_levels.empty()) {
+    // Residual of the unit-weight Laplacian used by the SOR sweep
+    const int stride = grid.stride();
+    const double *x = grid.x();
+    const double *y = grid.y();
+    const double *z = grid.z();
+    for (int i = 0; i < _rows; ++i) {
+      for (int j = 0; j < _cols; ++j) {
+        int k = grid.index(i, j);
+        gp_XYZ &rk = _fineResidual[i * _cols + j];
+        rk = gp_XYZ(0.0, 0.0, 0.0);
+        if (grid.isFixedAt(k))
+          continue;
+        gp_XYZ uk(x[k], y[k], z[k]);
+        if (i > 0)
+          rk += gp_XYZ(x[k - stride], y[k - stride], z[k - stride]) - uk;
+        if (i + 1 < _rows)
+          rk += gp_XYZ(x[k + stride], y[k + stride], z[k + stride]) - uk;
+        if (j > 0)
+          rk += gp_XYZ(x[k - 1], y[k - 1], z[k - 1]) - uk;
+        if (j + 1 < _cols)
+          rk += gp_XYZ(x[k + 1], y[k + 1], z[k + 1]) - uk;
+      }
+    }
+
+    restrictTo(_fineResidual, _rows, _cols, _levels[0]);
+    cycleLevel(0);
+
+    for (int i = 0; i < _rows; ++i) {
+      for (int j = 0; j < _cols; ++j) {
+        if (grid.isFixed(i, j))
+          continue;
+        gp_Pnt p(grid.point(i, j).XYZ() + interpolate(_levels[0], i, j));
+        if (constraintFunc)
+          p = constraintFunc(i, j, p);
+        grid.setPoint(i, j, p);
+      }
+    }
+  }
+
+  for (int s = 0; s < kPostSmooth; ++s)
+    fineSmooth(grid);
+
+  double maxDisplacement = 0.0;
+  for (int i = 0; i < _rows; ++i) {
+    for (int j = 0; j < _cols; ++j) {
+      int k = grid.index(i, j);
+      double dx = grid.x()[k] - _startX[k];
+      double dy = grid.y()[k] - _startY[k];
+      double dz = grid.z()[k] - _startZ[k];
+      double distSq = dx * dx + dy * dy + dz * dz;
+      if (distSq > maxDisplacement)
+        maxDisplacement = distSq;
+    }
+  }
+  return std::sqrt(maxDisplacement);
+}
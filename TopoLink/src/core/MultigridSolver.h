@@ -0,0 +1,90 @@
+#ifndef MULTIGRIDSOLVER_H
+#define MULTIGRIDSOLVER_H
+
+#include "StructuredGrid.h"
+#include <functional>
+#include <gp_Pnt.hxx>
+#include <gp_XYZ.hxx>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Geometric multigrid hierarchy for smoothing a structured face grid.
+ *
+ * Every coarse level halves the interval count along each axis that still
+ * has at least kMinIntervals intervals. Coarse points keep their
+ * finest-grid index coordinates, so along an odd axis the last coarse
+ * interval is shorter and the coarse operators use a non-uniform 5-point
+ * stencil. The finest level is the caller's grid; coarse levels only hold
+ * corrections (correction scheme), interpolated back bilinearly.
+ */
+class MultigridSolver {
+public:
+  using ConstraintFunc = std::function<gp_Pnt(int, int, const gp_Pnt &)>;
+  using SmoothFunc = std::function<void(StructuredGrid &)>;
+
+  static constexpr int kMinIntervals = 4;
+  static constexpr int kPreSmooth = 2;
+  static constexpr int kPostSmooth = 2;
+  static constexpr int kCoarsestSweeps = 50;
+
+  /** @brief Builds the level hierarchy from the grid's size and fixed mask. */
+  explicit MultigridSolver(const StructuredGrid &grid);
+
+  /**
+   * @brief Runs one V-cycle on the finest grid in place.
+   *
+   * @param grid Finest grid, same size and mask as at construction
+   * @param fineSmooth One relaxation sweep on the finest grid (including any
+   * projection)
+   * @param constraintFunc Optional projection applied to corrected points
+   * @return Maximum point displacement over the whole cycle
+   */
+  double vCycle(StructuredGrid &grid, const SmoothFunc &fineSmooth,
+                const ConstraintFunc &constraintFunc);
+
+  int numLevels() const { return (int)_levels.size() + 1; }
+
+private:
+  // One axis of a coarse level, relative to the next finer level's axis
+  struct Axis {
+    int n = 0;                  // point count
+    std::vector<double> coord;  // finest-grid index coordinate per point
+    std::vector<int> parent;    // matching point on the finer axis
+    std::vector<double> wPrev;  // stencil weight towards point - 1
+    std::vector<double> wNext;  // stencil weight towards point + 1
+    std::vector<int> lo, hi;    // per finer point: bracketing coarse points
+    std::vector<double> t;      // per finer point: weight of hi
+    std::vector<std::vector<std::pair<int, double>>> restriction;
+  };
+
+  struct Level {
+    int rows = 0;
+    int cols = 0;
+    Axis ai, aj;
+    std::vector<char> fixed;
+    std::vector<gp_XYZ> e;   // correction
+    std::vector<gp_XYZ> r;   // right-hand side (restricted residual)
+    std::vector<gp_XYZ> res; // residual of e, restricted to the next level
+  };
+
+  static Axis uniformAxis(int n);
+  static Axis coarsen(const Axis &fine, bool halve);
+  static void computeWeights(Axis &axis);
+
+  void restrictTo(const std::vector<gp_XYZ> &fine, int fineRows,
+                  int fineCols, Level &coarse);
+  static gp_XYZ interpolate(const Level &coarse, int i, int j);
+  static void relax(Level &level);
+  static void residual(Level &level);
+  void cycleLevel(size_t k);
+
+  int _rows = 0;
+  int _cols = 0;
+  std::vector<Level> _levels; // _levels[k] is level k + 1
+  std::vector<gp_XYZ> _fineResidual;
+  std::vector<gp_XYZ> _rowPass; // scratch for separable restriction
+  StructuredGrid::Buffer _startX, _startY, _startZ;
+};
+
+#endif // MULTIGRIDSOLVER_H
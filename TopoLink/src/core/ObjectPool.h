@@ -1,13 +1,34 @@
 #ifndef OBJECT_POOL_H
 #define OBJECT_POOL_H
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
-#include <unordered_set>
+#include <new>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief Block allocator for one object type.
+ *
+ * Objects live in fixed-size blocks. Free slots are chained through their
+ * own storage, one list per block, and a bitmap per block marks the live
+ * ones, so clear() and forEachLive() visit only blocks and live objects.
+ * A block that empties is kept for reuse while it is the only empty one;
+ * any further empty block is given back at once, and trim() gives back the
+ * last one too. Pointers stay valid until their object is deallocated.
+ */
 template <typename T, size_t BlockSize = 4096> class ObjectPool {
 public:
+  struct Stats {
+    size_t live = 0;     // Objects allocated and not yet deallocated
+    size_t capacity = 0; // Slots in all blocks
+    size_t blocks = 0;
+    size_t bytes = 0; // Memory held by blocks, bookkeeping included
+  };
+
   ObjectPool() = default;
 
   // Disable copy/move to prevent complex ownership issues
@@ -16,71 +37,199 @@ public:
 
   ~ObjectPool() { clear(); }
 
+  /** @brief Destroys all live objects and gives back every block. */
   void clear() {
-    // Identify free slots for fast lookup
-    std::unordered_set<T *> freeSet(_freeList.begin(), _freeList.end());
-
-    size_t count = BlockSize / sizeof(T);
-    if (count == 0)
-      count = 1;
-
-    // Walk all blocks and destruct live (non-free) objects
-    for (auto &block : _blocks) {
-      char *start = block.get();
-      for (size_t i = 0; i < count; ++i) {
-        T *ptr = reinterpret_cast<T *>(start + i * sizeof(T));
-        if (freeSet.find(ptr) == freeSet.end()) {
-          ptr->~T();
-        }
-      }
-    }
-
+    for (auto &block : _blocks)
+      forEachLiveIn(*block, [](T &object) { object.~T(); });
     _blocks.clear();
-    _freeList.clear();
+    _byAddress.clear();
+    _partial.clear();
+    _live = 0;
+    _emptyBlocks = 0;
   }
 
   template <typename... Args> T *allocate(Args &&...args) {
-    if (_freeList.empty()) {
+    if (_partial.empty())
       allocateBlock();
-    }
 
-    T *ptr = _freeList.back();
-    _freeList.pop_back();
+    Block *block = _partial.back();
+    FreeSlot *slot = block->freeList;
+    block->freeList = slot->next;
+    if (!block->freeList)
+      removePartial(block);
+
+    T *ptr = reinterpret_cast<T *>(slot);
+    try {
+      new (ptr) T(std::forward<Args>(args)...); // Construct in place
+    } catch (...) {
+      pushFree(block, slot);
+      throw;
+    }
 
-    // Construct in place
-    new (ptr) T(std::forward<Args>(args)...);
+    if (block->live++ == 0)
+      --_emptyBlocks;
+    size_t i = indexOf(*block, ptr);
+    block->bits[i / 64] |= uint64_t(1) << (i % 64);
+    ++_live;
     return ptr;
   }
 
   void deallocate(T *ptr) {
     if (!ptr)
       return;
+    Block *block = owner(ptr);
     ptr->~T(); // Call destructor
-    _freeList.push_back(ptr);
+
+    size_t i = indexOf(*block, ptr);
+    block->bits[i / 64] &= ~(uint64_t(1) << (i % 64));
+    --_live;
+    pushFree(block, reinterpret_cast<FreeSlot *>(ptr));
+    if (--block->live == 0 && ++_emptyBlocks > 1)
+      releaseBlock(block);
+  }
+
+  /** @brief Calls f(T &) for every live object, block by block. */
+  template <typename F> void forEachLive(F f) {
+    for (auto &block : _blocks)
+      forEachLiveIn(*block, f);
+  }
+
+  /** @brief Gives back all empty blocks. @return Number given back */
+  size_t trim() {
+    std::vector<Block *> empty;
+    for (auto &block : _blocks) {
+      if (block->live == 0)
+        empty.push_back(block.get());
+    }
+    for (Block *block : empty)
+      releaseBlock(block);
+    return empty.size();
+  }
+
+  Stats stats() const {
+    Stats s;
+    s.live = _live;
+    s.blocks = _blocks.size();
+    s.capacity = s.blocks * kSlotsPerBlock;
+    s.bytes = s.blocks * (sizeof(Block) + kSlotsPerBlock * kSlotSize +
+                          kWords * sizeof(uint64_t));
+    return s;
   }
 
 private:
-  void allocateBlock() {
-    // Calculate how many objects fit in BlockSize (minimum 1)
-    size_t count = BlockSize / sizeof(T);
-    if (count == 0)
-      count = 1;
-
-    // Allocate a new block of raw memory
-    // We use char[] to avoid default construction of T
-    std::unique_ptr<char[]> block(new char[count * sizeof(T)]);
-
-    // Add pointers to the free list
-    char *start = block.get();
-    for (size_t i = 0; i < count; ++i) {
-      _freeList.push_back(reinterpret_cast<T *>(start + i * sizeof(T)));
+  struct FreeSlot {
+    FreeSlot *next;
+  };
+
+  // Slots hold either an object or a free-list link
+  static constexpr size_t kAlign = std::max(alignof(T), alignof(FreeSlot));
+  static constexpr size_t kSlotSize =
+      (std::max(sizeof(T), sizeof(FreeSlot)) + kAlign - 1) / kAlign * kAlign;
+  static constexpr size_t kSlotsPerBlock =
+      std::max<size_t>(BlockSize / kSlotSize, 1);
+  static constexpr size_t kWords = (kSlotsPerBlock + 63) / 64;
+  static_assert(kAlign <= alignof(std::max_align_t),
+                "over-aligned types are not supported");
+
+  struct Block {
+    std::unique_ptr<unsigned char[]> storage;
+    std::vector<uint64_t> bits; // Live slots
+    FreeSlot *freeList = nullptr;
+    size_t live = 0;
+    size_t partialPos = SIZE_MAX; // Index in _partial, if there
+    size_t blockPos = 0;          // Index in _blocks
+  };
+
+  static size_t indexOf(const Block &block, const T *ptr) {
+    return (reinterpret_cast<const unsigned char *>(ptr) -
+            block.storage.get()) /
+           kSlotSize;
+  }
+
+  static int lowestBit(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+      word >>= 1;
+      ++bit;
+    }
+    return bit;
+#endif
+  }
+
+  template <typename F> static void forEachLiveIn(Block &block, F &&f) {
+    for (size_t w = 0; w < kWords; ++w) {
+      for (uint64_t word = block.bits[w]; word; word &= word - 1) {
+        size_t i = w * 64 + lowestBit(word);
+        f(*reinterpret_cast<T *>(block.storage.get() + i * kSlotSize));
+      }
     }
+  }
 
+  Block *owner(const T *ptr) const {
+    auto it = _byAddress.upper_bound(
+        reinterpret_cast<const unsigned char *>(ptr));
+    return std::prev(it)->second;
+  }
+
+  void pushFree(Block *block, FreeSlot *slot) {
+    if (!block->freeList) {
+      block->partialPos = _partial.size();
+      _partial.push_back(block);
+    }
+    slot->next = block->freeList;
+    block->freeList = slot;
+  }
+
+  void removePartial(Block *block) {
+    Block *last = _partial.back();
+    _partial[block->partialPos] = last;
+    last->partialPos = block->partialPos;
+    _partial.pop_back();
+    block->partialPos = SIZE_MAX;
+  }
+
+  void allocateBlock() {
+    auto block = std::make_unique<Block>();
+    // We use raw bytes to avoid default construction of T
+    block->storage.reset(new unsigned char[kSlotsPerBlock * kSlotSize]);
+    block->bits.assign(kWords, 0);
+
+    // Chain the slots so the first is handed out first
+    for (size_t i = kSlotsPerBlock; i-- > 0;) {
+      auto *slot = reinterpret_cast<FreeSlot *>(block->storage.get() +
+                                                i * kSlotSize);
+      slot->next = block->freeList;
+      block->freeList = slot;
+    }
+    block->partialPos = _partial.size();
+    _partial.push_back(block.get());
+    _byAddress[block->storage.get()] = block.get();
+    ++_emptyBlocks;
+    block->blockPos = _blocks.size();
     _blocks.push_back(std::move(block));
   }
 
-  std::vector<std::unique_ptr<char[]>> _blocks;
-  std::vector<T *> _freeList;
+  void releaseBlock(Block *block) {
+    if (block->partialPos != SIZE_MAX)
+      removePartial(block);
+    _byAddress.erase(block->storage.get());
+    --_emptyBlocks;
+    size_t pos = block->blockPos;
+    if (pos + 1 != _blocks.size()) {
+      std::swap(_blocks[pos], _blocks.back());
+      _blocks[pos]->blockPos = pos;
+    }
+    _blocks.pop_back(); // Frees the block
+  }
+
+  std::vector<std::unique_ptr<Block>> _blocks;
+  std::map<const unsigned char *, Block *> _byAddress; // Block start -> block
+  std::vector<Block *> _partial; // Blocks with free slots
+  size_t _live = 0;
+  size_t _emptyBlocks = 0;
 };
 
 #endif // OBJECT_POOL_H
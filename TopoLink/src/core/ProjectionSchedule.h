@@ -0,0 +1,61 @@
+#ifndef PROJECTIONSCHEDULE_H
+#define PROJECTIONSCHEDULE_H
+
+#include <algorithm>
+
+/**
+ * @brief Decides which relaxation sweeps project onto the constraint.
+ *
+ * Projecting onto CAD geometry costs far more than a sweep, and most
+ * sweeps move points mainly along the surface, so only every few sweeps
+ * project; the others run unconstrained. After each projecting sweep the
+ * interval doubles (up to maxInterval) while projection corrected points
+ * by less than kLengthenRatio times their net motion since the previous
+ * projecting sweep, and halves (down to 1) once it corrected more than
+ * kShortenRatio times that motion. Close to convergence the net motion
+ * vanishes while the surface drift does not, so the schedule ends up
+ * projecting every sweep and converges to the same grid as projecting
+ * throughout. The final sweep always projects.
+ */
+class ProjectionSchedule {
+public:
+  static constexpr double kLengthenRatio = 0.1;
+  static constexpr double kShortenRatio = 0.5;
+
+  ProjectionSchedule(int interval, int maxInterval)
+      : _maxInterval(std::max(1, maxInterval)),
+        _interval(std::min(std::max(1, interval), _maxInterval)) {}
+
+  /** @brief False if every sweep projects (maxInterval of 1). */
+  bool adaptive() const { return _maxInterval > 1; }
+  int interval() const { return _interval; }
+
+  /** @brief Whether sweep it of iterations should project. */
+  bool projects(int it, int iterations) const {
+    return _sinceProjection + 1 >= _interval || it + 1 >= iterations;
+  }
+
+  /** @brief Records an unconstrained sweep. */
+  void skipped() { ++_sinceProjection; }
+
+  /**
+   * @brief Records a projecting sweep.
+   * @param drift Largest distance projection moved a point
+   * @param net Largest distance a point moved since the previous
+   * projecting sweep
+   */
+  void projected(double drift, double net) {
+    _sinceProjection = 0;
+    if (drift < kLengthenRatio * net)
+      _interval = std::min(2 * _interval, _maxInterval);
+    else if (drift > kShortenRatio * net)
+      _interval = std::max(_interval / 2, 1);
+  }
+
+private:
+  int _maxInterval;
+  int _interval;
+  int _sinceProjection = 0;
+};
+
+#endif // PROJECTIONSCHEDULE_H
@@ -0,0 +1,249 @@
+#include "ProjectionTarget.h"
+
+#include <BRepBuilderAPI_MakeVertex.hxx>
+#include <BRepExtrema_DistShapeShape.hxx>
+#include <BRepTopAdaptor_FClass2d.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Tool.hxx>
+#include <GeomAdaptor_Curve.hxx>
+#include <Precision.hxx>
+#include <QMutexLocker>
+#include <ShapeAnalysis_Curve.hxx>
+#include <ShapeAnalysis_Surface.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <cmath>
+#include <gp_Pnt2d.hxx>
+
+namespace {
+
+// Representative of x modulo period closest to centre; x if not periodic
+double nearestPeriod(double x, double centre, double period) {
+  if (period <= 0.0)
+    return x;
+  return x - period * std::round((x - centre) / period);
+}
+
+// Half-way point of a face's parameter range and the surface's periods,
+// used to bring surface parameters into the face's period
+struct PeriodFrame {
+  double uMid = 0.0, vMid = 0.0;
+  double uPeriod = 0.0, vPeriod = 0.0; // 0 if not periodic
+
+  PeriodFrame() = default;
+  PeriodFrame(const Handle(Geom_Surface) & surface, double uMin, double uMax,
+              double vMin, double vMax)
+      : uMid(0.5 * (uMin + uMax)), vMid(0.5 * (vMin + vMax)),
+        uPeriod(surface->IsUPeriodic() ? surface->UPeriod() : 0.0),
+        vPeriod(surface->IsVPeriodic() ? surface->VPeriod() : 0.0) {}
+
+  gp_Pnt2d wrap(const gp_Pnt2d &uv) const {
+    return gp_Pnt2d(nearestPeriod(uv.X(), uMid, uPeriod),
+                    nearestPeriod(uv.Y(), vMid, vPeriod));
+  }
+};
+
+} // namespace
+
+// Evaluation state for one thread: analysers and classifiers keep mutable
+// caches, so every concurrent caller needs its own set.
+class ProjectionTarget::Evaluator {
+public:
+  Evaluator(const std::vector<TopoDS_Shape> &patches, bool onEdges) {
+    for (const TopoDS_Shape &patch : patches) {
+      if (onEdges) {
+        EdgePatch ep;
+        double first = 0.0, last = 0.0;
+        Handle(Geom_Curve) curve =
+            BRep_Tool::Curve(TopoDS::Edge(patch), first, last);
+        if (!curve.IsNull()) {
+          ep.curve.Load(curve, first, last);
+          ep.valid = true;
+        }
+        _edges.push_back(std::move(ep));
+      } else {
+        const TopoDS_Face &face = TopoDS::Face(patch);
+        FacePatch fp;
+        Handle(Geom_Surface) surface = BRep_Tool::Surface(face);
+        double uMin = 0.0, uMax = 0.0, vMin = 0.0, vMax = 0.0;
+        BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
+        fp.frame = PeriodFrame(surface, uMin, uMax, vMin, vMax);
+        fp.analysis = new ShapeAnalysis_Surface(surface);
+        fp.classifier = std::make_unique<BRepTopAdaptor_FClass2d>(
+            face, BRep_Tool::Tolerance(face));
+        _faces.push_back(std::move(fp));
+      }
+    }
+  }
+
+  // Closest point on the faces; false if it lies outside every face
+  bool projectFaces(const gp_Pnt &p, Hint &hint, double tol, gp_Pnt &out) {
+    // Warm start: a few Newton steps from the last parameters. Only a
+    // result strictly inside the face is trusted; near a face boundary a
+    // neighbouring face may be closer.
+    if (hint.patch >= 0 && hint.patch < (int)_faces.size()) {
+      FacePatch &fp = _faces[hint.patch];
+      gp_Pnt2d uv = fp.frame.wrap(
+          fp.analysis->NextValueOfUV(gp_Pnt2d(hint.u, hint.v), p, tol));
+      if (fp.classifier->Perform(uv) == TopAbs_IN) {
+        hint.u = uv.X();
+        hint.v = uv.Y();
+        out = fp.analysis->Value(uv);
+        return true;
+      }
+    }
+
+    double best = -1.0;
+    for (int k = 0; k < (int)_faces.size(); ++k) {
+      FacePatch &fp = _faces[k];
+      // The surface may answer in another period than the face's pcurves
+      gp_Pnt2d uv = fp.frame.wrap(fp.analysis->ValueOfUV(p, tol));
+      if (fp.classifier->Perform(uv) == TopAbs_OUT)
+        continue;
+      double gap = fp.analysis->Gap();
+      if (best < 0.0 || gap < best) {
+        best = gap;
+        hint.patch = k;
+        hint.u = uv.X();
+        hint.v = uv.Y();
+        out = fp.analysis->Value(uv);
+      }
+    }
+    return best >= 0.0;
+  }
+
+  // Closest point on the edges; false only if no edge has a curve
+  bool projectEdges(const gp_Pnt &p, Hint &hint, double tol, gp_Pnt &out) {
+    if (hint.patch >= 0 && hint.patch < (int)_edges.size() &&
+        _edges[hint.patch].valid) {
+      EdgePatch &ep = _edges[hint.patch];
+      gp_Pnt proj;
+      double param = hint.u;
+      _curveAnalysis.NextProject(hint.u, ep.curve, p, tol, proj, param);
+      // At an end point the next edge may be closer. tol is a distance;
+      // the curve's parameter need not be arc length.
+      const double paramTol = ep.curve.Resolution(tol);
+      if (param > ep.curve.FirstParameter() + paramTol &&
+          param < ep.curve.LastParameter() - paramTol) {
+        hint.u = param;
+        out = proj;
+        return true;
+      }
+    }
+
+    double best = -1.0;
+    for (int k = 0; k < (int)_edges.size(); ++k) {
+      EdgePatch &ep = _edges[k];
+      if (!ep.valid)
+        continue;
+      gp_Pnt proj;
+      double param = 0.0;
+      double dist = _curveAnalysis.Project(ep.curve, p, tol, proj, param);
+      if (best < 0.0 || dist < best) {
+        best = dist;
+        hint.patch = k;
+        hint.u = param;
+        out = proj;
+      }
+    }
+    return best >= 0.0;
+  }
+
+private:
+  struct FacePatch {
+    Handle(ShapeAnalysis_Surface) analysis;
+    std::unique_ptr<BRepTopAdaptor_FClass2d> classifier;
+    PeriodFrame frame;
+  };
+  struct EdgePatch {
+    GeomAdaptor_Curve curve;
+    bool valid = false; // false for edges without a 3D curve
+  };
+
+  std::vector<FacePatch> _faces;
+  std::vector<EdgePatch> _edges;
+  ShapeAnalysis_Curve _curveAnalysis;
+};
+
+ProjectionTarget::ProjectionTarget(const TopoDS_Shape &shape)
+    : _shape(shape), _tolerance(Precision::Confusion()) {
+  if (_shape.IsNull())
+    return;
+
+  for (TopExp_Explorer ex(_shape, TopAbs_FACE); ex.More(); ex.Next())
+    _patches.push_back(ex.Current());
+  if (_patches.empty()) {
+    _onEdges = true;
+    for (TopExp_Explorer ex(_shape, TopAbs_EDGE); ex.More(); ex.Next())
+      _patches.push_back(ex.Current());
+  } else if (_patches.size() == 1) {
+    const TopoDS_Face &face = TopoDS::Face(_patches[0]);
+    _surface = BRep_Tool::Surface(face);
+    BRepTools::UVBounds(face, _uMin, _uMax, _vMin, _vMax);
+    if (_surface->IsUPeriodic())
+      _uPeriod = _surface->UPeriod();
+    if (_surface->IsVPeriodic())
+      _vPeriod = _surface->VPeriod();
+  }
+}
+
+ProjectionTarget::~ProjectionTarget() = default;
+
+ProjectionTarget::Evaluator *ProjectionTarget::acquire() const {
+  QMutexLocker locker(&_poolMutex);
+  if (_idle.empty()) {
+    _pool.push_back(std::make_unique<Evaluator>(_patches, _onEdges));
+    return _pool.back().get();
+  }
+  Evaluator *evaluator = _idle.back();
+  _idle.pop_back();
+  return evaluator;
+}
+
+void ProjectionTarget::release(Evaluator *evaluator) const {
+  QMutexLocker locker(&_poolMutex);
+  _idle.push_back(evaluator);
+}
+
+gp_Pnt ProjectionTarget::project(const gp_Pnt &p, Hint &hint) const {
+  if (_shape.IsNull())
+    return p;
+
+  Evaluator *evaluator = acquire();
+  gp_Pnt result;
+  bool found = _onEdges
+                   ? evaluator->projectEdges(p, hint, _tolerance, result)
+                   : evaluator->projectFaces(p, hint, _tolerance, result);
+  release(evaluator);
+
+  if (found)
+    return result;
+
+  // Outside every face's trimming: let BRepExtrema find the closest
+  // boundary point, and search from scratch next time
+  hint.patch = -1;
+  return projectExact(p);
+}
+
+void ProjectionTarget::evaluate(double &u, double &v, gp_Pnt &p, gp_Vec &du,
+                                gp_Vec &dv) const {
+  // A step may carry the parameters of a periodic surface across the seam
+  // (e.g. to 2 pi - 0.1 on a cylinder face from -0.5 to 0.5); take the
+  // representative closest to the face first
+  u = nearestPeriod(u, 0.5 * (_uMin + _uMax), _uPeriod);
+  v = nearestPeriod(v, 0.5 * (_vMin + _vMax), _vPeriod);
+  u = std::min(std::max(u, _uMin), _uMax);
+  v = std::min(std::max(v, _vMin), _vMax);
+  _surface->D1(u, v, p, du, dv);
+}
+
+gp_Pnt ProjectionTarget::projectExact(const gp_Pnt &p) const {
+  BRepExtrema_DistShapeShape extrema(BRepBuilderAPI_MakeVertex(p).Vertex(),
+                                     _shape);
+  if (extrema.IsDone() && extrema.NbSolution() > 0) {
+    // Solution 1 is closest
+    return extrema.PointOnShape2(1);
+  }
+  return p;
+}
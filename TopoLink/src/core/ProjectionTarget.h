@@ -0,0 +1,91 @@
+#ifndef PROJECTIONTARGET_H
+#define PROJECTIONTARGET_H
+
+#include <QMutex>
+#include <Geom_Surface.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Closest-point projection onto a compound of CAD faces or edges.
+ *
+ * Replaces a BRepExtrema_DistShapeShape run per point. Surfaces and curves
+ * of every face and edge in the compound are set up once; each projection
+ * then runs a Newton iteration on the underlying surface or curve, started
+ * from the point's previous result when the caller keeps a Hint for it.
+ * Results falling outside a face's trimming boundary go through
+ * BRepExtrema as before.
+ *
+ * project() may be called from several threads at once. Each call borrows
+ * one of a pool of per-thread evaluators (surface analysers and
+ * classifiers cache internally and cannot be shared).
+ */
+class ProjectionTarget {
+public:
+  /** @brief Last projection of one point: patch index and parameters. */
+  struct Hint {
+    int patch = -1; // face or edge index in the compound; -1 = none yet
+    double u = 0.0;
+    double v = 0.0; // unused on edges
+  };
+
+  explicit ProjectionTarget(const TopoDS_Shape &shape);
+  ~ProjectionTarget();
+
+  bool isNull() const { return _shape.IsNull(); }
+  const TopoDS_Shape &shape() const { return _shape; }
+
+  /**
+   * @brief Projects p, warm-started from and updating hint.
+   *
+   * Concurrent calls must use distinct hints.
+   */
+  gp_Pnt project(const gp_Pnt &p, Hint &hint) const;
+
+  /** @brief Projects p from scratch. */
+  gp_Pnt project(const gp_Pnt &p) const {
+    Hint hint;
+    return project(p, hint);
+  }
+
+  /**
+   * @brief True if the target is a single face, so points on it can be
+   * carried as (u, v) on its surface (see evaluate()).
+   */
+  bool isSingleFace() const { return !_surface.IsNull(); }
+
+  /**
+   * @brief Position and first derivatives of the single face's surface.
+   *
+   * On a periodic surface u and v are first shifted by whole periods to
+   * lie as close to the face as possible, so points crossing the seam
+   * keep moving smoothly; they are then clamped to the face's parameter
+   * bounds. Trimming inside those bounds is not checked. Thread-safe.
+   */
+  void evaluate(double &u, double &v, gp_Pnt &p, gp_Vec &du,
+                gp_Vec &dv) const;
+
+private:
+  class Evaluator;
+
+  Evaluator *acquire() const;
+  void release(Evaluator *evaluator) const;
+  gp_Pnt projectExact(const gp_Pnt &p) const;
+
+  TopoDS_Shape _shape;
+  std::vector<TopoDS_Shape> _patches; // faces, or edges if there are none
+  bool _onEdges = false;
+  Handle(Geom_Surface) _surface; // set if the target is one face
+  double _uMin = 0.0, _uMax = 0.0, _vMin = 0.0, _vMax = 0.0;
+  double _uPeriod = 0.0, _vPeriod = 0.0; // 0 if not periodic
+  double _tolerance = 1e-7;
+
+  mutable QMutex _poolMutex;
+  mutable std::vector<std::unique_ptr<Evaluator>> _pool;
+  mutable std::vector<Evaluator *> _idle;
+};
+
+#endif // PROJECTIONTARGET_H
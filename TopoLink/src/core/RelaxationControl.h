@@ -0,0 +1,70 @@
+#ifndef RELAXATIONCONTROL_H
+#define RELAXATIONCONTROL_H
+
+#include <cmath>
+
+/**
+ * @brief Over-relaxation factor for SOR sweeps with a divergence back-off.
+ *
+ * Projection onto curved geometry makes the iteration nonlinear, so a
+ * factor that is optimal for the plain Laplacian can make it diverge. SOR
+ * displacements are not monotone even when it converges, so only growth
+ * to kDivergenceRatio times the smallest displacement seen so far counts
+ * as divergence. The over-relaxation part (omega - 1) is then halved, down
+ * to plain Gauss-Seidel.
+ */
+class RelaxationControl {
+public:
+  static constexpr double kDivergenceRatio = 4.0;
+
+  /**
+   * @brief Optimal SOR factor for a given Jacobi spectral radius (Young):
+   * 2 / (1 + sqrt(1 - rho^2)).
+   */
+  static double optimalOmega(double rhoJacobi) {
+    if (!(rhoJacobi > 0.0))
+      return 1.0;
+    if (rhoJacobi >= 1.0)
+      rhoJacobi = 1.0 - 1e-12;
+    return 2.0 / (1.0 + std::sqrt(1.0 - rhoJacobi * rhoJacobi));
+  }
+
+  /**
+   * @brief Jacobi spectral radius implied by the displacement decay rate of
+   * SOR at factor omega (Hageman and Young). Only meaningful below the
+   * optimal factor, where the rate is above omega - 1.
+   */
+  static double jacobiRadius(double sorRate, double omega) {
+    return (sorRate + omega - 1.0) / (omega * std::sqrt(sorRate));
+  }
+
+  explicit RelaxationControl(double omega) : _omega(omega) {}
+
+  double omega() const { return _omega; }
+
+  /**
+   * @brief Records the maximum displacement of the latest sweep.
+   * @return True if omega was reduced
+   */
+  bool update(double maxDist) {
+    if (maxDist < _best) {
+      _best = maxDist;
+      return false;
+    }
+    // NaN fails the comparison above and counts as divergence
+    if (maxDist <= kDivergenceRatio * _best || _omega <= 1.0)
+      return false;
+
+    _best = maxDist;
+    _omega = 1.0 + 0.5 * (_omega - 1.0);
+    if (_omega < 1.01)
+      _omega = 1.0;
+    return true;
+  }
+
+private:
+  double _omega;
+  double _best = HUGE_VAL;
+};
+
+#endif // RELAXATIONCONTROL_H
@@ -0,0 +1,170 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include "FlatHashMap.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Non-owning storage of entity pointers keyed by integer ID, with
+ * generational handles and contiguous iteration.
+ *
+ * Entries live in one dense array of (ID, pointer) pairs; erasing moves the
+ * last entry into the hole, so iteration order is not ID order. A handle
+ * names a slot plus the slot's generation, stays valid while its entry
+ * lives, and reads as null once the entry is erased, even if the slot is
+ * reused. IDs reach their slot through a table indexed by ID, which suits
+ * the small non-negative IDs from Topology::generateID(). Negative IDs, and
+ * IDs far beyond the number of entries (e.g. read from a file), go through
+ * a hash map instead, so they cannot make the table ID-sized.
+ */
+template <typename T> class SlotMap {
+public:
+  // Not called Handle, which OCCT defines as a macro
+  struct SlotHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isNull() const { return slot == UINT32_MAX; }
+    bool operator==(const SlotHandle &o) const {
+      return slot == o.slot && generation == o.generation;
+    }
+    bool operator!=(const SlotHandle &o) const { return !(*this == o); }
+  };
+
+  using value_type = std::pair<int, T *>;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  /** @brief Adds value under id; an entry already under id is replaced. */
+  SlotHandle insert(int id, T *value) {
+    uint32_t s = slotOf(id);
+    if (s != UINT32_MAX) {
+      _dense[_slots[s].dense].second = value;
+      return SlotHandle{s, _slots[s].generation};
+    }
+
+    if (_freeSlots.empty()) {
+      s = (uint32_t)_slots.size();
+      _slots.push_back(Slot());
+    } else {
+      s = _freeSlots.back();
+      _freeSlots.pop_back();
+    }
+    _slots[s].dense = (uint32_t)_dense.size();
+    _dense.emplace_back(id, value);
+    _denseToSlot.push_back(s);
+    setSlot(id, s);
+    return SlotHandle{s, _slots[s].generation};
+  }
+
+  /** @return False if there was no entry under id */
+  bool erase(int id) {
+    uint32_t s = slotOf(id);
+    if (s == UINT32_MAX)
+      return false;
+    uint32_t d = _slots[s].dense;
+    uint32_t last = (uint32_t)_dense.size() - 1;
+    if (d != last) {
+      _dense[d] = _dense[last];
+      _denseToSlot[d] = _denseToSlot[last];
+      _slots[_denseToSlot[d]].dense = d;
+    }
+    _dense.pop_back();
+    _denseToSlot.pop_back();
+    _slots[s].generation++; // Outstanding handles go stale
+    _freeSlots.push_back(s);
+    if (inTable(id) && _idToSlot[id] == s)
+      _idToSlot[id] = UINT32_MAX;
+    else
+      _sparseIds.erase(sparseKey(id));
+    return true;
+  }
+
+  void clear() {
+    for (uint32_t s : _denseToSlot) {
+      _slots[s].generation++;
+      _freeSlots.push_back(s);
+    }
+    _dense.clear();
+    _denseToSlot.clear();
+    _idToSlot.clear();
+    _sparseIds.clear();
+  }
+
+  /** @brief Entry under id, or null. */
+  T *find(int id) const {
+    uint32_t s = slotOf(id);
+    return s == UINT32_MAX ? nullptr : _dense[_slots[s].dense].second;
+  }
+
+  /** @brief Entry named by h, or null if it was erased since. */
+  T *get(SlotHandle h) const {
+    if (h.slot >= _slots.size() || _slots[h.slot].generation != h.generation)
+      return nullptr;
+    return _dense[_slots[h.slot].dense].second;
+  }
+
+  /** @brief Handle of the entry under id; null if there is none. */
+  SlotHandle handle(int id) const {
+    uint32_t s = slotOf(id);
+    return s == UINT32_MAX ? SlotHandle() : SlotHandle{s, _slots[s].generation};
+  }
+
+  size_t count(int id) const { return slotOf(id) == UINT32_MAX ? 0 : 1; }
+  size_t size() const { return _dense.size(); }
+  bool empty() const { return _dense.empty(); }
+
+  const_iterator begin() const { return _dense.begin(); }
+  const_iterator end() const { return _dense.end(); }
+
+private:
+  struct Slot {
+    uint32_t dense = 0;      // Position in _dense while occupied
+    uint32_t generation = 0; // Bumped whenever the entry is erased
+  };
+
+  // Smallest table size that always goes into the table
+  static constexpr size_t kMinTable = 1024;
+
+  static uint64_t sparseKey(int id) { return (uint32_t)id; }
+
+  bool inTable(int id) const {
+    return id >= 0 && (size_t)id < _idToSlot.size();
+  }
+
+  // An ID lives either in the table or in _sparseIds, never both
+  uint32_t slotOf(int id) const {
+    if (inTable(id) && _idToSlot[id] != UINT32_MAX)
+      return _idToSlot[id];
+    if (_sparseIds.empty())
+      return UINT32_MAX;
+    const uint32_t *s = _sparseIds.find(sparseKey(id));
+    return s ? *s : UINT32_MAX;
+  }
+
+  // Grows the table up to a few times the entry count; IDs beyond go to
+  // the hash map
+  void setSlot(int id, uint32_t s) {
+    size_t limit = std::max(kMinTable, 4 * _dense.size());
+    if (id >= 0 && (size_t)id >= _idToSlot.size() && (size_t)id < limit)
+      _idToSlot.resize(
+          std::min(limit, std::max<size_t>(id + 1, _idToSlot.size() * 2)),
+          UINT32_MAX);
+    if (inTable(id))
+      _idToSlot[id] = s;
+    else
+      _sparseIds.insert_or_assign(sparseKey(id), s);
+  }
+
+  std::vector<value_type> _dense;
+  std::vector<uint32_t> _denseToSlot;
+  std::vector<Slot> _slots;
+  std::vector<uint32_t> _freeSlots;
+  std::vector<uint32_t> _idToSlot; // UINT32_MAX where no entry
+  FlatHashMap<uint32_t> _sparseIds; // IDs outside _idToSlot
+};
+
+#endif // SLOTMAP_H
@@ -1,17 +1,20 @@
 #include "Smoother.h"
+#include "ConstraintCache.h"
 #include "EllipticSolver.h"
 #include "GraphSolver.h"
+#include "ProjectionSchedule.h"
+#include "RelaxationControl.h"
+#include "SparseSolver.h"
+#include "TaskGraph.h"
 #include "TopoEdge.h"
 #include "TopoFace.h"
 #include "TopoHalfEdge.h"
 #include "TopoNode.h"
 #include "Topology.h"
+#include "WarmStart.h"
 #include <algorithm>
 
 // OCCT Includes
-#include <BRepBuilderAPI_MakeVertex.hxx>
-#include <BRepExtrema_DistShapeShape.hxx>
-#include <BRep_Builder.hxx>
 #include <QDebug>
 #include <QFile>
 #include <QList>
@@ -19,27 +22,114 @@
 #include <QMutexLocker>
 #include <QSet>
 #include <QTextStream>
-#include <QtConcurrent>
-#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopoDS.hxx>
-#include <TopoDS_Compound.hxx>
 #include <TopoDS_Shape.hxx>
 #include <gp_XYZ.hxx>
 
+namespace {
+
+// Half-edges around a face, starting at its boundary half-edge
+std::vector<TopoHalfEdge *> boundaryLoop(TopoFace *face) {
+  std::vector<TopoHalfEdge *> loop;
+  TopoHalfEdge *startHe = face->getBoundary();
+  if (!startHe)
+    return loop;
+  TopoHalfEdge *current = startHe;
+  int safety = 0;
+  do {
+    loop.push_back(current);
+    current = current->next;
+    safety++;
+  } while (current != startHe && current != nullptr && safety < 100);
+  return loop;
+}
+
+// Stop of solves started from interpolation, as before warm starts existed
+constexpr double kColdStepTolerance = 1e-9;
+
+// Bounding box diagonal, the size warm-start tolerances are relative to
+double extent(const std::vector<gp_Pnt> &points) {
+  if (points.empty())
+    return 0.0;
+  gp_XYZ lo = points[0].XYZ(), hi = points[0].XYZ();
+  for (const gp_Pnt &p : points) {
+    lo.SetCoord(std::min(lo.X(), p.X()), std::min(lo.Y(), p.Y()),
+                std::min(lo.Z(), p.Z()));
+    hi.SetCoord(std::max(hi.X(), p.X()), std::max(hi.Y(), p.Y()),
+                std::max(hi.Z(), p.Z()));
+  }
+  return (hi - lo).Modulus();
+}
+
+// True if id is in one map but not the other, or maps to different values
+template <typename Map> bool differs(const Map &a, const Map &b, int id) {
+  auto ia = a.find(id);
+  auto ib = b.find(id);
+  if ((ia == a.end()) != (ib == b.end()))
+    return true;
+  return ia != a.end() && ia->second != ib->second;
+}
+
+// Hash of a graph's connectivity and fixed nodes, the parts its colouring
+// and sparse setup depend on. Positions do not enter it.
+uint64_t graphKey(const GraphSolver::Graph &graph) {
+  uint64_t h = 0x9e3779b97f4a7c15ull;
+  auto mix = [&h](uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+  };
+  mix(graph.offsets.size());
+  for (int v : graph.offsets)
+    mix((uint32_t)v);
+  mix(graph.neighbors.size());
+  for (int v : graph.neighbors)
+    mix((uint32_t)v);
+  for (uint8_t v : graph.fixed)
+    mix(v);
+  return h;
+}
+
+} // namespace
+
 Smoother::Smoother(Topology *topology)
     : QObject(nullptr), m_topology(topology) {}
 
 Smoother::~Smoother() {}
 
-void Smoother::setConfig(const SmootherConfig &config) { m_config = config; }
+void Smoother::setConfig(const SmootherConfig &config) {
+  if (!config.solvesLike(m_config))
+    m_resultsValid = false;
+  m_config = config;
+}
 
 void Smoother::setConstraints(const QMap<int, Constraint> &constraints) {
   m_constraints = constraints;
 }
 
 void Smoother::setGeometryMaps(const void *faceMap, const void *edgeMap) {
-  m_geoFaceMap = faceMap;
-  m_geoEdgeMap = edgeMap;
+  // Same maps: keep the cached constraints, see invalidate()
+  if (faceMap == m_faceMap && edgeMap == m_edgeMap)
+    return;
+  m_faceMap = faceMap;
+  m_edgeMap = edgeMap;
+  m_constraintCache.setGeometryMaps(faceMap, edgeMap);
+  m_resultsValid = false;
+}
+
+void Smoother::invalidate() {
+  m_constraintCache.clear();
+  m_resultsValid = false;
+}
+
+void Smoother::cancel() { m_cancel.cancel(); }
+
+void Smoother::resetCancel() { m_cancel.reset(); }
+
+void Smoother::setStartingPoint(const QMap<int, SmoothedEdge> &edges,
+                                const QMap<int, SmoothedFace> &faces) {
+  m_startEdges = edges;
+  m_startFaces = faces;
 }
 
 const QMap<int, Smoother::SmoothedEdge> &Smoother::getSmoothedEdges() const {
@@ -50,42 +140,301 @@ const QMap<int, Smoother::SmoothedFace> &Smoother::getSmoothedFaces() const {
   return m_smoothedFaces;
 }
 
+const std::map<int, double> &Smoother::getRelaxationFactors() const {
+  return m_relaxationFactors;
+}
+
+ConstraintCache::Stats Smoother::getConstraintCacheStats() const {
+  return m_constraintCache.stats();
+}
+
 void Smoother::run() {
   if (!m_topology)
     return;
+  m_cancel.setTimeBudget(m_config.timeBudget);
+
+  // Copies share the data until the results are written
+  if (m_config.warmStart && m_startEdges.isEmpty() && m_startFaces.isEmpty()) {
+    m_startEdges = m_smoothedEdges;
+    m_startFaces = m_smoothedFaces;
+  }
 
-  m_convergenceHistory.clear();
+  RunInputs inputs = collectInputs();
+  const bool incremental = m_config.incremental && m_resultsValid;
+  std::set<int> changedEdges, changedFaces;
+  if (incremental) {
+    // Keep everything the edits since the last run did not touch
+    dropRemoved();
+    findChanged(inputs, changedEdges, changedFaces);
+  } else {
+    m_convergenceHistory.clear();
+    m_relaxationFactors.clear();
+    // Constraints are rebuilt once per full run and shared by all workers
+    m_constraintCache.clear();
+    m_smoothedEdges.clear();
+    m_smoothedFaces.clear();
+    m_unfinished.clear();
+  }
+  // Resolve every face group's constraint once; workers only read these
+  m_faceGroupTargets.clear();
+  for (const auto &[groupId, group] : m_topology->getFaceGroups()) {
+    if (group && !group->geometryIds.empty())
+      m_faceGroupTargets[groupId] =
+          m_constraintCache.find(group->geometryIds, false);
+  }
+
+  auto edgeChanged = [&](int id) {
+    return !incremental || changedEdges.count(id) > 0;
+  };
+  auto faceChanged = [&](int id) {
+    return !incremental || changedFaces.count(id) > 0;
+  };
+
+  // Every edge, face group and ungrouped face is one task. Faces wait only
+  // for their own boundary edges instead of for all edges, and independent
+  // groups overlap. Each solve counts as unfinished until its task is done.
+  auto finished = [this](int key) {
+    QMutexLocker locker(&m_mutex);
+    m_unfinished.erase(key);
+  };
+  TaskGraph tasks;
+  std::map<int, int> edgeTasks; // edge ID -> task
+  for (auto const &[id, edge] : m_topology->getEdges()) {
+    if (!edgeChanged(id))
+      continue;
+    TopoEdge *e = edge;
+    int edgeId = id;
+    double cost = std::max(e->getSubdivisions(), 1) * m_config.edgeIters;
+    m_unfinished.insert(-id);
+    edgeTasks[id] = tasks.addTask(
+        [this, edgeId, e, finished]() {
+          if (smoothSingleEdge(edgeId, e))
+            finished(-edgeId);
+        },
+        cost);
+  }
+
+  // Estimated cost of a face (grid points times sweeps)
+  auto faceCost = [&](const std::vector<TopoHalfEdge *> &loop) -> double {
+    if (loop.size() != 4)
+      return 1.0;
+    return (double)loop[0]->parentEdge->getSubdivisions() *
+           loop[1]->parentEdge->getSubdivisions() * m_config.faceIters;
+  };
+  // A face task waits for the tasks of the face's boundary edges
+  auto waitForEdges = [&](const std::vector<TopoHalfEdge *> &loop,
+                          int task) {
+    for (TopoHalfEdge *he : loop) {
+      if (!he->parentEdge)
+        continue;
+      auto it = edgeTasks.find(he->parentEdge->getID());
+      if (it != edgeTasks.end())
+        tasks.addDependency(it->second, task);
+    }
+  };
 
-  qDebug() << "Smoother: Starting edge smoothing...";
-  smoothEdges();
+  QSet<int> groupedFaces;
+  for (const auto &[groupId, groupPtr] : m_topology->getFaceGroups()) {
+    const TopoFaceGroup *group = groupPtr.get();
+    if (!group)
+      continue;
+    std::vector<std::vector<TopoHalfEdge *>> loops;
+    double cost = 0.0;
+    bool changed = false;
+    for (TopoFace *face : group->faces) {
+      groupedFaces.insert(face->getID());
+      loops.push_back(boundaryLoop(face));
+      cost += faceCost(loops.back());
+      changed = changed || faceChanged(face->getID());
+    }
+    if (!changed)
+      continue;
+    for (TopoFace *face : group->faces)
+      m_unfinished.insert(face->getID());
+    int task = tasks.addTask(
+        [this, group, finished]() {
+          if (smoothFaceGroup(group)) {
+            for (TopoFace *face : group->faces)
+              finished(face->getID());
+          }
+        },
+        cost);
+    for (const auto &loop : loops)
+      waitForEdges(loop, task);
+  }
 
-  qDebug() << "Smoother: Starting face smoothing...";
-  smoothFaces();
+  for (const auto &[id, face] : m_topology->getFaces()) {
+    if (groupedFaces.contains(id) || !faceChanged(id))
+      continue;
+    TopoFace *f = face;
+    int faceId = id;
+    std::vector<TopoHalfEdge *> loop = boundaryLoop(f);
+    m_unfinished.insert(id);
+    int task = tasks.addTask(
+        [this, faceId, f, finished]() {
+          if (smoothSingleFace(faceId, f))
+            finished(faceId);
+        },
+        faceCost(loop));
+    waitForEdges(loop, task);
+  }
 
+  qDebug() << "Smoother: Smoothing" << edgeTasks.size() << "of"
+           << m_topology->getEdges().size() << "edges and"
+           << tasks.size() - (int)edgeTasks.size() << "face tasks"
+           << (incremental ? "(incremental)..." : "...");
+  tasks.run();
+  m_startEdges.clear();
+  m_startFaces.clear();
+
+  if (m_cancel.isCancelled())
+    m_status = RunStatus::Cancelled;
+  else if (!m_unfinished.empty())
+    m_status = RunStatus::OutOfTime;
+  else
+    m_status = RunStatus::Finished;
+  if (m_status != RunStatus::Finished)
+    qDebug() << "Smoother: Stopped with" << m_unfinished.size()
+             << "solves unfinished";
+
+  m_lastInputs = std::move(inputs);
+  m_resultsValid = true;
+
+  ConstraintCache::Stats stats = m_constraintCache.stats();
+  qDebug() << "Smoother: Constraint cache" << stats.hits << "hits,"
+           << stats.misses << "misses";
   qDebug() << "Smoother: Process complete.";
 }
 
 // -----------------------------------------------------------------------------
-// Edge Smoothing
+// Change Tracking
 // -----------------------------------------------------------------------------
-void Smoother::smoothEdges() {
-  m_smoothedEdges.clear();
+Smoother::RunInputs Smoother::collectInputs() const {
+  RunInputs inputs;
+  inputs.revision = m_topology->getRevision();
+  inputs.constraints = m_constraints;
+
+  // First group wins, as in Topology::getGroupForEdge()
+  for (const auto &[groupId, group] : m_topology->getEdgeGroups()) {
+    for (TopoEdge *edge : group->edges) {
+      if (edge)
+        inputs.edgeGroup.emplace(edge->getID(), group->geometryID);
+    }
+  }
+  for (const auto &[groupId, group] : m_topology->getFaceGroups()) {
+    std::vector<int> members;
+    for (TopoFace *face : group->faces)
+      members.push_back(face->getID());
+    std::sort(members.begin(), members.end());
+    for (int id : members) {
+      inputs.faceGroup.emplace(id, members);
+      inputs.faceGroupGeometry.emplace(id, group->geometryID);
+    }
+  }
+  return inputs;
+}
 
-  const auto &edges = m_topology->getEdges();
-  QList<int> edgeIds;
-  for (auto const &[id, edge] : edges) {
-    edgeIds.append(id);
+void Smoother::findChanged(const RunInputs &inputs, std::set<int> &edges,
+                           std::set<int> &faces) const {
+  const RunInputs &last = m_lastInputs;
+
+  auto nodeChanged = [&](const TopoNode *node) {
+    int id = node->getID();
+    if (m_topology->getNodeRevision(id) > last.revision)
+      return true;
+    auto now = inputs.constraints.find(id);
+    auto before = last.constraints.find(id);
+    if ((now == inputs.constraints.end()) != (before == last.constraints.end()))
+      return true;
+    return now != inputs.constraints.end() && *now != *before;
+  };
+
+  // Faces that changed group or surface: their edges may fall back to
+  // another surface, and the boundaries of the groups involved moved
+  std::set<int> regrouped;
+  for (auto const &[id, face] : m_topology->getFaces()) {
+    if (differs(inputs.faceGroup, last.faceGroup, id) ||
+        differs(inputs.faceGroupGeometry, last.faceGroupGeometry, id))
+      regrouped.insert(id);
+  }
+
+  for (auto const &[id, edge] : m_topology->getEdges()) {
+    bool changed = m_topology->getEdgeRevision(id) > last.revision ||
+                   m_unfinished.count(-id) > 0 ||
+                   nodeChanged(edge->getStartNode()) ||
+                   nodeChanged(edge->getEndNode()) ||
+                   differs(inputs.edgeGroup, last.edgeGroup, id);
+
+    // Subdivisions can also change through a shared chord
+    auto result = m_smoothedEdges.constFind(id);
+    if (result == m_smoothedEdges.constEnd() ||
+        (int)result->points.size() != std::max(edge->getSubdivisions(), 1) + 1)
+      changed = true;
+
+    for (TopoHalfEdge *he :
+         {edge->getForwardHalfEdge(), edge->getBackwardHalfEdge()}) {
+      if (he && he->face && regrouped.count(he->face->getID()))
+        changed = true;
+    }
+    if (changed)
+      edges.insert(id);
   }
 
-  QtConcurrent::blockingMap(edgeIds, [this, &edges](int id) {
-    auto it = edges.find(id);
-    if (it != edges.end()) {
-      smoothSingleEdge(id, it->second);
+  // A face changes with any of its edges. Non-quads never get a result.
+  for (auto const &[id, face] : m_topology->getFaces()) {
+    std::vector<TopoHalfEdge *> loop = boundaryLoop(face);
+    bool changed = m_topology->getFaceRevision(id) > last.revision ||
+                   regrouped.count(id) > 0 || m_unfinished.count(id) > 0 ||
+                   (loop.size() == 4 && !m_smoothedFaces.contains(id));
+    for (TopoHalfEdge *he : loop) {
+      if (he->parentEdge && edges.count(he->parentEdge->getID()))
+        changed = true;
     }
-  });
+    if (changed)
+      faces.insert(id);
+  }
+
+  qDebug() << "Smoother:" << edges.size() << "edges and" << faces.size()
+           << "faces changed since the last run";
 }
 
-void Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
+void Smoother::dropRemoved() {
+  const auto &edges = m_topology->getEdges();
+  const auto &faces = m_topology->getFaces();
+  for (auto it = m_smoothedEdges.begin(); it != m_smoothedEdges.end();) {
+    if (edges.count(it.key()))
+      ++it;
+    else
+      it = m_smoothedEdges.erase(it);
+  }
+  for (auto it = m_smoothedFaces.begin(); it != m_smoothedFaces.end();) {
+    if (faces.count(it.key()))
+      ++it;
+    else
+      it = m_smoothedFaces.erase(it);
+  }
+
+  // Convergence keys: -edgeId for edges, face ID for faces
+  auto removed = [&](int key) {
+    return key < 0 ? edges.count(-key) == 0 : faces.count(key) == 0;
+  };
+  for (auto it = m_convergenceHistory.begin();
+       it != m_convergenceHistory.end();)
+    it = removed(it->first) ? m_convergenceHistory.erase(it) : std::next(it);
+  for (auto it = m_relaxationFactors.begin();
+       it != m_relaxationFactors.end();)
+    it = removed(it->first) ? m_relaxationFactors.erase(it) : std::next(it);
+  for (auto it = m_unfinished.begin(); it != m_unfinished.end();)
+    it = removed(*it) ? m_unfinished.erase(it) : std::next(it);
+}
+
+// -----------------------------------------------------------------------------
+// Edge Smoothing
+// -----------------------------------------------------------------------------
+bool Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
+  if (m_cancel.isCancelled())
+    return false;
+
   int subdivisions = edge->getSubdivisions();
   if (subdivisions < 1)
     subdivisions = 1;
@@ -100,7 +449,7 @@ void Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
   points[subdivisions] = nEnd->getPosition();
 
   // Check for Edge Constraints (Geometry Projection)
-  TopoDS_Shape edgeConstraint;
+  ConstraintCache::TargetPtr edgeConstraint; // Null if unconstrained
   {
     // Constraints map access should be safe as it's read-only after setup
     if (m_constraints.contains(nStart->getID()) &&
@@ -120,57 +469,63 @@ void Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
         }
 
         if (!commonIds.isEmpty()) {
-          edgeConstraint = buildTargetShape(commonIds, true);
+          edgeConstraint = m_constraintCache.find(commonIds, true);
         }
       }
     }
   }
 
-  // Initialize internal points linearly
+  // Initialize internal points linearly, or from an earlier result
   for (int i = 1; i < subdivisions; ++i) {
     double t = (double)i / subdivisions;
     gp_XYZ xyz = points[0].XYZ() * (1.0 - t) + points[subdivisions].XYZ() * t;
     points[i] = gp_Pnt(xyz);
   }
+  bool warmStarted = false;
+  auto start = m_startEdges.constFind(edgeId);
+  if (start != m_startEdges.constEnd()) {
+    std::vector<gp_Pnt> warm = WarmStart::resampleEdge(
+        start->points, points[0], points[subdivisions], subdivisions);
+    if (!warm.empty()) {
+      points = std::move(warm);
+      warmStarted = true;
+    }
+  }
 
-  if (!edgeConstraint.IsNull()) {
+  if (edgeConstraint) {
     qDebug() << "Smoother: Edge" << edgeId << "found explicit edge constraint.";
   } else {
     // Fallback: Check for Surface Constraint on connected faces
-    QList<int> faceGeoIds;
-    auto checkFace = [&](TopoHalfEdge *he) {
-      if (he && he->face) {
-        std::string gidStr = m_topology->getFaceGeometryID(he->face->getID());
-        qDebug() << "Smoother: Edge" << edgeId << "checking face"
-                 << he->face->getID()
-                 << "gidStr:" << QString::fromStdString(gidStr);
-        if (!gidStr.empty()) {
-          QStringList parts = QString::fromStdString(gidStr).split(",");
-          for (const QString &part : parts) {
-            bool ok;
-            int gid = part.toInt(&ok);
-            if (ok && !faceGeoIds.contains(gid))
-              faceGeoIds.append(gid);
-          }
-        }
+    const TopoFaceGroup *groups[2] = {nullptr, nullptr};
+    int count = 0;
+    for (TopoHalfEdge *he :
+         {edge->getForwardHalfEdge(), edge->getBackwardHalfEdge()}) {
+      if (!he || !he->face)
+        continue;
+      const TopoFaceGroup *group =
+          m_topology->getGroupForFace(he->face->getID());
+      if (group && !group->geometryIds.empty() &&
+          (count == 0 || groups[0] != group))
+        groups[count++] = group;
+    }
+
+    if (count > 0) {
+      if (count == 1) {
+        edgeConstraint = faceGroupTarget(groups[0]);
       } else {
-        qDebug() << "Smoother: Edge" << edgeId
-                 << "half-edge checking failed (he or face null)";
+        // Faces of two linked groups: the union of both surfaces
+        std::vector<int> ids = groups[0]->geometryIds;
+        ids.insert(ids.end(), groups[1]->geometryIds.begin(),
+                   groups[1]->geometryIds.end());
+        edgeConstraint = m_constraintCache.find(std::move(ids), false);
       }
-    };
-    checkFace(edge->getForwardHalfEdge());
-    checkFace(edge->getBackwardHalfEdge());
-
-    if (!faceGeoIds.isEmpty()) {
-      edgeConstraint = buildTargetShape(faceGeoIds, false);
-      if (edgeConstraint.IsNull()) {
+      if (!edgeConstraint) {
         qDebug() << "Smoother: Edge" << edgeId
-                 << "fallback to face constraint failed to build shape from ids"
-                 << faceGeoIds;
+                 << "fallback to face constraint failed to build shape from"
+                 << groups[0]->geometryID.c_str();
       } else {
         qDebug() << "Smoother: Edge" << edgeId
-                 << "found surface constraint from adjacent faces."
-                 << faceGeoIds;
+                 << "found surface constraint from adjacent faces.";
       }
     } else {
       qDebug() << "Smoother: Edge" << edgeId
@@ -184,19 +539,42 @@ void Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
     std::vector<double> convergence;
     convergence.reserve(m_config.edgeIters);
 
+    // Over-relaxation needs in-place (Gauss-Seidel) updates, so the auto
+    // mode reads the already updated left neighbour. The chain's Jacobi
+    // spectral radius is cos(pi / subdivisions).
+    const bool autoRelax = m_config.edgeAutoRelax;
+    std::vector<ProjectionTarget::Hint> hints(points.size());
+    RelaxationControl control(
+        autoRelax ? RelaxationControl::optimalOmega(
+                        std::cos(M_PI / std::max(subdivisions, 2)))
+                  : m_config.edgeRelax);
+
+    // Projection every few sweeps, adapted to the drift off the curve
+    ProjectionSchedule schedule(m_config.projFreq, m_config.subIters);
+    const bool scheduled = edgeConstraint && schedule.adaptive();
+    std::vector<gp_Pnt> lastProjected = points;
+    const double tolerance = stepTolerance(warmStarted, points);
+
     for (int it = 0; it < m_config.edgeIters; ++it) {
       std::vector<gp_Pnt> nextPoints = points;
       double maxDisp = 0.0;
+      double drift = 0.0;
+      const double omega = control.omega();
+      const bool project =
+          edgeConstraint &&
+          (!scheduled || schedule.projects(it, m_config.edgeIters));
 
       for (int i = 1; i < subdivisions; ++i) {
-        gp_XYZ target = (points[i - 1].XYZ() + points[i + 1].XYZ()) * 0.5;
-        gp_XYZ refined = points[i].XYZ() * (1.0 - m_config.edgeRelax) +
-                         target * m_config.edgeRelax;
+        const gp_Pnt &left = autoRelax ? nextPoints[i - 1] : points[i - 1];
+        gp_XYZ target = (left.XYZ() + points[i + 1].XYZ()) * 0.5;
+        gp_XYZ refined = points[i].XYZ() * (1.0 - omega) + target * omega;
 
         // If constraint exists, project. Otherwise keep refined point
         // (Laplacian)
-        if (!edgeConstraint.IsNull()) {
-          nextPoints[i] = projectToShape(gp_Pnt(refined), edgeConstraint);
+        if (project) {
+          nextPoints[i] = edgeConstraint->project(gp_Pnt(refined), hints[i]);
+          drift = std::max(drift,
+                           nextPoints[i].SquareDistance(gp_Pnt(refined)));
         } else {
           nextPoints[i] = gp_Pnt(refined);
         }
@@ -206,15 +584,34 @@ void Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
           maxDisp = distSq;
       }
       points = nextPoints;
-      double currentError = std::sqrt(maxDisp);
+      const double sweepError = std::sqrt(maxDisp);
+      double currentError = sweepError;
+      if (scheduled && project) {
+        double net = 0.0;
+        for (int i = 1; i < subdivisions; ++i) {
+          net = std::max(net, points[i].SquareDistance(lastProjected[i]));
+          lastProjected[i] = points[i];
+        }
+        currentError = std::sqrt(net);
+        schedule.projected(std::sqrt(drift), currentError);
+      } else if (scheduled) {
+        schedule.skipped();
+      }
       convergence.push_back(currentError);
-      emit iterationCompleted(-edgeId, it, currentError);
-      if (currentError < 1e-9)
+      m_telemetry.push({-edgeId, it, currentError});
+      if ((project || !scheduled) && currentError < tolerance)
+        break;
+      if ((project || !scheduled) && m_cancel.stopRequested())
         break;
+      if (autoRelax)
+        control.update(sweepError);
     }
 
+    if (m_cancel.isCancelled())
+      return false;
     QMutexLocker locker(&m_mutex);
     m_convergenceHistory[-edgeId] = convergence;
+    m_relaxationFactors[-edgeId] = control.omega();
   }
 
   SmoothedEdge se;
@@ -222,61 +619,38 @@ void Smoother::smoothSingleEdge(int edgeId, TopoEdge *edge) {
 
   QMutexLocker locker(&m_mutex);
   m_smoothedEdges.insert(edgeId, se);
+  return !m_cancel.stopRequested();
+}
+
+double Smoother::stepTolerance(bool warmStarted,
+                               const std::vector<gp_Pnt> &points) const {
+  if (!warmStarted)
+    return kColdStepTolerance;
+  return m_config.warmStepTolerance * extent(points);
 }
 
 // -----------------------------------------------------------------------------
 // Face Smoothing
 // -----------------------------------------------------------------------------
-void Smoother::smoothFaces() {
-  m_smoothedFaces.clear();
-  QSet<int> processedFaces;
-
-  qDebug() << "Smoother: Starting Group-Based Face Smoothing...";
-
-  // 1. Process Face Groups
-  const auto &faceGroups = m_topology->getFaceGroups();
-
-  for (const auto &[groupId, groupPtr] : faceGroups) {
-    if (groupPtr) {
-      smoothFaceGroup(groupPtr.get(), processedFaces);
-    }
-  }
-
-  // 2. Process Remaining (Ungrouped) Faces
-  // Iterate all faces, check if processed
-  QList<TopoFace *> remainingFaces;
-  for (const auto &[id, face] : m_topology->getFaces()) {
-    if (!processedFaces.contains(id)) {
-      remainingFaces.append(face);
-    }
-  }
-
-  QtConcurrent::blockingMap(remainingFaces, [this](TopoFace *face) {
-    smoothSingleFace(face->getID(), face);
-  });
+ConstraintCache::TargetPtr
+Smoother::faceGroupTarget(const TopoFaceGroup *group) const {
+  if (!group)
+    return nullptr;
+  auto it = m_faceGroupTargets.find(group->id);
+  return it != m_faceGroupTargets.end() ? it->second : nullptr;
 }
 
-void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
-                               QSet<int> &processedFaces) {
+bool Smoother::smoothFaceGroup(const TopoFaceGroup *group) {
   if (!group || group->faces.empty())
-    return;
+    return true;
+  if (m_cancel.isCancelled())
+    return false;
 
   qDebug() << "Smoother: Processing Face Group" << group->name.c_str() << "with"
            << group->faces.size() << "faces";
 
   // 1. Identify Group Constraint (Whole Surface)
-  TopoDS_Shape groupConstraint;
-  if (!group->geometryID.empty()) {
-    QList<int> ids;
-    QStringList parts = QString::fromStdString(group->geometryID).split(",");
-    for (const QString &part : parts) {
-      bool ok;
-      int gid = part.toInt(&ok);
-      if (ok)
-        ids.append(gid);
-    }
-    groupConstraint = buildTargetShape(ids, false);
-  }
+  ConstraintCache::TargetPtr groupConstraint = faceGroupTarget(group);
 
   // 2. Build Graph
   // We need to map (FaceID, i, j) -> GraphNodeIndex
@@ -311,7 +685,7 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       edgeToGraphIdx; // (EdgeID, subIdx) -> GraphIdx
   // Internal nodes: just append.
 
-  std::vector<GraphSolver::Node> graphNodes;
+  GraphSolver::Graph graph;
 
   // Helper to get/create index
   auto getGraphIndex =
@@ -363,21 +737,10 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
     std::vector<TopoHalfEdge *> loop;
   };
   QList<FaceData> faceDataList;
+  bool warmStarted = false; // Any face started from an earlier grid
 
   for (TopoFace *face : group->faces) {
-    processedFaces.insert(face->getID());
-
-    // Get loop
-    TopoHalfEdge *startHe = face->getBoundary();
-    std::vector<TopoHalfEdge *> loop;
-    TopoHalfEdge *current = startHe;
-    int safety = 0;
-    do {
-      loop.push_back(current);
-      current = current->next;
-      safety++;
-    } while (current != startHe && current != nullptr && safety < 100);
-
+    std::vector<TopoHalfEdge *> loop = boundaryLoop(face);
     if (loop.size() != 4)
       continue; // Skip non-quads
 
@@ -392,7 +755,7 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       TopoEdge *edge = loop[k]->parentEdge;
       std::vector<gp_Pnt> edgePoints;
       // Check smoothed edges first?
-      // Since we run smoothEdges() before, we have initial guesses.
+      // The group task waits for its edges, so we have initial guesses.
       {
         QMutexLocker locker(&m_mutex);
         if (m_smoothedEdges.contains(edge->getID())) {
@@ -448,21 +811,29 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       }
     }
 
+    // Or start from an earlier grid of the face
+    auto start = m_startFaces.constFind(face->getID());
+    StructuredGrid warm;
+    if (start != m_startFaces.constEnd() &&
+        WarmStart::resampleGrid(start->grid, boundaries, warm)) {
+      for (int i = 0; i <= M; ++i) {
+        for (int j = 0; j <= N; ++j)
+          grid[i][j] = warm.point(i, j);
+      }
+      warmStarted = true;
+    }
+
     faceDataList.append({face, M, N, grid, loop});
   }
 
   // 1. Create Nodes
   // Helper to add node if unique
   auto addNode = [&](gp_Pnt p, bool fixed) -> int {
-    GraphSolver::Node n;
-    n.pos = p;
     // If explicitly marked fixed by caller, always fixed.
     // If caller marked false (free), we might still fix it later based on
     // connectivity. But graph solver needs initial state. Let's assume passed
     // 'fixed' is the START state.
-    n.isFixed = fixed;
-    graphNodes.push_back(n);
-    return graphNodes.size() - 1;
+    return graph.addNode(p, fixed);
   };
 
   // TopoNodes (Corners)
@@ -530,8 +901,8 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       if (isEdgeFixed) {
         int startIdx = topoNodeToIdx[edge->getStartNode()->getID()];
         int endIdx = topoNodeToIdx[edge->getEndNode()->getID()];
-        graphNodes[startIdx].isFixed = true;
-        graphNodes[endIdx].isFixed = true;
+        graph.fixed[startIdx] = 1;
+        graph.fixed[endIdx] = 1;
         qDebug() << "Smoother: Node" << edge->getStartNode()->getID()
                  << "fixed by Edge" << eid;
         qDebug() << "Smoother: Node" << edge->getEndNode()->getID()
@@ -563,13 +934,6 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
     }
   }
 
-  // Debug final node states
-  for (auto const &[nid, idx] : topoNodeToIdx) {
-    qDebug() << "Smoother: Node" << nid
-             << "Final Fixed State:" << graphNodes[idx].isFixed
-             << "Neighbors:" << graphNodes[idx].neighbors.size();
-  }
-
   // Face Internals (Always Free)
   for (const auto &fd : faceDataList) {
     for (int i = 1; i < fd.M; ++i) {
@@ -581,6 +945,9 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
   }
 
   // 2. Build Connectivity (Neighbors)
+  // Every grid link of every face, once per face. Links shared between faces
+  // show up more than once; the graph drops the repeats.
+  std::vector<std::pair<int, int>> links;
   for (const auto &fd : faceDataList) {
     int fid = fd.face->getID();
 
@@ -637,77 +1004,139 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       return -1;
     };
 
-    // Add 4-Neighbors
+    // Links in +i and +j; the graph adds the reverse direction
     for (int i = 0; i <= fd.M; ++i) {
       for (int j = 0; j <= fd.N; ++j) {
         int curr = getNodeIdx(i, j);
         if (curr == -1)
           continue;
-
-        // We only add neighbors TO this node?
-        // GraphSolver expects bidirectional?
-        // We just need to ensure everyone has their neighbors listed.
-        // It's easier to iterate valid grid links and add to both.
-
         if (i < fd.M) {
-          int right = getNodeIdx(i + 1, j);
-          if (right != -1) {
-            // Avoid duplicates? std::vector iteration check is slow.
-            // But mesh is small.
-            // Better: only add if not present?
-            // Let's rely on logic.
-            // Since nodes are shared, we visit edges multiple times.
-            // Use a set or unique vector in GraphNode.
-          }
+          int neighbor = getNodeIdx(i + 1, j);
+          if (neighbor != -1)
+            links.emplace_back(curr, neighbor);
         }
-        // ... This is getting verbose to implement safely in replacement.
-        // Simpler: Just push_back. GraphSolver averages them all.
-        // Repeated neighbors simply weight that connection higher.
-        // Ideally we want 1 weight per link.
-
-        // Directions: +i, -i, +j, -j.
-        int n_i[4] = {i + 1, i - 1, i, i};
-        int n_j[4] = {j, j, j + 1, j - 1};
-
-        for (int d = 0; d < 4; ++d) {
-          int ni = n_i[d];
-          int nj = n_j[d];
-          if (ni >= 0 && ni <= fd.M && nj >= 0 && nj <= fd.N) {
-            int neighbor = getNodeIdx(ni, nj);
-            if (neighbor != -1) {
-              graphNodes[curr].neighbors.push_back(neighbor);
-            }
-          }
+        if (j < fd.N) {
+          int neighbor = getNodeIdx(i, j + 1);
+          if (neighbor != -1)
+            links.emplace_back(curr, neighbor);
         }
       }
     }
   }
+  graph.setLinks(links);
 
-  // Deduplicate neighbors (optional but good for perf/correctness)
-  for (auto &node : graphNodes) {
-    std::sort(node.neighbors.begin(), node.neighbors.end());
-    node.neighbors.erase(
-        std::unique(node.neighbors.begin(), node.neighbors.end()),
-        node.neighbors.end());
-    // Remove self-loops if any
-    node.neighbors.erase(std::remove(node.neighbors.begin(),
-                                     node.neighbors.end(),
-                                     (&node - &graphNodes[0])),
-                         node.neighbors.end());
+  // Debug final node states
+  for (auto const &[nid, idx] : topoNodeToIdx) {
+    qDebug() << "Smoother: Node" << nid
+             << "Final Fixed State:" << graph.isFixed(idx)
+             << "Neighbors:" << graph.degree(idx);
   }
 
+  // Renumber so the sweeps walk memory mostly in order. The index maps above
+  // keep the build-time numbering; look results up through newIndex.
+  std::vector<int> newIndex = GraphSolver::reorderRCM(graph);
+
   // 3. Solve
   GraphSolver::Params params;
   params.iterations = m_config.faceIters;
   params.relaxation = m_config.faceRelax;
+  params.autoRelaxation = m_config.faceAutoRelax;
+  params.projectionInterval = m_config.projFreq;
+  params.maxProjectionInterval = m_config.subIters;
+  params.cancel = &m_cancel;
+  {
+    std::vector<gp_Pnt> points(graph.size());
+    for (int i = 0; i < graph.size(); ++i)
+      points[i] = graph.point(i);
+    params.tolerance = stepTolerance(warmStarted, points);
+  }
+
+  using GroupMethod = SmootherConfig::GroupMethod;
+  const bool useSparse = m_config.groupMethod != GroupMethod::Relaxation;
+  SparseSolver::Preconditioner preconditioner =
+      SparseSolver::Preconditioner::Jacobi;
+  if (m_config.groupMethod == GroupMethod::PcgIC0)
+    preconditioner = SparseSolver::Preconditioner::IC0;
+  else if (m_config.groupMethod == GroupMethod::PcgAMG)
+    preconditioner = SparseSolver::Preconditioner::AMG;
+
+  // Setup reused from earlier runs unless the graph itself changed. Groups
+  // run concurrently, but each only touches its own entry and std::map
+  // insertions leave it in place, so it is safe to use after unlocking.
+  const GraphSolver::Colouring *colouring = nullptr;
+  SparseSolver *sparse = nullptr;
+  const uint64_t key = graphKey(graph);
+  GroupSetup *cached = nullptr;
+  {
+    QMutexLocker locker(&m_mutex);
+    cached = &m_groupSetups[group->id];
+  }
+  // The hash rejects most changed graphs cheaply; equal hashes are
+  // confirmed by comparing the arrays
+  if (cached->key != key || cached->offsets != graph.offsets ||
+      cached->neighbors != graph.neighbors || cached->fixed != graph.fixed) {
+    cached->key = key;
+    cached->offsets = graph.offsets;
+    cached->neighbors = graph.neighbors;
+    cached->fixed = graph.fixed;
+    cached->colouring = GraphSolver::Colouring();
+    cached->sparse.reset();
+  }
+  if (m_config.faceParallel && !useSparse) {
+    params.ordering = GraphSolver::Ordering::Coloured;
+    if (cached->colouring.numColours() == 0) {
+      cached->colouring = GraphSolver::colourGreedy(graph);
+      qDebug() << "Smoother: Coloured group" << group->id << "with"
+               << cached->colouring.numColours() << "colours";
+    }
+    colouring = &cached->colouring;
+  }
+  if (useSparse) {
+    if (!cached->sparse || cached->sparse->preconditioner() != preconditioner)
+      cached->sparse = std::make_unique<SparseSolver>(graph, preconditioner);
+    sparse = cached->sparse.get();
+  }
 
-  // Constraint Function
-  auto constraintFunc = [&](int idx, const gp_Pnt &p) -> gp_Pnt {
-    return projectToShape(p, groupConstraint);
+  // Constraint Function. Each node keeps its last surface parameters.
+  std::vector<ProjectionTarget::Hint> hints(graph.size());
+  std::function<gp_Pnt(int, const gp_Pnt &)> constraintFunc;
+  if (groupConstraint) {
+    constraintFunc = [&](int idx, const gp_Pnt &p) -> gp_Pnt {
+      return groupConstraint->project(p, hints[idx]);
+    };
+  }
+
+  // Progress is reported under the group's first face
+  const int progressId = group->faces.front()->getID();
+  auto progressFunc = [&](int it, double error) {
+    m_telemetry.push({progressId, it, error});
   };
 
-  auto convergence =
-      GraphSolver::smoothGraph(graphNodes, params, constraintFunc);
+  std::vector<double> convergence;
+  double relaxation = 0.0; // Only the sweeps have one
+  if (sparse) {
+    if (!groupConstraint) {
+      convergence = sparse->solve(graph, m_config.faceIters, 1e-10,
+                                  progressFunc, &m_cancel);
+    } else {
+      // projFreq CG steps between projections onto the group surface
+      convergence =
+          sparse->solveProjected(graph, m_config.faceIters,
+                                 std::max(1, m_config.projFreq),
+                                 constraintFunc, progressFunc,
+                                 params.tolerance, &m_cancel);
+    }
+  } else {
+    convergence = GraphSolver::smoothGraph(graph, params, constraintFunc,
+                                           progressFunc, colouring,
+                                           &relaxation);
+    if (params.autoRelaxation)
+      qDebug() << "Smoother: Group" << group->id << "relaxation"
+               << relaxation;
+  }
+
+  if (m_cancel.isCancelled())
+    return false;
 
   // 4. Write Back
   // Update m_smoothedEdges (for the shared/free edges)
@@ -728,39 +1157,14 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       m_smoothedEdges[eid].points[subs] =
           m_topology->getEdge(eid)->getEndNode()->getPosition();
     }
-    m_smoothedEdges[eid].points[ptIdx] = graphNodes[idx].pos;
+    m_smoothedEdges[eid].points[ptIdx] = graph.point(newIndex[idx]);
   }
 
   // Faces
   for (const auto &fd : faceDataList) {
     SmoothedFace sf;
-    sf.grid.resize(fd.M + 1, std::vector<gp_Pnt>(fd.N + 1));
-    sf.surface = groupConstraint;
-
-    for (int i = 0; i <= fd.M; ++i) {
-      for (int j = 0; j <= fd.N; ++j) {
-        // Re-resolve index
-        // Note: this repeats the lookup logic.
-        // Ideally we cached it in fd.gridIndices[i][j]
-        // ...
-        // Copied lookup logic for brevity:
-        int idx = -1;
-        if (i > 0 && i < fd.M && j > 0 && j < fd.N)
-          idx = faceInternalToIdx[{fd.face->getID(), i, j}];
-        else {
-          // Reuse the lambda logic essentially
-          // ...
-          // Actually, we can just read back?
-          // Let's assume re-running lookup is okay or copy helper.
-          // Helper is inside smoothFaceGroup.
-          // We can't access it here easily without copy paste.
-          // OK, let's just make the helper capture variables and reuse it.
-          // (The lambda `getNodeIdx` captures maps)
-        }
-        // WAIT, I can just use `getNodeIdx` from above if I structure code
-        // to keep it in scope. Yes.
-      }
-    }
+    sf.grid.resize(fd.M, fd.N);
+    sf.surface = groupConstraint ? groupConstraint->shape() : TopoDS_Shape();
 
     // Re-run population
     auto getNodeIdx = [&](int i, int j) -> int {
@@ -802,61 +1206,41 @@ void Smoother::smoothFaceGroup(const TopoFaceGroup *group,
       for (int j = 0; j <= fd.N; ++j) {
         int idx = getNodeIdx(i, j);
         if (idx != -1) {
-          sf.grid[i][j] = graphNodes[idx].pos;
+          sf.grid.setPoint(i, j, graph.point(newIndex[idx]));
         }
       }
     }
 
-    m_smoothedFaces[fd.face->getID()] = sf;
+    m_smoothedFaces[fd.face->getID()] = std::move(sf);
     m_convergenceHistory[fd.face->getID()] = convergence;
+    if (relaxation > 0.0)
+      m_relaxationFactors[fd.face->getID()] = relaxation;
   }
+  return !m_cancel.stopRequested();
 }
 
-void Smoother::smoothSingleFace(int faceId, TopoFace *face) {
+bool Smoother::smoothSingleFace(int faceId, TopoFace *face) {
   // 1. Get ordered boundary loop
-  TopoHalfEdge *startHe = face->getBoundary();
-  if (!startHe)
-    return;
-
-  std::vector<TopoHalfEdge *> loop;
-  TopoHalfEdge *current = startHe;
-  int safety = 0;
-  do {
-    loop.push_back(current);
-    current = current->next;
-    safety++;
-  } while (current != startHe && current != nullptr && safety < 100);
-
+  std::vector<TopoHalfEdge *> loop = boundaryLoop(face);
   if (loop.size() != 4) {
     // Only Quads supported for now
-    return;
+    return true;
   }
+  if (m_cancel.isCancelled())
+    return false;
 
   // 2. Identify Face/Surface Constraint
-  TopoDS_Shape surfaceConstraint;
+  ConstraintCache::TargetPtr surfaceConstraint; // Null if unconstrained
 
   // Check Topology Face Group
-  std::string gidStr = m_topology->getFaceGeometryID(face->getID());
-  if (!gidStr.empty()) {
-    QList<int> ids;
-    QStringList parts = QString::fromStdString(gidStr).split(",");
-    for (const QString &part : parts) {
-      bool ok;
-      int gid = part.toInt(&ok);
-      if (ok)
-        ids.append(gid);
-    }
-    if (!ids.isEmpty()) {
-      surfaceConstraint = buildTargetShape(ids, false);
-    }
-  }
+  surfaceConstraint = faceGroupTarget(m_topology->getGroupForFace(faceId));
 
   // Fallback: Check first node constraint
-  if (surfaceConstraint.IsNull() &&
+  if (!surfaceConstraint &&
       m_constraints.contains(loop[0]->origin->getID())) {
     const Constraint &nc0 = m_constraints[loop[0]->origin->getID()];
     if (nc0.type == ConstraintGeometry && !nc0.isEdgeGroup) {
-      surfaceConstraint = buildTargetShape(nc0.geometryIds, false);
+      surfaceConstraint = m_constraintCache.find(nc0.geometryIds, false);
     }
   }
 
@@ -903,9 +1287,17 @@ void Smoother::smoothSingleFace(int faceId, TopoFace *face) {
   int M = boundaries[0].size() - 1; // Bottom edge subdivisions
   int N = boundaries[1].size() - 1; // Right edge subdivisions
 
-  std::vector<std::vector<gp_Pnt>> grid(M + 1, std::vector<gp_Pnt>(N + 1));
-  std::vector<std::vector<bool>> isFixed(M + 1,
-                                         std::vector<bool>(N + 1, false));
+  StructuredGrid grid(M, N);
+
+  // Surface parameters of each point's last projection, for warm starts
+  std::vector<ProjectionTarget::Hint> hints((size_t)(M + 1) * (N + 1));
+
+  // An earlier grid of the face, fitted to the boundary, beats TFI
+  StructuredGrid warm;
+  auto start = m_startFaces.constFind(faceId);
+  const bool warmStarted =
+      start != m_startFaces.constEnd() &&
+      WarmStart::resampleGrid(start->grid, boundaries, warm);
 
   for (int i = 0; i <= M; ++i) {
     for (int j = 0; j <= N; ++j) {
@@ -927,13 +1319,13 @@ void Smoother::smoothSingleFace(int faceId, TopoFace *face) {
                     ((1.0 - u) * (1.0 - v) * cSW + u * (1.0 - v) * cSE +
                      u * v * cNE + (1.0 - u) * v * cNW);
 
-      grid[i][j] = gp_Pnt(pTFI);
-
+      gp_Pnt p = warmStarted ? warm.point(i, j) : gp_Pnt(pTFI);
       if (i == 0 || i == M || j == 0 || j == N) {
-        isFixed[i][j] = true;
-      } else if (!surfaceConstraint.IsNull()) {
-        grid[i][j] = projectToShape(grid[i][j], surfaceConstraint);
+        grid.setFixed(i, j, true);
+      } else if (surfaceConstraint) {
+        p = surfaceConstraint->project(p, hints[i * (N + 1) + j]);
       }
+      grid.setPoint(i, j, p);
     }
   }
 
@@ -941,34 +1333,89 @@ void Smoother::smoothSingleFace(int faceId, TopoFace *face) {
   EllipticSolver::Params params;
   params.iterations = m_config.faceIters;
   params.relaxation = m_config.faceRelax;
+  params.autoRelaxation = m_config.faceAutoRelax;
   params.bcRelaxation = m_config.faceBCRelax;
+  params.ordering = m_config.faceParallel
+                        ? EllipticSolver::Ordering::RedBlack
+                        : EllipticSolver::Ordering::Lexicographic;
+  params.method = m_config.faceMultigrid ? EllipticSolver::Method::Multigrid
+                                         : EllipticSolver::Method::SOR;
+  params.projectionInterval = m_config.projFreq;
+  params.maxProjectionInterval = m_config.subIters;
+  params.cancel = &m_cancel;
+  {
+    std::vector<gp_Pnt> outline;
+    for (const auto &side : boundaries)
+      outline.insert(outline.end(), side.begin(), side.end());
+    params.tolerance = stepTolerance(warmStarted, outline);
+  }
 
-  auto constraintFunc = [&](int i, int j, const gp_Pnt &p) -> gp_Pnt {
-    if (i == 0 || i == M || j == 0 || j == N)
-      return p;
-    return projectToShape(p, surfaceConstraint);
-  };
+  // Unconstrained faces leave the callback empty so the solver can take its
+  // direct path
+  EllipticSolver::ConstraintFunc constraintFunc;
+  if (surfaceConstraint) {
+    constraintFunc = [&](int i, int j, const gp_Pnt &p) -> gp_Pnt {
+      if (i == 0 || i == M || j == 0 || j == N)
+        return p;
+      return surfaceConstraint->project(p, hints[i * (N + 1) + j]);
+    };
+  }
 
   auto progressFunc = [&](int it, double error) {
-    emit iterationCompleted(faceId, it, error);
+    m_telemetry.push({faceId, it, error});
   };
 
-  std::vector<double> convergence = EllipticSolver::smoothGrid(
-      grid, isFixed, params, constraintFunc, progressFunc);
-
-  {
-    QMutexLocker locker(&m_mutex);
-    m_convergenceHistory[faceId] = convergence;
+  // Parametric mode carries the points as (u, v) on the constraint face,
+  // seeded by the initial projection. Constraints spanning several CAD
+  // faces, and points that landed outside the face, use projection.
+  bool parametric = m_config.faceParametric && surfaceConstraint &&
+                    surfaceConstraint->isSingleFace();
+  std::vector<double> uv;
+  if (parametric) {
+    uv.resize(2 * (size_t)grid.rows() * grid.stride());
+    for (int i = 1; i < M && parametric; ++i) {
+      for (int j = 1; j < N; ++j) {
+        const ProjectionTarget::Hint &hint = hints[i * (N + 1) + j];
+        if (hint.patch < 0) {
+          parametric = false;
+          break;
+        }
+        uv[2 * (size_t)grid.index(i, j)] = hint.u;
+        uv[2 * (size_t)grid.index(i, j) + 1] = hint.v;
+      }
+    }
   }
 
-  SmoothedFace sf;
-  sf.grid = grid;
-  sf.surface = surfaceConstraint;
+  double relaxation = 0.0;
+  std::vector<double> convergence;
+  if (parametric) {
+    const ProjectionTarget &target = *surfaceConstraint;
+    auto surface = [&target](double &u, double &v, gp_Pnt &p, gp_Vec &du,
+                             gp_Vec &dv) { target.evaluate(u, v, p, du, dv); };
+    convergence = EllipticSolver::smoothParametric(grid, uv, params, surface,
+                                                   progressFunc, &relaxation);
+  } else {
+    convergence = EllipticSolver::smoothGrid(grid, params, constraintFunc,
+                                             progressFunc, &relaxation);
+  }
+  if (params.autoRelaxation && relaxation > 0.0)
+    qDebug() << "Smoother: Face" << faceId << "relaxation" << relaxation;
+  if (m_cancel.isCancelled())
+    return false;
 
   {
     QMutexLocker locker(&m_mutex);
-    m_smoothedFaces.insert(faceId, sf);
+    m_convergenceHistory[faceId] = convergence;
+    if (relaxation > 0.0)
+      m_relaxationFactors[faceId] = relaxation;
   }
+
+  // Hand the solver buffer over to the result without copying it
+  QMutexLocker locker(&m_mutex);
+  SmoothedFace &sf = m_smoothedFaces[faceId];
+  sf.grid = std::move(grid);
+  sf.surface = surfaceConstraint ? surfaceConstraint->shape() : TopoDS_Shape();
+  return !m_cancel.stopRequested();
 }
 
 void Smoother::saveConvergenceData(const QString &filename) const {
@@ -1010,44 +1457,3 @@ void Smoother::saveConvergenceData(const QString &filename) const {
   file.close();
   qDebug() << "Convergence data saved to" << filename;
 }
-
-// -----------------------------------------------------------------------------
-// Helpers
-// -----------------------------------------------------------------------------
-TopoDS_Shape Smoother::buildTargetShape(const QList<int> &ids, bool isEdge) {
-  if (ids.isEmpty())
-    return TopoDS_Shape();
-  if (!m_geoFaceMap || !m_geoEdgeMap)
-    return TopoDS_Shape();
-
-  TopoDS_Compound comp;
-  BRep_Builder B;
-  B.MakeCompound(comp);
-  bool added = false;
-
-  const TopTools_IndexedMapOfShape *map =
-      static_cast<const TopTools_IndexedMapOfShape *>(isEdge ? m_geoEdgeMap
-                                                             : m_geoFaceMap);
-
-  for (int id : ids) {
-    if (id > 0 && id <= map->Extent()) {
-      B.Add(comp, map->FindKey(id));
-      added = true;
-    }
-  }
-  return added ? comp : TopoDS_Shape();
-}
-
-gp_Pnt Smoother::projectToShape(const gp_Pnt &p, const TopoDS_Shape &s) {
-  if (s.IsNull())
-    return p;
-  // Note: Projecting to a compound of edges or faces
-  // BRepExtrema works well generally.
-
-  BRepExtrema_DistShapeShape extrema(BRepBuilderAPI_MakeVertex(p).Vertex(), s);
-  if (extrema.IsDone() && extrema.NbSolution() > 0) {
-    // Solution 1 is closest
-    return extrema.PointOnShape2(1);
-  }
-  return p;
-}
@@ -5,10 +5,20 @@
 #include <QMap>
 #include <QSet>
 #include <QString>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
+#include "CancelToken.h"
+#include "ConstraintCache.h"
+#include "ConvergenceTelemetry.h"
+#include "GraphSolver.h"
 #include "SmootherConfig.h"
+#include "SparseSolver.h"
+#include "StructuredGrid.h"
 #include "Topology.h"
 #include <QPair>
 #include <TopoDS_Shape.hxx>
@@ -32,7 +42,7 @@ public:
   };
 
   struct SmoothedFace {
-    std::vector<std::vector<gp_Pnt>> grid;
+    StructuredGrid grid; // (M+1)x(N+1) solver buffer, moved in on completion
     TopoDS_Shape surface; // Underlying geometry (optional) for reference
   };
 
@@ -53,6 +63,19 @@ public:
     QList<int> geometryIds; // Target CAD face/edge IDs
     bool isEdgeGroup = false;
     gp_Pnt origin; // Original position (for Fixed constraints)
+
+    bool operator==(const Constraint &o) const {
+      return type == o.type && geometryIds == o.geometryIds &&
+             isEdgeGroup == o.isEdgeGroup &&
+             origin.SquareDistance(o.origin) == 0.0;
+    }
+    bool operator!=(const Constraint &o) const { return !(*this == o); }
+  };
+
+  enum class RunStatus {
+    Finished,  // Every solve ran to convergence or its iteration limit
+    Cancelled, // Stopped by cancel()
+    OutOfTime  // Stopped by SmootherConfig::timeBudget
   };
 
   Smoother(Topology *topology);
@@ -78,48 +101,153 @@ public:
 
   /**
    * @brief Runs the full smoothing process (edges then faces).
+   *
+   * With SmootherConfig::incremental set, and unless the settings or
+   * geometry changed since the last run, only edges and faces affected by
+   * topology edits since then are solved again; see Topology::getRevision().
+   * A cancel() made since the last resetCancel() stops it at once.
    */
   void run();
 
+  /**
+   * @brief Makes the next run solve everything, e.g. after the contents of
+   * the geometry maps changed.
+   */
+  void invalidate();
+
+  /**
+   * @brief Stops a running run(); safe to call from any thread.
+   *
+   * Solves stop after their current sweep and are discarded, and tasks not
+   * started yet are skipped. Results finished before are kept. Everything
+   * left unfinished is solved again by the next incremental run.
+   */
+  void cancel();
+
+  /**
+   * @brief Clears an earlier cancel(). Call when a run is scheduled, not
+   * from run() itself, so that a stop requested before the run starts
+   * still applies to it.
+   */
+  void resetCancel();
+
+  /** @brief How the last run() ended. */
+  RunStatus lastRunStatus() const { return m_status; }
+
+  /**
+   * @brief Results for the next run to start from instead of interpolating
+   * between the boundaries, resampled where subdivisions changed (see
+   * WarmStart). Used by one run only. With SmootherConfig::warmStart the
+   * previous run's results are used unless others were set.
+   */
+  void setStartingPoint(const QMap<int, SmoothedEdge> &edges,
+                        const QMap<int, SmoothedFace> &faces);
+
   void saveConvergenceData(const QString &filename) const;
 
-signals:
-  void iterationCompleted(int id, int iteration, double error);
+  const Topology *getTopology() const { return m_topology; }
+
+  /**
+   * @brief Error of every sweep of the running solves, for the GUI to poll
+   * instead of receiving an event per sweep. Samples may be dropped when
+   * nobody drains them; the full history is kept for
+   * saveConvergenceData().
+   */
+  ConvergenceTelemetry &telemetry() { return m_telemetry; }
 
-public:
   // Accessors for results
   const QMap<int, SmoothedEdge> &getSmoothedEdges() const;
   const QMap<int, SmoothedFace> &getSmoothedFaces() const;
 
+  /**
+   * @brief Relaxation factor each solve ended with, keyed like the
+   * convergence history (-edgeId for edges, face ID for faces). Faces solved
+   * directly, by multigrid or by the sparse group solver have no entry.
+   */
+  const std::map<int, double> &getRelaxationFactors() const;
+
+  /**
+   * @brief Lookups of constraint shapes in the last run: hits reused a
+   * compound built earlier in that run, misses built one.
+   */
+  ConstraintCache::Stats getConstraintCacheStats() const;
+
 private:
-  void smoothEdges();
-  void smoothFaces();
+  // What a run was computed from, compared by the next incremental run
+  struct RunInputs {
+    uint64_t revision = 0; // Topology::getRevision() at the start
+    QMap<int, Constraint> constraints;
+    std::map<int, std::string> edgeGroup;        // edge ID -> geometry ID
+    std::map<int, std::vector<int>> faceGroup;   // face ID -> sorted members
+    std::map<int, std::string> faceGroupGeometry; // face ID -> geometry ID
+  };
 
-  void smoothSingleEdge(int edgeId, TopoEdge *edge);
-  void smoothSingleFace(int faceId, TopoFace *face);
-  void smoothFaceGroup(const TopoFaceGroup *group,
-                       QSet<int> &processedFaces); // Added method
+  RunInputs collectInputs() const;
+  void findChanged(const RunInputs &inputs, std::set<int> &edges,
+                   std::set<int> &faces) const;
+  void dropRemoved();
 
-  // Helper to project point to shape
-  gp_Pnt projectToShape(const gp_Pnt &p, const TopoDS_Shape &s);
+  // Each returns false if it was stopped or skipped before finishing
+  bool smoothSingleEdge(int edgeId, TopoEdge *edge);
+  bool smoothSingleFace(int faceId, TopoFace *face);
+  bool smoothFaceGroup(const TopoFaceGroup *group);
 
-  // Helper to build a TopoDS_Shape from geometry IDs
-  TopoDS_Shape buildTargetShape(const QList<int> &ids, bool isEdge);
+  // Surface constraint of a face group, null if it has none
+  ConstraintCache::TargetPtr faceGroupTarget(const TopoFaceGroup *group) const;
+
+  // Largest sweep displacement at which a solve over points counts as
+  // converged (see SmootherConfig::warmStepTolerance)
+  double stepTolerance(bool warmStarted,
+                       const std::vector<gp_Pnt> &points) const;
 
   const Topology *m_topology = nullptr;
   SmootherConfig m_config;
   QMap<int, Constraint> m_constraints;
 
-  // Geometry Lookups (void* cast to TopTools_IndexedMapOfShape* internally)
-  const void *m_geoFaceMap = nullptr;
-  const void *m_geoEdgeMap = nullptr;
+  // Constraint shapes built from the geometry maps, emptied at the start
+  // of every full run
+  ConstraintCache m_constraintCache;
+  const void *m_faceMap = nullptr; // Not owned
+  const void *m_edgeMap = nullptr;
+  // Face group ID -> its constraint, looked up once at the start of a run
+  std::map<int, ConstraintCache::TargetPtr> m_faceGroupTargets;
+
+  // Inputs of the last run; the results are reusable while m_resultsValid
+  RunInputs m_lastInputs;
+  bool m_resultsValid = false;
+
+  // Stop request of the current run, and how the last one ended
+  CancelToken m_cancel;
+  RunStatus m_status = RunStatus::Finished;
+  // Solves that were stopped or skipped, keyed -edgeId for edges and face
+  // ID for faces; the next incremental run counts them as changed
+  std::set<int> m_unfinished;
 
   // Results
   QMap<int, SmoothedEdge> m_smoothedEdges;
   QMap<int, SmoothedFace> m_smoothedFaces;
 
+  // Starting points of the current run; read-only while it runs
+  QMap<int, SmoothedEdge> m_startEdges;
+  QMap<int, SmoothedFace> m_startFaces;
+
   // FaceID -> Vector of max displacement per iteration
   std::map<int, std::vector<double>> m_convergenceHistory;
+  ConvergenceTelemetry m_telemetry; // Live copy, see telemetry()
+  std::map<int, double> m_relaxationFactors; // Same keys
+
+  // Solver setup of a face group graph (colouring, sparse system and its
+  // preconditioner), kept across runs and rebuilt only when the group's
+  // connectivity or fixed nodes change. Both parts are built on first use.
+  struct GroupSetup {
+    uint64_t key = 0; // graphKey() of the graph below, a quick reject
+    std::vector<int> offsets; // graph the setup was computed for
+    std::vector<int> neighbors;
+    std::vector<uint8_t> fixed;
+    GraphSolver::Colouring colouring;
+    std::unique_ptr<SparseSolver> sparse;
+  };
+  std::map<int, GroupSetup> m_groupSetups; // face group ID -> cache
 
   mutable QMutex m_mutex;
 };
@@ -2,18 +2,57 @@
 #define SMOOTHERCONFIG_H
 
 struct SmootherConfig {
+  enum class GroupMethod {
+    Relaxation, // Gauss-Seidel sweeps over the group graph
+    PcgJacobi,  // Sparse CG, Jacobi preconditioner
+    PcgIC0,     // Sparse CG, incomplete Cholesky preconditioner
+    PcgAMG      // Sparse CG, algebraic multigrid preconditioner
+  };
+
   int edgeIters = 100;
   double edgeRelax = 0.9;
   double edgeBCRelax = 0.1;
+  bool edgeAutoRelax = false; // Near-optimal SOR factor instead of edgeRelax
 
   int faceIters = 1000;
   double faceRelax = 0.9;
   double faceBCRelax = 0.1;
+  bool faceAutoRelax = false; // Near-optimal SOR factor instead of faceRelax
+  bool faceParallel = false;  // Red-black grids / coloured groups, threaded
+  bool faceMultigrid = false; // Multigrid V-cycles instead of SOR sweeps
+  bool faceParametric = false; // SOR in surface (u, v) on single-face targets
+  GroupMethod groupMethod = GroupMethod::Relaxation;
 
   double singularityRelax = 1.0;
   double growthRateRelax = 1.0;
-  int subIters = 1;
-  int projFreq = 10;
+  int subIters = 1;  // Most sweeps per projection; 1 = every sweep
+  int projFreq = 10; // Initial sweeps (group PCG: steps) per projection
+
+  bool incremental = false; // Re-solve only what changed since the last run
+  bool warmStart = false;   // Start from the last results, not interpolation
+  // Displacement stop of warm-started solves: converged once a sweep moves
+  // no point further than this fraction of the size of the edge, face or
+  // group. Solves started from interpolation keep the absolute 1e-9.
+  double warmStepTolerance = 1e-6;
+  // Wall-clock limit of a run in seconds; 0 = none. Solves still running
+  // when it is spent stop and keep their current points.
+  double timeBudget = 0.0;
+
+  /** @brief True if both settings give the same results (modes aside). */
+  bool solvesLike(const SmootherConfig &o) const {
+    return edgeIters == o.edgeIters && edgeRelax == o.edgeRelax &&
+           edgeBCRelax == o.edgeBCRelax && edgeAutoRelax == o.edgeAutoRelax &&
+           faceIters == o.faceIters && faceRelax == o.faceRelax &&
+           faceBCRelax == o.faceBCRelax && faceAutoRelax == o.faceAutoRelax &&
+           faceParallel == o.faceParallel &&
+           faceMultigrid == o.faceMultigrid &&
+           faceParametric == o.faceParametric &&
+           groupMethod == o.groupMethod &&
+           singularityRelax == o.singularityRelax &&
+           growthRateRelax == o.growthRateRelax && subIters == o.subIters &&
+           projFreq == o.projFreq &&
+           warmStepTolerance == o.warmStepTolerance;
+  }
 };
 
 #endif // SMOOTHERCONFIG_H
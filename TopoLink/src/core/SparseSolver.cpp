@@ -0,0 +1,341 @@
+#include "SparseSolver.h"
+#include "CancelToken.h"
+#include <QtConcurrent>
+#include <cmath>
+
+namespace {
+
+// Vectors hold the three coordinates of each unknown interleaved
+constexpr int kRhs = AlgebraicMultigrid::kRhs;
+
+} // namespace
+
+SparseSolver::SparseSolver(const GraphSolver::Graph &graph,
+                           Preconditioner preconditioner)
+    : _preconditioner(preconditioner) {
+  const int n = graph.size();
+
+  // Free nodes with at least one neighbour become unknowns
+  std::vector<int> unknownOf(n, -1);
+  for (int i = 0; i < n; ++i) {
+    if (!graph.isFixed(i) && graph.degree(i) > 0) {
+      unknownOf[i] = (int)_nodeOf.size();
+      _nodeOf.push_back(i);
+    }
+  }
+
+  const int rows = numUnknowns();
+  _rowStart.assign(rows + 1, 0);
+  _fixedStart.assign(rows + 1, 0);
+  for (int r = 0; r < rows; ++r) {
+    int node = _nodeOf[r];
+    // Graph rows are sorted and unknowns keep node order, so the matrix
+    // columns come out sorted; the diagonal is slotted in place.
+    bool diagonalDone = false;
+    for (int k = graph.offsets[node]; k < graph.offsets[node + 1]; ++k) {
+      int nb = graph.neighbors[k];
+      if (graph.isFixed(nb) || unknownOf[nb] < 0) {
+        _fixedNodes.push_back(nb);
+        continue;
+      }
+      if (!diagonalDone && unknownOf[nb] > r) {
+        _cols.push_back(r);
+        _vals.push_back(graph.degree(node));
+        diagonalDone = true;
+      }
+      _cols.push_back(unknownOf[nb]);
+      _vals.push_back(-1.0);
+    }
+    if (!diagonalDone) {
+      _cols.push_back(r);
+      _vals.push_back(graph.degree(node));
+    }
+    _rowStart[r + 1] = (int)_cols.size();
+    _fixedStart[r + 1] = (int)_fixedNodes.size();
+  }
+
+  if (_preconditioner == Preconditioner::IC0) {
+    factorIC0();
+  } else if (_preconditioner == Preconditioner::AMG) {
+    AlgebraicMultigrid::Matrix A;
+    A.rows = A.cols = rows;
+    A.rowStart = _rowStart;
+    A.colIdx = _cols;
+    A.vals = _vals;
+    _amg = std::make_unique<AlgebraicMultigrid>(A);
+  } else {
+    _invDiag.resize(rows);
+    for (int r = 0; r < rows; ++r)
+      _invDiag[r] = 1.0 / graph.degree(_nodeOf[r]);
+  }
+}
+
+void SparseSolver::factorIC0() {
+  const int rows = numUnknowns();
+  _lStart.assign(rows + 1, 0);
+  _lCols.clear();
+  _lVals.clear();
+
+  for (int r = 0; r < rows; ++r) {
+    const int rowBegin = (int)_lCols.size();
+    double diag = 0.0;
+    for (int k = _rowStart[r]; k < _rowStart[r + 1]; ++k) {
+      int c = _cols[k];
+      if (c > r)
+        break;
+      if (c == r) {
+        diag = _vals[k];
+        break;
+      }
+
+      // L(r, c) = (A(r, c) - sum_j L(r, j) L(c, j)) / L(c, c), j < c
+      double sum = _vals[k];
+      int a = rowBegin;
+      int b = _lStart[c];
+      const int aEnd = (int)_lCols.size();
+      const int bEnd = _lStart[c + 1] - 1; // skip the diagonal
+      while (a < aEnd && b < bEnd) {
+        if (_lCols[a] == _lCols[b]) {
+          sum -= _lVals[a] * _lVals[b];
+          ++a;
+          ++b;
+        } else if (_lCols[a] < _lCols[b]) {
+          ++a;
+        } else {
+          ++b;
+        }
+      }
+      _lCols.push_back(c);
+      _lVals.push_back(sum / _lVals[_lStart[c + 1] - 1]);
+    }
+
+    double d = diag;
+    for (int k = rowBegin; k < (int)_lCols.size(); ++k)
+      d -= _lVals[k] * _lVals[k];
+    // Breakdown cannot happen for a diagonally dominant Laplacian, but fall
+    // back to the plain diagonal rather than take the root of a negative
+    _lCols.push_back(r);
+    _lVals.push_back(std::sqrt(d > 1e-12 * diag ? d : diag));
+    _lStart[r + 1] = (int)_lCols.size();
+  }
+}
+
+void SparseSolver::multiply(const std::vector<double> &v,
+                            std::vector<double> &out) const {
+  const int rows = numUnknowns();
+  for (int r = 0; r < rows; ++r) {
+    double acc[kRhs] = {0.0, 0.0, 0.0};
+    for (int k = _rowStart[r]; k < _rowStart[r + 1]; ++k) {
+      const double a = _vals[k];
+      const double *vc = &v[kRhs * _cols[k]];
+      acc[0] += a * vc[0];
+      acc[1] += a * vc[1];
+      acc[2] += a * vc[2];
+    }
+    out[kRhs * r] = acc[0];
+    out[kRhs * r + 1] = acc[1];
+    out[kRhs * r + 2] = acc[2];
+  }
+}
+
+void SparseSolver::precondition(const std::vector<double> &r,
+                                std::vector<double> &z) const {
+  const int rows = numUnknowns();
+  if (_preconditioner == Preconditioner::Jacobi) {
+    for (int i = 0; i < rows; ++i) {
+      for (int c = 0; c < kRhs; ++c)
+        z[kRhs * i + c] = r[kRhs * i + c] * _invDiag[i];
+    }
+    return;
+  }
+  if (_preconditioner == Preconditioner::AMG) {
+    _amg->apply(r, z);
+    return;
+  }
+
+  // Forward: L y = r
+  for (int i = 0; i < rows; ++i) {
+    double acc[kRhs] = {r[kRhs * i], r[kRhs * i + 1], r[kRhs * i + 2]};
+    const int diagPos = _lStart[i + 1] - 1;
+    for (int k = _lStart[i]; k < diagPos; ++k) {
+      const double l = _lVals[k];
+      const double *yc = &z[kRhs * _lCols[k]];
+      acc[0] -= l * yc[0];
+      acc[1] -= l * yc[1];
+      acc[2] -= l * yc[2];
+    }
+    for (int c = 0; c < kRhs; ++c)
+      z[kRhs * i + c] = acc[c] / _lVals[diagPos];
+  }
+
+  // Backward: L^T z = y, walking the rows of L as columns of L^T
+  for (int i = rows - 1; i >= 0; --i) {
+    const int diagPos = _lStart[i + 1] - 1;
+    for (int c = 0; c < kRhs; ++c)
+      z[kRhs * i + c] /= _lVals[diagPos];
+    for (int k = _lStart[i]; k < diagPos; ++k) {
+      const double l = _lVals[k];
+      double *zc = &z[kRhs * _lCols[k]];
+      zc[0] -= l * z[kRhs * i];
+      zc[1] -= l * z[kRhs * i + 1];
+      zc[2] -= l * z[kRhs * i + 2];
+    }
+  }
+}
+
+std::vector<double>
+SparseSolver::solve(GraphSolver::Graph &graph, int maxIterations,
+                    double tolerance,
+                    std::function<void(int, double)> progressFunc,
+                    const CancelToken *cancel) {
+  std::vector<double> history;
+  const int rows = numUnknowns();
+  if (rows == 0)
+    return history;
+
+  const size_t len = (size_t)kRhs * rows;
+  std::vector<double> x(len), b(len, 0.0), r(len), z(len), p(len), q(len);
+
+  for (int i = 0; i < rows; ++i) {
+    int node = _nodeOf[i];
+    x[kRhs * i] = graph.x[node];
+    x[kRhs * i + 1] = graph.y[node];
+    x[kRhs * i + 2] = graph.z[node];
+    for (int k = _fixedStart[i]; k < _fixedStart[i + 1]; ++k) {
+      int nb = _fixedNodes[k];
+      b[kRhs * i] += graph.x[nb];
+      b[kRhs * i + 1] += graph.y[nb];
+      b[kRhs * i + 2] += graph.z[nb];
+    }
+  }
+
+  // Per-coordinate reductions over the interleaved vectors
+  auto dot = [&](const std::vector<double> &u, const std::vector<double> &v,
+                 double out[kRhs]) {
+    out[0] = out[1] = out[2] = 0.0;
+    for (int i = 0; i < rows; ++i) {
+      for (int c = 0; c < kRhs; ++c)
+        out[c] += u[kRhs * i + c] * v[kRhs * i + c];
+    }
+  };
+
+  double bNorm[kRhs];
+  dot(b, b, bNorm);
+  for (int c = 0; c < kRhs; ++c)
+    bNorm[c] = bNorm[c] > 0.0 ? std::sqrt(bNorm[c]) : 1.0;
+
+  multiply(x, q);
+  for (size_t k = 0; k < len; ++k)
+    r[k] = b[k] - q[k];
+  precondition(r, z);
+  p = z;
+
+  double rz[kRhs], rr[kRhs];
+  dot(r, z, rz);
+  dot(r, r, rr);
+  bool done[kRhs];
+  for (int c = 0; c < kRhs; ++c)
+    done[c] = std::sqrt(rr[c]) <= tolerance * bNorm[c];
+
+  for (int it = 0; it < maxIterations; ++it) {
+    if (done[0] && done[1] && done[2])
+      break;
+    if (CancelToken::shouldStop(cancel))
+      break;
+
+    multiply(p, q);
+    double pq[kRhs];
+    dot(p, q, pq);
+    double alpha[kRhs];
+    for (int c = 0; c < kRhs; ++c)
+      alpha[c] = (done[c] || pq[c] <= 0.0) ? 0.0 : rz[c] / pq[c];
+
+    for (int i = 0; i < rows; ++i) {
+      for (int c = 0; c < kRhs; ++c) {
+        x[kRhs * i + c] += alpha[c] * p[kRhs * i + c];
+        r[kRhs * i + c] -= alpha[c] * q[kRhs * i + c];
+      }
+    }
+
+    dot(r, r, rr);
+    double worst = 0.0;
+    for (int c = 0; c < kRhs; ++c) {
+      double rel = std::sqrt(rr[c]) / bNorm[c];
+      if (rel <= tolerance || alpha[c] == 0.0)
+        done[c] = true;
+      if (rel > worst)
+        worst = rel;
+    }
+    history.push_back(worst);
+    if (progressFunc)
+      progressFunc(it, worst);
+
+    precondition(r, z);
+    double rzNew[kRhs];
+    dot(r, z, rzNew);
+    for (int c = 0; c < kRhs; ++c) {
+      double beta = (done[c] || rz[c] == 0.0) ? 0.0 : rzNew[c] / rz[c];
+      for (int i = 0; i < rows; ++i)
+        p[kRhs * i + c] = z[kRhs * i + c] + beta * p[kRhs * i + c];
+      rz[c] = rzNew[c];
+    }
+  }
+
+  for (int i = 0; i < rows; ++i) {
+    int node = _nodeOf[i];
+    graph.x[node] = x[kRhs * i];
+    graph.y[node] = x[kRhs * i + 1];
+    graph.z[node] = x[kRhs * i + 2];
+  }
+  return history;
+}
+
+std::vector<double> SparseSolver::solveProjected(
+    GraphSolver::Graph &graph, int outerIterations, int innerIterations,
+    std::function<gp_Pnt(int, const gp_Pnt &)> constraintFunc,
+    std::function<void(int, double)> progressFunc, double tolerance,
+    const CancelToken *cancel) {
+  std::vector<double> history;
+  const int rows = numUnknowns();
+  if (rows == 0)
+    return history;
+
+  std::vector<gp_Pnt> start(rows);
+  std::vector<double> distSq(rows);
+  std::vector<int> unknowns(rows);
+  for (int i = 0; i < rows; ++i)
+    unknowns[i] = i;
+
+  for (int it = 0; it < outerIterations; ++it) {
+    for (int i = 0; i < rows; ++i)
+      start[i] = graph.point(_nodeOf[i]);
+
+    solve(graph, innerIterations, 0.0);
+
+    // Each unknown writes only its own node, so the projections can run
+    // concurrently; the maximum is taken afterwards in a fixed order.
+    QtConcurrent::blockingMap(unknowns, [&](int i) {
+      int node = _nodeOf[i];
+      gp_Pnt p = graph.point(node);
+      if (constraintFunc)
+        p = constraintFunc(node, p);
+      graph.setPoint(node, p);
+      distSq[i] = start[i].SquareDistance(p);
+    });
+
+    double maxDisplacement = 0.0;
+    for (double d : distSq) {
+      if (d > maxDisplacement)
+        maxDisplacement = d;
+    }
+    double maxDist = std::sqrt(maxDisplacement);
+    history.push_back(maxDist);
+    if (progressFunc)
+      progressFunc(it, maxDist);
+    if (maxDist < tolerance) // Converged
+      break;
+    if (CancelToken::shouldStop(cancel))
+      break;
+  }
+  return history;
+}
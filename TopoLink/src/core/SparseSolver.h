@@ -0,0 +1,109 @@
+#ifndef SPARSESOLVER_H
+#define SPARSESOLVER_H
+
+#include "AlgebraicMultigrid.h"
+#include "GraphSolver.h"
+#include <functional>
+#include <gp_Pnt.hxx>
+#include <memory>
+#include <vector>
+
+class CancelToken;
+
+/**
+ * @brief Preconditioned conjugate gradient solve of the graph Laplacian.
+ *
+ * Assembles, once per graph, the system the relaxation sweeps in
+ * GraphSolver converge to: for every free node, degree * u minus the sum of
+ * its free neighbours equals the sum of its fixed neighbours. The matrix is
+ * symmetric positive definite whenever every free node is connected to a
+ * fixed one. The three coordinates are solved together as a multi-RHS
+ * system sharing every matrix and preconditioner pass.
+ */
+class SparseSolver {
+public:
+  enum class Preconditioner {
+    Jacobi, // Inverse diagonal
+    IC0,    // Incomplete Cholesky with the matrix's own sparsity
+    AMG     // One smoothed-aggregation V-cycle
+  };
+
+  /**
+   * @brief Assembles the free-node system of graph and factors the
+   * preconditioner. Only the adjacency and fixed flags are read, so the
+   * solver can be kept and reused while those stay the same.
+   */
+  SparseSolver(const GraphSolver::Graph &graph,
+               Preconditioner preconditioner);
+
+  /**
+   * @brief Runs PCG from the current free positions and writes them back.
+   *
+   * @param maxIterations Iteration cap
+   * @param tolerance Stop once every coordinate's residual norm is below
+   * tolerance times its right-hand side norm
+   * @param progressFunc Optional callback per iteration
+   * @param cancel Optional; polled every iteration, stopping writes back
+   * the current iterate
+   * @return Relative residual (largest over the coordinates) per iteration
+   */
+  std::vector<double>
+  solve(GraphSolver::Graph &graph, int maxIterations, double tolerance,
+        std::function<void(int, double)> progressFunc = nullptr,
+        const CancelToken *cancel = nullptr);
+
+  /**
+   * @brief Alternates short linear solves with projection of every free
+   * node.
+   *
+   * Each outer iteration runs innerIterations PCG steps from the last
+   * projected positions, then projects. The projection runs on worker
+   * threads and must be thread-safe.
+   *
+   * @param tolerance Stop once an outer iteration moves no node further
+   * @param cancel Optional; polled after every projection
+   * @return Maximum node displacement per outer iteration
+   */
+  std::vector<double>
+  solveProjected(GraphSolver::Graph &graph, int outerIterations,
+                 int innerIterations,
+                 std::function<gp_Pnt(int, const gp_Pnt &)> constraintFunc,
+                 std::function<void(int, double)> progressFunc = nullptr,
+                 double tolerance = 1e-9,
+                 const CancelToken *cancel = nullptr);
+
+  int numUnknowns() const { return (int)_nodeOf.size(); }
+  Preconditioner preconditioner() const { return _preconditioner; }
+  const AlgebraicMultigrid *multigrid() const { return _amg.get(); }
+
+private:
+  void multiply(const std::vector<double> &v, std::vector<double> &out) const;
+  void precondition(const std::vector<double> &r,
+                    std::vector<double> &z) const;
+  void factorIC0();
+
+  Preconditioner _preconditioner;
+
+  std::vector<int> _nodeOf; // unknown -> graph node
+
+  // System matrix (CSR, diagonal included, columns sorted)
+  std::vector<int> _rowStart;
+  std::vector<int> _cols;
+  std::vector<double> _vals;
+
+  // Fixed neighbours of each unknown (CSR into graph nodes), for the
+  // right-hand side
+  std::vector<int> _fixedStart;
+  std::vector<int> _fixedNodes;
+
+  std::vector<double> _invDiag; // Jacobi
+
+  // IC(0) factor L (CSR, lower triangle, diagonal last in each row)
+  std::vector<int> _lStart;
+  std::vector<int> _lCols;
+  std::vector<double> _lVals;
+
+  std::unique_ptr<AlgebraicMultigrid> _amg;
+};
+
+#endif // SPARSESOLVER_H
@@ -0,0 +1,388 @@
+#include "StencilKernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STENCIL_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define STENCIL_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+using Isa = StencilKernels::Isa;
+
+// Raw pointers for one grid row
+struct RowView {
+  double *x;
+  double *y;
+  double *z;
+  const uint64_t *fixed;
+  int start; // flat index of (i, 0)
+  int stride;
+};
+
+RowView rowView(StructuredGrid &grid, int i) {
+  RowView r;
+  r.x = grid.x();
+  r.y = grid.y();
+  r.z = grid.z();
+  r.fixed = grid.fixedBits();
+  r.start = grid.index(i, 0);
+  r.stride = grid.stride();
+  return r;
+}
+
+inline bool fixedAt(const uint64_t *fixed, int k) {
+  return (fixed[k >> 6] >> (k & 63)) & 1u;
+}
+
+// Blends point k towards its neighbour sum and returns the squared
+// displacement, in the same operation order as EllipticSolver.
+inline double blendScalar(const RowView &r, int k, double sx, double sy,
+                          double sz, double omega) {
+  const double keep = 1.0 - omega;
+  double nx = r.x[k] * keep + (sx / 4) * omega;
+  double ny = r.y[k] * keep + (sy / 4) * omega;
+  double nz = r.z[k] * keep + (sz / 4) * omega;
+  double dx = r.x[k] - nx;
+  double dy = r.y[k] - ny;
+  double dz = r.z[k] - nz;
+  r.x[k] = nx;
+  r.y[k] = ny;
+  r.z[k] = nz;
+  double distSq = dx * dx;
+  distSq += dy * dy;
+  distSq += dz * dz;
+  return distSq;
+}
+
+inline double relaxScalar(const RowView &r, int k, double omega) {
+  const int s = r.stride;
+  double sx = 0.0, sy = 0.0, sz = 0.0;
+  sx += r.x[k - s];
+  sy += r.y[k - s];
+  sz += r.z[k - s];
+  sx += r.x[k + s];
+  sy += r.y[k + s];
+  sz += r.z[k + s];
+  sx += r.x[k - 1];
+  sy += r.y[k - 1];
+  sz += r.z[k - 1];
+  sx += r.x[k + 1];
+  sy += r.y[k + 1];
+  sz += r.z[k + 1];
+  return blendScalar(r, k, sx, sy, sz, omega);
+}
+
+double redBlackScalar(const RowView &r, int i, int jBegin, int jEnd,
+                      int colour, double omega) {
+  double maxDist = 0.0;
+  for (int j = jBegin + ((i + jBegin + colour) & 1); j < jEnd; j += 2) {
+    int k = r.start + j;
+    if (fixedAt(r.fixed, k))
+      continue;
+    double distSq = relaxScalar(r, k, omega);
+    if (distSq > maxDist)
+      maxDist = distSq;
+  }
+  return maxDist;
+}
+
+void verticalSumScalar(const RowView &r, int jBegin, int jEnd, double *out) {
+  const int n = jEnd - jBegin;
+  const double *coords[3] = {r.x, r.y, r.z};
+  for (int c = 0; c < 3; ++c) {
+    const double *up = coords[c] + r.start + jBegin - r.stride;
+    const double *down = coords[c] + r.start + jBegin + r.stride;
+    for (int t = 0; t < n; ++t) {
+      double sum = 0.0;
+      sum += up[t];
+      sum += down[t];
+      out[c * n + t] = sum;
+    }
+  }
+}
+
+// Left-to-right recurrence on top of precomputed vertical sums
+double lexicographicRow(const RowView &r, int jBegin, int jEnd, double omega,
+                        const double *verticalSum) {
+  const int n = jEnd - jBegin;
+  double maxDist = 0.0;
+  for (int t = 0; t < n; ++t) {
+    int k = r.start + jBegin + t;
+    if (fixedAt(r.fixed, k))
+      continue;
+    double sx = verticalSum[t];
+    double sy = verticalSum[n + t];
+    double sz = verticalSum[2 * n + t];
+    sx += r.x[k - 1];
+    sy += r.y[k - 1];
+    sz += r.z[k - 1];
+    sx += r.x[k + 1];
+    sy += r.y[k + 1];
+    sz += r.z[k + 1];
+    double distSq = blendScalar(r, k, sx, sy, sz, omega);
+    if (distSq > maxDist)
+      maxDist = distSq;
+  }
+  return maxDist;
+}
+
+#ifdef STENCIL_HAVE_AVX2
+
+// Fixed flags of points k .. k + 3 in the low four bits
+inline unsigned fixedNibble(const uint64_t *fixed, int k) {
+  int word = k >> 6;
+  int bit = k & 63;
+  uint64_t v = fixed[word] >> bit;
+  if (bit > 60)
+    v |= fixed[word + 1] << (64 - bit);
+  return (unsigned)(v & 0xF);
+}
+
+__attribute__((target("avx2"))) double
+redBlackAvx2(const RowView &r, int i, int jBegin, int jEnd, int colour,
+             double omega) {
+  const int s = r.stride;
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d vOmega = _mm256_set1_pd(omega);
+  const __m256d vKeep = _mm256_set1_pd(1.0 - omega);
+  const __m256d vFour = _mm256_set1_pd(4.0);
+  const __m256i laneBits = _mm256_setr_epi64x(1, 2, 4, 8);
+  double *coords[3] = {r.x, r.y, r.z};
+  __m256d vMax = zero;
+
+  int j = jBegin;
+  for (; j + 4 <= jEnd; j += 4) {
+    const int k = r.start + j;
+    // Lane l is column j + l; the other colour and fixed points are only
+    // read, never stored, so rows of one colour can run concurrently.
+    unsigned colourLanes = ((i + j + colour) & 1) ? 0xA : 0x5;
+    unsigned lanes = colourLanes & ~fixedNibble(r.fixed, k);
+    if (lanes == 0)
+      continue;
+    __m256i mask = _mm256_cmpeq_epi64(
+        _mm256_and_si256(_mm256_set1_epi64x(lanes), laneBits), laneBits);
+
+    __m256d distSq = zero;
+    for (int c = 0; c < 3; ++c) {
+      double *p = coords[c] + k;
+      __m256d sum = _mm256_add_pd(zero, _mm256_loadu_pd(p - s));
+      sum = _mm256_add_pd(sum, _mm256_loadu_pd(p + s));
+      sum = _mm256_add_pd(sum, _mm256_loadu_pd(p - 1));
+      sum = _mm256_add_pd(sum, _mm256_loadu_pd(p + 1));
+      __m256d old = _mm256_loadu_pd(p);
+      __m256d next =
+          _mm256_add_pd(_mm256_mul_pd(old, vKeep),
+                        _mm256_mul_pd(_mm256_div_pd(sum, vFour), vOmega));
+      __m256d d = _mm256_sub_pd(old, next);
+      distSq = c == 0 ? _mm256_mul_pd(d, d)
+                      : _mm256_add_pd(distSq, _mm256_mul_pd(d, d));
+      _mm256_maskstore_pd(p, mask, next);
+    }
+    distSq = _mm256_and_pd(distSq, _mm256_castsi256_pd(mask));
+    vMax = _mm256_max_pd(distSq, vMax);
+  }
+
+  double laneMax[4];
+  _mm256_storeu_pd(laneMax, vMax);
+  double maxDist = 0.0;
+  for (double m : laneMax) {
+    if (m > maxDist)
+      maxDist = m;
+  }
+  double tail = redBlackScalar(r, i, j, jEnd, colour, omega);
+  return tail > maxDist ? tail : maxDist;
+}
+
+__attribute__((target("avx2"))) void
+verticalSumAvx2(const RowView &r, int jBegin, int jEnd, double *out) {
+  const int n = jEnd - jBegin;
+  const __m256d zero = _mm256_setzero_pd();
+  const double *coords[3] = {r.x, r.y, r.z};
+  for (int c = 0; c < 3; ++c) {
+    const double *up = coords[c] + r.start + jBegin - r.stride;
+    const double *down = coords[c] + r.start + jBegin + r.stride;
+    double *o = out + c * n;
+    int t = 0;
+    for (; t + 4 <= n; t += 4) {
+      __m256d sum = _mm256_add_pd(zero, _mm256_loadu_pd(up + t));
+      sum = _mm256_add_pd(sum, _mm256_loadu_pd(down + t));
+      _mm256_storeu_pd(o + t, sum);
+    }
+    for (; t < n; ++t) {
+      double sum = 0.0;
+      sum += up[t];
+      sum += down[t];
+      o[t] = sum;
+    }
+  }
+}
+
+#endif // STENCIL_HAVE_AVX2
+
+#ifdef STENCIL_HAVE_NEON
+
+double redBlackNeon(const RowView &r, int i, int jBegin, int jEnd, int colour,
+                    double omega) {
+  const int s = r.stride;
+  const float64x2_t zero = vdupq_n_f64(0.0);
+  const float64x2_t vOmega = vdupq_n_f64(omega);
+  const float64x2_t vKeep = vdupq_n_f64(1.0 - omega);
+  const float64x2_t vFour = vdupq_n_f64(4.0);
+  double *coords[3] = {r.x, r.y, r.z};
+  double maxDist = 0.0;
+
+  // De-interleaving loads put points j and j + 2 (one colour) in the two
+  // lanes; only those two are stored.
+  int j = jBegin + ((i + jBegin + colour) & 1);
+  for (; j + 3 <= jEnd; j += 4) {
+    const int k = r.start + j;
+    bool free0 = !fixedAt(r.fixed, k);
+    bool free1 = !fixedAt(r.fixed, k + 2);
+    if (!free0 && !free1)
+      continue;
+
+    float64x2_t distSq = zero;
+    for (int c = 0; c < 3; ++c) {
+      double *p = coords[c] + k;
+      float64x2x2_t centre = vld2q_f64(p);
+      float64x2_t sum = vaddq_f64(zero, vld2q_f64(p - s).val[0]);
+      sum = vaddq_f64(sum, vld2q_f64(p + s).val[0]);
+      sum = vaddq_f64(sum, vld2q_f64(p - 1).val[0]);
+      sum = vaddq_f64(sum, centre.val[1]);
+      float64x2_t old = centre.val[0];
+      float64x2_t next = vaddq_f64(vmulq_f64(old, vKeep),
+                                   vmulq_f64(vdivq_f64(sum, vFour), vOmega));
+      float64x2_t d = vsubq_f64(old, next);
+      distSq = c == 0 ? vmulq_f64(d, d) : vaddq_f64(distSq, vmulq_f64(d, d));
+      if (free0)
+        vst1q_lane_f64(p, next, 0);
+      if (free1)
+        vst1q_lane_f64(p + 2, next, 1);
+    }
+    double d0 = free0 ? vgetq_lane_f64(distSq, 0) : 0.0;
+    double d1 = free1 ? vgetq_lane_f64(distSq, 1) : 0.0;
+    if (d0 > maxDist)
+      maxDist = d0;
+    if (d1 > maxDist)
+      maxDist = d1;
+  }
+
+  double tail = redBlackScalar(r, i, j, jEnd, colour, omega);
+  return tail > maxDist ? tail : maxDist;
+}
+
+void verticalSumNeon(const RowView &r, int jBegin, int jEnd, double *out) {
+  const int n = jEnd - jBegin;
+  const float64x2_t zero = vdupq_n_f64(0.0);
+  const double *coords[3] = {r.x, r.y, r.z};
+  for (int c = 0; c < 3; ++c) {
+    const double *up = coords[c] + r.start + jBegin - r.stride;
+    const double *down = coords[c] + r.start + jBegin + r.stride;
+    double *o = out + c * n;
+    int t = 0;
+    for (; t + 2 <= n; t += 2) {
+      float64x2_t sum = vaddq_f64(zero, vld1q_f64(up + t));
+      sum = vaddq_f64(sum, vld1q_f64(down + t));
+      vst1q_f64(o + t, sum);
+    }
+    for (; t < n; ++t) {
+      double sum = 0.0;
+      sum += up[t];
+      sum += down[t];
+      o[t] = sum;
+    }
+  }
+}
+
+#endif // STENCIL_HAVE_NEON
+
+Isa detectIsa() {
+#ifdef STENCIL_HAVE_AVX2
+  if (__builtin_cpu_supports("avx2"))
+    return Isa::AVX2;
+#endif
+#ifdef STENCIL_HAVE_NEON
+  return Isa::NEON;
+#endif
+  return Isa::Scalar;
+}
+
+Isa &activeIsa() {
+  static Isa isa = detectIsa();
+  return isa;
+}
+
+} // namespace
+
+double StencilKernels::relaxRedBlack(StructuredGrid &grid, int i, int jBegin,
+                                     int jEnd, int colour, double omega) {
+  RowView r = rowView(grid, i);
+  switch (activeIsa()) {
+#ifdef STENCIL_HAVE_AVX2
+  case Isa::AVX2:
+    return redBlackAvx2(r, i, jBegin, jEnd, colour, omega);
+#endif
+#ifdef STENCIL_HAVE_NEON
+  case Isa::NEON:
+    return redBlackNeon(r, i, jBegin, jEnd, colour, omega);
+#endif
+  default:
+    return redBlackScalar(r, i, jBegin, jEnd, colour, omega);
+  }
+}
+
+double StencilKernels::relaxLexicographic(StructuredGrid &grid, int i,
+                                          int jBegin, int jEnd, double omega,
+                                          double *scratch) {
+  RowView r = rowView(grid, i);
+  switch (activeIsa()) {
+#ifdef STENCIL_HAVE_AVX2
+  case Isa::AVX2:
+    verticalSumAvx2(r, jBegin, jEnd, scratch);
+    break;
+#endif
+#ifdef STENCIL_HAVE_NEON
+  case Isa::NEON:
+    verticalSumNeon(r, jBegin, jEnd, scratch);
+    break;
+#endif
+  default:
+    verticalSumScalar(r, jBegin, jEnd, scratch);
+    break;
+  }
+  return lexicographicRow(r, jBegin, jEnd, omega, scratch);
+}
+
+StencilKernels::Isa StencilKernels::isa() { return activeIsa(); }
+
+bool StencilKernels::isSupported(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return true;
+  case Isa::AVX2:
+#ifdef STENCIL_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  case Isa::NEON:
+#ifdef STENCIL_HAVE_NEON
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+bool StencilKernels::setIsa(Isa isa) {
+  if (!isSupported(isa))
+    return false;
+  activeIsa() = isa;
+  return true;
+}
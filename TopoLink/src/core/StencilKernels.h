@@ -0,0 +1,54 @@
+#ifndef STENCILKERNELS_H
+#define STENCILKERNELS_H
+
+#include "StructuredGrid.h"
+
+/**
+ * @brief SIMD row kernels for the 5-point SOR update, before any
+ * projection.
+ *
+ * Each kernel updates the interior points j in [jBegin, jEnd) of interior
+ * row i (all four neighbours must exist) and returns the largest squared
+ * displacement. The arithmetic reproduces EllipticSolver's scalar update
+ * bit for bit: neighbours are summed up, down, left, right from zero and
+ * the result is blended as old * (1 - omega) + average * omega, so the
+ * build must not contract multiplies and adds into FMAs.
+ *
+ * The instruction set is chosen once at runtime: AVX2 on x86-64 CPUs that
+ * support it, NEON on AArch64, plain scalar code otherwise.
+ */
+class StencilKernels {
+public:
+  enum class Isa { Scalar, AVX2, NEON };
+
+  /**
+   * @brief Red-black update of the points with (i + j) % 2 == colour.
+   *
+   * Only points of that colour are written, so rows of the same colour may
+   * be processed concurrently.
+   */
+  static double relaxRedBlack(StructuredGrid &grid, int i, int jBegin,
+                              int jEnd, int colour, double omega);
+
+  /**
+   * @brief Gauss-Seidel update, left to right.
+   *
+   * The vertical neighbour sums are vectorised; the left-to-right
+   * recurrence stays scalar. scratch must hold 3 * (jEnd - jBegin) doubles.
+   */
+  static double relaxLexicographic(StructuredGrid &grid, int i, int jBegin,
+                                   int jEnd, double omega, double *scratch);
+
+  static Isa isa();
+  static bool isSupported(Isa isa);
+
+  /**
+   * @brief Overrides the detected instruction set (for tests and timing).
+   *
+   * Returns false and keeps the current one if isa is not supported. Not
+   * thread-safe; do not call while a solve is running.
+   */
+  static bool setIsa(Isa isa);
+};
+
+#endif // STENCILKERNELS_H
@@ -0,0 +1,143 @@
+#ifndef STRUCTUREDGRID_H
+#define STRUCTUREDGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <gp_Pnt.hxx>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Minimal allocator returning memory aligned to Align bytes.
+ */
+template <typename T, std::size_t Align> struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Align>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Align> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(Align)));
+  }
+  void deallocate(T *p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t(Align));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Align> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Align> &) const {
+    return false;
+  }
+};
+
+/**
+ * @brief Flat (M+1)x(N+1) structured grid in structure-of-arrays layout.
+ *
+ * Point (i, j) lives at index i * stride() + j in the separate x/y/z arrays.
+ * Each row is padded to a multiple of kRowAlign doubles so every row starts
+ * on a 32-byte boundary. The fixed mask is packed one bit per (padded) slot.
+ */
+class StructuredGrid {
+public:
+  static constexpr int kRowAlign = 4;
+  using Buffer = std::vector<double, AlignedAllocator<double, 32>>;
+
+  StructuredGrid() = default;
+  StructuredGrid(int M, int N) { resize(M, N); }
+
+  /**
+   * @brief Resizes to (M+1)x(N+1) points. All points are reset to the origin
+   * and all fixed flags are cleared.
+   */
+  void resize(int M, int N) {
+    _rows = M + 1;
+    _cols = N + 1;
+    _stride = (_cols + kRowAlign - 1) / kRowAlign * kRowAlign;
+    size_t n = (size_t)_rows * _stride;
+    _x.assign(n, 0.0);
+    _y.assign(n, 0.0);
+    _z.assign(n, 0.0);
+    _fixed.assign((n + 63) / 64, 0);
+  }
+
+  bool empty() const { return _rows == 0 || _cols == 0; }
+  int rows() const { return _rows; } // M + 1
+  int cols() const { return _cols; } // N + 1
+  int stride() const { return _stride; }
+  int index(int i, int j) const { return i * _stride + j; }
+
+  gp_Pnt point(int i, int j) const {
+    int k = index(i, j);
+    return gp_Pnt(_x[k], _y[k], _z[k]);
+  }
+  void setPoint(int i, int j, const gp_Pnt &p) {
+    int k = index(i, j);
+    _x[k] = p.X();
+    _y[k] = p.Y();
+    _z[k] = p.Z();
+  }
+
+  bool isFixed(int i, int j) const { return isFixedAt(index(i, j)); }
+  bool isFixedAt(int k) const { return (_fixed[k >> 6] >> (k & 63)) & 1u; }
+  void setFixed(int i, int j, bool fixed) {
+    int k = index(i, j);
+    if (fixed)
+      _fixed[k >> 6] |= (uint64_t(1) << (k & 63));
+    else
+      _fixed[k >> 6] &= ~(uint64_t(1) << (k & 63));
+  }
+
+  // Raw coordinate rows for kernels (padded, stride() doubles per row)
+  double *x() { return _x.data(); }
+  double *y() { return _y.data(); }
+  double *z() { return _z.data(); }
+  const double *x() const { return _x.data(); }
+  const double *y() const { return _y.data(); }
+  const double *z() const { return _z.data(); }
+  const uint64_t *fixedBits() const { return _fixed.data(); }
+
+  // Conversions for callers still using nested grids
+  static StructuredGrid
+  fromNested(const std::vector<std::vector<gp_Pnt>> &grid,
+             const std::vector<std::vector<bool>> &isFixed) {
+    StructuredGrid g;
+    if (grid.empty() || grid[0].empty())
+      return g;
+    g.resize((int)grid.size() - 1, (int)grid[0].size() - 1);
+    for (int i = 0; i < g._rows; ++i) {
+      for (int j = 0; j < g._cols; ++j) {
+        g.setPoint(i, j, grid[i][j]);
+        if (isFixed[i][j])
+          g.setFixed(i, j, true);
+      }
+    }
+    return g;
+  }
+
+  void toNested(std::vector<std::vector<gp_Pnt>> &grid) const {
+    grid.assign(_rows, std::vector<gp_Pnt>(_cols));
+    for (int i = 0; i < _rows; ++i) {
+      for (int j = 0; j < _cols; ++j) {
+        grid[i][j] = point(i, j);
+      }
+    }
+  }
+
+private:
+  int _rows = 0;
+  int _cols = 0;
+  int _stride = 0;
+  Buffer _x, _y, _z;
+  std::vector<uint64_t> _fixed;
+};
+
+#endif // STRUCTUREDGRID_H
@@ -0,0 +1,160 @@
+#include "TaskGraph.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+namespace {
+
+// Pool runnable executing a worker loop owned by TaskGraph::run()
+class Helper : public QRunnable {
+public:
+  explicit Helper(const std::function<void()> &loop) : _loop(loop) {}
+  void run() override { _loop(); }
+
+private:
+  std::function<void()> _loop;
+};
+
+} // namespace
+
+int TaskGraph::addTask(Work work, double cost) {
+  Task task;
+  task.work = std::move(work);
+  task.cost = cost;
+  _tasks.push_back(std::move(task));
+  return (int)_tasks.size() - 1;
+}
+
+void TaskGraph::addDependency(int before, int after) {
+  _tasks[before].successors.push_back(after);
+  _tasks[after].numPredecessors++;
+}
+
+std::vector<double> TaskGraph::priorities() const {
+  const int n = size();
+
+  // Topological order (Kahn), then priorities from the sinks backwards
+  std::vector<int> order;
+  order.reserve(n);
+  std::vector<int> pending(n);
+  for (int t = 0; t < n; ++t) {
+    pending[t] = _tasks[t].numPredecessors;
+    if (pending[t] == 0)
+      order.push_back(t);
+  }
+  for (size_t k = 0; k < order.size(); ++k) {
+    for (int s : _tasks[order[k]].successors) {
+      if (--pending[s] == 0)
+        order.push_back(s);
+    }
+  }
+  if ((int)order.size() != n)
+    return {};
+
+  std::vector<double> priority(n, 0.0);
+  for (int k = n - 1; k >= 0; --k) {
+    const Task &task = _tasks[order[k]];
+    double longest = 0.0;
+    for (int s : task.successors)
+      longest = std::max(longest, priority[s]);
+    priority[order[k]] = task.cost + longest;
+  }
+  return priority;
+}
+
+bool TaskGraph::run(QThreadPool *pool) {
+  const int n = size();
+  if (n == 0)
+    return true;
+  const std::vector<double> priority = priorities();
+  if (priority.empty())
+    return false;
+  if (!pool)
+    pool = QThreadPool::globalInstance();
+
+  // Ready tasks by priority; ties go to the lower index
+  using Entry = std::pair<double, int>;
+  auto lower = [](const Entry &a, const Entry &b) {
+    return a.first < b.first || (a.first == b.first && a.second > b.second);
+  };
+  std::priority_queue<Entry, std::vector<Entry>, decltype(lower)> ready(
+      lower);
+
+  QMutex mutex;
+  QWaitCondition changed;
+  std::vector<int> pending(n);
+  int unfinished = n;
+  int helpers = 0;
+
+  for (int t = 0; t < n; ++t) {
+    pending[t] = _tasks[t].numPredecessors;
+    if (pending[t] == 0)
+      ready.push({priority[t], t});
+  }
+
+  // An idle helper hands its pool slot back while it waits, so nested
+  // parallel work in the running tasks (QtConcurrent::blockingMap on the
+  // same pool) can still use the pool's threads
+  auto workLoop = [&](bool isHelper) {
+    QMutexLocker locker(&mutex);
+    while (unfinished > 0) {
+      if (ready.empty()) {
+        if (isHelper)
+          pool->releaseThread();
+        changed.wait(&mutex);
+        if (isHelper)
+          pool->reserveThread();
+        continue;
+      }
+      int t = ready.top().second;
+      ready.pop();
+
+      locker.unlock();
+      _tasks[t].work();
+      locker.relock();
+
+      --unfinished;
+      for (int s : _tasks[t].successors) {
+        if (--pending[s] == 0)
+          ready.push({priority[s], s});
+      }
+      changed.wakeAll();
+    }
+  };
+
+  auto helperLoop = [&]() {
+    workLoop(true);
+    QMutexLocker locker(&mutex);
+    --helpers;
+    changed.wakeAll();
+  };
+
+  // Only threads the pool can start right away; the caller covers the rest
+  const int wanted = std::min(n, pool->maxThreadCount()) - 1;
+  for (int k = 0; k < wanted; ++k) {
+    Helper *helper = new Helper(helperLoop);
+    {
+      QMutexLocker locker(&mutex);
+      ++helpers;
+    }
+    if (!pool->tryStart(helper)) {
+      delete helper;
+      QMutexLocker locker(&mutex);
+      --helpers;
+      break;
+    }
+  }
+
+  workLoop(false);
+
+  // The helpers reference this frame, so wait until all have left
+  QMutexLocker locker(&mutex);
+  while (helpers > 0)
+    changed.wait(&mutex);
+  return true;
+}
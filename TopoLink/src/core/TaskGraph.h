@@ -0,0 +1,66 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <functional>
+#include <vector>
+
+class QThreadPool;
+
+/**
+ * @brief Runs a set of tasks with dependencies on a thread pool.
+ *
+ * A task starts as soon as all tasks it depends on have finished, so
+ * independent chains of work overlap instead of waiting at barriers. Among
+ * the ready tasks the one with the longest remaining critical path (its own
+ * cost plus that of the most expensive chain of tasks waiting on it) runs
+ * first. That way the biggest jobs and whatever feeds them do not end up
+ * running alone at the end.
+ *
+ * The calling thread works through tasks too, so run() makes progress even
+ * when it is itself called from a pool thread and the pool is full.
+ */
+class TaskGraph {
+public:
+  using Work = std::function<void()>;
+
+  /**
+   * @brief Adds a task and returns its index.
+   * @param cost Estimated run time in any consistent unit
+   */
+  int addTask(Work work, double cost);
+
+  /** @brief Makes task after wait for task before to finish. */
+  void addDependency(int before, int after);
+
+  int size() const { return (int)_tasks.size(); }
+
+  /**
+   * @brief Critical-path priority of every task: its cost plus the largest
+   * priority of the tasks depending on it. Empty if there is a cycle.
+   */
+  std::vector<double> priorities() const;
+
+  /**
+   * @brief Runs every task once and returns when all have finished.
+   *
+   * Uses up to pool->maxThreadCount() - 1 pool threads besides the caller.
+   * A helper thread that is waiting for a task to become ready releases
+   * its slot in the pool, so tasks may run parallel work of their own on
+   * the same pool.
+   * @return False, without running anything, if the dependencies contain
+   * a cycle
+   */
+  bool run(QThreadPool *pool = nullptr);
+
+private:
+  struct Task {
+    Work work;
+    double cost = 0.0;
+    std::vector<int> successors;
+    int numPredecessors = 0;
+  };
+
+  std::vector<Task> _tasks;
+};
+
+#endif // TASKGRAPH_H
@@ -14,6 +14,43 @@ struct TopoHalfEdge {
   TopoFace *face = nullptr; // The face this half-edge belongs to (loops CCW)
   TopoEdge *parentEdge =
       nullptr; // The parent edge entity containing this half-edge
+
+  // Ring of all half-edges leaving origin, in no particular order. Kept by
+  // Topology; unlike next/prev it also covers edges without faces.
+  TopoHalfEdge *nextOut = nullptr;
+  TopoHalfEdge *prevOut = nullptr;
+};
+
+/**
+ * @brief Circulates the half-edges leaving a vertex (its star) through the
+ * nextOut ring, in O(degree). The ring must not change while circulating.
+ */
+class HalfEdgeStar {
+public:
+  class iterator {
+  public:
+    iterator(TopoHalfEdge *start, TopoHalfEdge *curr)
+        : _start(start), _curr(curr) {}
+    TopoHalfEdge *operator*() const { return _curr; }
+    iterator &operator++() {
+      _curr = _curr->nextOut == _start ? nullptr : _curr->nextOut;
+      return *this;
+    }
+    bool operator==(const iterator &o) const { return _curr == o._curr; }
+    bool operator!=(const iterator &o) const { return _curr != o._curr; }
+
+  private:
+    TopoHalfEdge *_start;
+    TopoHalfEdge *_curr;
+  };
+
+  explicit HalfEdgeStar(TopoHalfEdge *start) : _start(start) {}
+  iterator begin() const { return iterator(_start, _start); }
+  iterator end() const { return iterator(_start, nullptr); }
+  bool empty() const { return !_start; }
+
+private:
+  TopoHalfEdge *_start;
 };
 
 #endif // TOPOHALFEDGE_H
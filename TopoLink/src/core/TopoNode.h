@@ -2,11 +2,9 @@
 #define TOPONODE_H
 
 #include "MetadataHolder.h"
+#include "TopoHalfEdge.h"
 #include <gp_Pnt.hxx>
 
-// Forward declaration
-struct TopoHalfEdge;
-
 class TopoNode : public MetadataHolder {
 public:
   enum class NodeFreedom {
@@ -24,8 +22,11 @@ public:
   void setPosition(const gp_Pnt &position);
 
   // Half-Edge Connectivity
+  // Out is any half-edge of the node's nextOut ring, null if no edge
+  // touches the node.
   TopoHalfEdge *getOut() const;
   void setOut(TopoHalfEdge *out);
+  HalfEdgeStar outgoing() const { return HalfEdgeStar(_out); }
 
   // Constraint Status
   void setFreedom(NodeFreedom freedom);
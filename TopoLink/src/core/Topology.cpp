@@ -3,6 +3,9 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <set>
@@ -16,6 +19,16 @@ Topology::~Topology() {}
 
 int Topology::generateID() { return _nextId++; }
 
+namespace {
+
+// _edgeLookup key of the edge between two nodes, in either direction
+uint64_t edgeKey(int n1, int n2) {
+  return ((uint64_t)(uint32_t)std::min(n1, n2) << 32) |
+         (uint32_t)std::max(n1, n2);
+}
+
+} // namespace
+
 // ---------------------------------------------------------------------------
 // Half-Edge Helpers
 // ---------------------------------------------------------------------------
@@ -144,6 +157,56 @@ void Topology::removeEdgeFromChord(TopoEdge *edge) {
   reg.erase(std::remove(reg.begin(), reg.end(), edge), reg.end());
 }
 
+// ---------------------------------------------------------------------------
+// Vertex Star Helpers
+// ---------------------------------------------------------------------------
+
+void Topology::linkOutgoing(TopoHalfEdge *he) {
+  TopoNode *node = he->origin;
+  TopoHalfEdge *first = node->getOut();
+  if (!first) {
+    he->nextOut = he->prevOut = he;
+    node->setOut(he);
+    return;
+  }
+  he->nextOut = first;
+  he->prevOut = first->prevOut;
+  first->prevOut->nextOut = he;
+  first->prevOut = he;
+}
+
+void Topology::unlinkOutgoing(TopoHalfEdge *he) {
+  if (!he->nextOut)
+    return; // Never linked
+  TopoNode *node = he->origin;
+  if (node && node->getOut() == he)
+    node->setOut(he->nextOut == he ? nullptr : he->nextOut);
+  he->prevOut->nextOut = he->nextOut;
+  he->nextOut->prevOut = he->prevOut;
+  he->nextOut = he->prevOut = nullptr;
+}
+
+void Topology::moveOutgoing(TopoNode *from, TopoNode *to) {
+  TopoHalfEdge *first = from->getOut();
+  if (!first || from == to)
+    return;
+  for (TopoHalfEdge *he : from->outgoing())
+    he->origin = to;
+
+  // Splice the two rings into one
+  if (TopoHalfEdge *other = to->getOut()) {
+    TopoHalfEdge *firstLast = first->prevOut;
+    TopoHalfEdge *otherLast = other->prevOut;
+    firstLast->nextOut = other;
+    other->prevOut = firstLast;
+    otherLast->nextOut = first;
+    first->prevOut = otherLast;
+  } else {
+    to->setOut(first);
+  }
+  from->setOut(nullptr);
+}
+
 // ---------------------------------------------------------------------------
 // Node Management
 // ---------------------------------------------------------------------------
@@ -154,40 +217,30 @@ TopoNode *Topology::createNode(const gp_Pnt &position) {
 }
 
 TopoNode *Topology::createNodeWithID(int id, const gp_Pnt &position) {
-  auto it = _nodes.find(id);
-  if (it != _nodes.end()) {
-    it->second->setPosition(position);
-    return it->second;
+  touchNode(id);
+  if (TopoNode *existing = _nodes.find(id)) {
+    existing->setPosition(position);
+    return existing;
   }
 
   TopoNode *node = _nodePool.allocate(id, position);
-  _nodes[id] = node;
+  _nodes.insert(id, node);
   if (id >= _nextId)
     _nextId = id + 1;
   return node;
 }
 
-TopoNode *Topology::getNode(int id) const {
-  auto it = _nodes.find(id);
-  if (it != _nodes.end()) {
-    return it->second;
-  }
-  return nullptr;
-}
+TopoNode *Topology::getNode(int id) const { return _nodes.find(id); }
 
 void Topology::deleteNode(int id) {
   TopoNode *node = getNode(id);
   if (!node)
     return;
 
-  // Find edges connected to this node
+  // Find edges connected to this node (a self-loop shows up twice)
   std::vector<int> edgesToDelete;
-  for (const auto &pair : _edges) {
-    if (pair.second->getStartNode() == node ||
-        pair.second->getEndNode() == node) {
-      edgesToDelete.push_back(pair.first);
-    }
-  }
+  for (TopoHalfEdge *he : node->outgoing())
+    edgesToDelete.push_back(he->parentEdge->getID());
 
   // Delete connected edges (cascades to faces)
   for (int edgeId : edgesToDelete) {
@@ -195,6 +248,7 @@ void Topology::deleteNode(int id) {
   }
 
   _nodes.erase(id);
+  _nodeRevisions.erase(id);
   _nodePool.deallocate(node);
 }
 
@@ -202,10 +256,11 @@ void Topology::updateNodePosition(int id, const gp_Pnt &pos) {
   TopoNode *node = getNode(id);
   if (node) {
     node->setPosition(pos);
+    touchNode(id);
   }
 }
 
-const std::map<int, TopoNode *> &Topology::getNodes() const { return _nodes; }
+const SlotMap<TopoNode> &Topology::getNodes() const { return _nodes; }
 
 // ---------------------------------------------------------------------------
 // mergeNodes
@@ -222,81 +277,59 @@ bool Topology::mergeNodes(int keepId, int removeId) {
 
   std::unordered_set<int> edgesToDelete;
 
-  // 1. Rewire all edges referencing removeNode → keepNode
-  for (auto &pair : _edges) {
-    TopoEdge *edge = pair.second;
-    bool modified = false;
-
-    if (edge->getStartNode() == removeNode) {
+  // 1. Rewire the edges in removeNode's star → keepNode. Their lookup keys
+  //    change, so drop the old ones now.
+  for (TopoHalfEdge *he : removeNode->outgoing()) {
+    TopoEdge *edge = he->parentEdge;
+    if (edge->getStartNode() != removeNode &&
+        edge->getEndNode() != removeNode)
+      continue; // Self-loop at removeNode, already rewired via its twin
+    _edgeLookup.erase(edgeKey(edge->getStartNode()->getID(),
+                              edge->getEndNode()->getID()));
+    if (edge->getStartNode() == removeNode)
       edge->setStartNode(keepNode);
-      modified = true;
-    }
-    if (edge->getEndNode() == removeNode) {
+    if (edge->getEndNode() == removeNode)
       edge->setEndNode(keepNode);
-      modified = true;
-    }
 
-    if (modified && edge->getStartNode() == edge->getEndNode()) {
-      edgesToDelete.insert(pair.first);
-    }
+    if (edge->getStartNode() == edge->getEndNode())
+      edgesToDelete.insert(edge->getID());
   }
 
-  // 2. Update half-edge origins
-  for (auto &edgePair : _edges) {
-    TopoEdge *e = edgePair.second;
-    if (e->getForwardHalfEdge() &&
-        e->getForwardHalfEdge()->origin == removeNode) {
-      e->getForwardHalfEdge()->origin = keepNode;
-    }
-    if (e->getBackwardHalfEdge() &&
-        e->getBackwardHalfEdge()->origin == removeNode) {
-      e->getBackwardHalfEdge()->origin = keepNode;
-    }
-  }
+  // 2. Update half-edge origins and join the two stars
+  moveOutgoing(removeNode, keepNode);
 
-  // 3. Find and mark duplicate edges
-  std::map<std::pair<int, int>, TopoEdge *> seenEdgesMap;
+  // 3. Find and mark duplicate edges. Only edges at keepNode can have
+  //    gained a parallel twin.
+  FlatHashMap<TopoEdge *> seenEdgesMap;
   std::unordered_set<int> affectedFaceIds;
 
-  for (auto &pair : _edges) {
-    if (edgesToDelete.count(pair.first))
+  for (TopoHalfEdge *he : keepNode->outgoing()) {
+    TopoEdge *edge = he->parentEdge;
+    if (edgesToDelete.count(edge->getID()))
       continue;
 
-    TopoEdge *edge = pair.second;
-    int n1 = edge->getStartNode()->getID();
-    int n2 = edge->getEndNode()->getID();
-    auto normalizedPair = std::make_pair(std::min(n1, n2), std::max(n1, n2));
+    TopoNode *other = he->twin->origin;
+    uint64_t normalizedPair = edgeKey(keepId, other->getID());
 
-    if (seenEdgesMap.count(normalizedPair) > 0) {
-      TopoEdge *keeper = seenEdgesMap[normalizedPair];
+    TopoEdge **seen = seenEdgesMap.find(normalizedPair);
+    if (seen && *seen == edge)
+      continue; // Self-loop at keepNode, seen from its other half-edge
+    if (seen) {
+      // Keep the older edge; ring order is not ID order
+      TopoEdge *keeper = *seen;
       TopoEdge *duplicate = edge;
-
-      // Transfer group membership from duplicate to keeper
-      for (auto &groupPair : _edgeGroups) {
-        auto &group = groupPair.second;
-        auto &edges = group->edges;
-        bool dupInGroup =
-            std::find(edges.begin(), edges.end(), duplicate) != edges.end();
-        if (dupInGroup) {
-          // Add keeper if not present
-          if (std::find(edges.begin(), edges.end(), keeper) == edges.end()) {
-            edges.push_back(keeper);
-          }
-        }
+      if (duplicate->getID() < keeper->getID()) {
+        std::swap(keeper, duplicate);
+        *seen = keeper;
       }
 
-      // Transfer group membership from duplicate to keeper
-      for (auto &groupPair : _edgeGroups) {
-        auto &group = groupPair.second;
-        auto &edges = group->edges;
-        bool dupInGroup =
-            std::find(edges.begin(), edges.end(), duplicate) != edges.end();
-        if (dupInGroup) {
-          // Add keeper if not present
-          if (std::find(edges.begin(), edges.end(), keeper) == edges.end()) {
-            edges.push_back(keeper);
-          }
-        }
+      // Transfer group membership from duplicate to keeper (copied, since
+      // adding the keeper may rehash the index)
+      auto dupGroups = _edgeToGroups.find(duplicate->getID());
+      if (dupGroups != _edgeToGroups.end()) {
+        std::vector<TopoEdgeGroup *> groups = dupGroups->second;
+        for (TopoEdgeGroup *group : groups)
+          addEdgeToGroup(group->id, keeper); // No-op if already a member
       }
 
       // Replace duplicate with keeper only in faces that reference the
@@ -312,20 +345,29 @@ bool Topology::mergeNodes(int keepId, int removeId) {
         affectedFaceIds.insert(he2->face->getID());
       }
 
-      edgesToDelete.insert(pair.first);
+      edgesToDelete.insert(duplicate->getID());
     } else {
-      seenEdgesMap[normalizedPair] = edge;
+      seenEdgesMap.insert_or_assign(normalizedPair, edge);
     }
   }
 
-  // 4. Find degenerate faces:
+  // 4. Find degenerate faces among those around keepNode:
   //    - Does NOT have exactly 4 unique surviving edges (Strict Quad Domain),
   //    OR
   //    - References any edge that will be deleted (self-loops, duplicates), OR
   //    - Has duplicate references to the same surviving edge (loop corruption)
+  std::set<int> candidateFaceIds(affectedFaceIds.begin(),
+                                 affectedFaceIds.end());
+  for (TopoHalfEdge *he : keepNode->outgoing()) {
+    if (he->face)
+      candidateFaceIds.insert(he->face->getID());
+    if (he->twin->face)
+      candidateFaceIds.insert(he->twin->face->getID());
+  }
+
   std::vector<int> facesToDelete;
-  for (auto &facePair : _faces) {
-    const auto &faceEdges = facePair.second->getEdges();
+  for (int faceId : candidateFaceIds) {
+    const auto &faceEdges = getFace(faceId)->getEdges();
     bool refsDeletedEdge = false;
     std::set<TopoEdge *> uniqueEdges;
     for (auto *e : faceEdges) {
@@ -340,54 +382,57 @@ bool Topology::mergeNodes(int keepId, int removeId) {
     // uniqueEdges.size())
     if (refsDeletedEdge || uniqueEdges.size() != 4 ||
         faceEdges.size() != uniqueEdges.size()) {
-      facesToDelete.push_back(facePair.first);
+      facesToDelete.push_back(faceId);
     }
   }
+  for (int faceId : facesToDelete) {
+    deleteFace(faceId);
+    affectedFaceIds.erase(faceId);
+  }
 
-  // Phase 4: Delete all old edges
-  // ... (bypass deleteEdge cascade since faces are handled above)
+  // 5. Rebuild half-edges only for affected surviving faces. Done before
+  //    the edges go, since the old loops still run through them.
+  for (int faceId : affectedFaceIds)
+    rebuildFaceHalfEdges(faceId);
+
+  // 6. Delete all old edges
+  // ... (bypass deleteEdge cascade since faces are handled above; their
+  // lookup keys were dropped in step 1 or belong to the keepers)
   for (int edgeId : edgesToDelete) {
     TopoEdge *edge = getEdge(edgeId);
     if (!edge)
       continue;
 
     // Remove from groups
-    for (auto &groupPair : _edgeGroups) {
-      auto &edges = groupPair.second->edges;
-      edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
-    }
-
-    // Remove from lookup
-    int n1 = edge->getStartNode()->getID();
-    int n2 = edge->getEndNode()->getID();
-    auto key = std::make_pair(std::min(n1, n2), std::max(n1, n2));
-    _edgeLookup.erase(key);
+    removeEdgeFromGroups(edge);
 
     // Clean up chord registration
     removeEdgeFromChord(edge);
 
-    // Delete half-edges
+    // Delete half-edges (leaves keepNode's star)
     if (edge->getForwardHalfEdge())
       deleteHalfEdge(edge->getForwardHalfEdge());
     if (edge->getBackwardHalfEdge())
       deleteHalfEdge(edge->getBackwardHalfEdge());
 
     _edges.erase(edgeId);
+    _edgeRevisions.erase(edgeId);
     _edgePool.deallocate(edge);
   }
 
-  // 7. Rebuild half-edges only for affected surviving faces
-  for (int faceId : affectedFaceIds) {
-    if (_faces.count(faceId)) {
-      rebuildFaceHalfEdges(faceId);
-    }
+  // 7. Point the lookup at the surviving edges around keepNode
+  for (TopoHalfEdge *he : keepNode->outgoing()) {
+    TopoEdge *edge = he->parentEdge;
+    _edgeLookup.insert_or_assign(edgeKey(edge->getStartNode()->getID(),
+                                         edge->getEndNode()->getID()),
+                                 edge);
   }
 
-  // 8. Rebuild edge lookup (endpoints changed)
-  rebuildEdgeLookup();
-
-  // 9. Remove the merged-away node (direct cleanup, no cascade needed)
+  // 8. Remove the merged-away node (direct cleanup, no cascade needed)
+  // Edges now ending at keepNode see it as changed
+  touchNode(keepId);
   _nodes.erase(removeId);
+  _nodeRevisions.erase(removeId);
   _nodePool.deallocate(removeNode);
 
   return true;
@@ -406,15 +451,15 @@ TopoEdge *Topology::createEdgeWithID(int id, TopoNode *start, TopoNode *end) {
   if (!start || !end)
     return nullptr;
 
-  auto it = _edges.find(id);
-  if (it != _edges.end()) {
+  if (TopoEdge *existing = _edges.find(id)) {
     // Edge exists, verify/update nodes if possible, but typically IDs are
     // stable. For now, just return existing to maintain idempotency.
-    return it->second;
+    return existing;
   }
 
   TopoEdge *edge = _edgePool.allocate(id, start, end);
-  _edges[id] = edge;
+  _edges.insert(id, edge);
+  touchEdge(id);
 
   // Create half-edges
   TopoHalfEdge *he1 = createHalfEdge();
@@ -425,17 +470,12 @@ TopoEdge *Topology::createEdgeWithID(int id, TopoNode *start, TopoNode *end) {
   he2->parentEdge = edge;
   edge->setHalfEdges(he1, he2);
 
-  // Set default out pointer for nodes if not already set
-  if (!start->getOut())
-    start->setOut(he1);
-  if (!end->getOut())
-    end->setOut(he2);
+  // Add to the nodes' stars (also sets their out pointer if unset)
+  linkOutgoing(he1);
+  linkOutgoing(he2);
 
   // Update optimized lookup
-  int n1 = start->getID();
-  int n2 = end->getID();
-  auto key = std::make_pair(std::min(n1, n2), std::max(n1, n2));
-  _edgeLookup[key] = edge;
+  _edgeLookup.insert_or_assign(edgeKey(start->getID(), end->getID()), edge);
 
   if (id >= _nextId)
     _nextId = id + 1;
@@ -445,13 +485,8 @@ TopoEdge *Topology::createEdgeWithID(int id, TopoNode *start, TopoNode *end) {
 TopoEdge *Topology::getEdge(TopoNode *n1, TopoNode *n2) const {
   if (!n1 || !n2)
     return nullptr;
-  auto key = std::make_pair(std::min(n1->getID(), n2->getID()),
-                            std::max(n1->getID(), n2->getID()));
-  auto it = _edgeLookup.find(key);
-  if (it != _edgeLookup.end()) {
-    return it->second;
-  }
-  return nullptr;
+  TopoEdge *const *edge = _edgeLookup.find(edgeKey(n1->getID(), n2->getID()));
+  return edge ? *edge : nullptr;
 }
 
 TopoEdge *Topology::getEdge(int n1Id, int n2Id) const {
@@ -462,13 +497,7 @@ TopoEdge *Topology::getEdge(int n1Id, int n2Id) const {
   return getEdge(n1, n2);
 }
 
-TopoEdge *Topology::getEdge(int id) const {
-  auto it = _edges.find(id);
-  if (it != _edges.end()) {
-    return it->second;
-  }
-  return nullptr;
-}
+TopoEdge *Topology::getEdge(int id) const { return _edges.find(id); }
 
 void Topology::deleteEdge(int id) {
   TopoEdge *edge = getEdge(id);
@@ -493,16 +522,12 @@ void Topology::deleteEdge(int id) {
   }
 
   // 3. Remove from edge groups
-  for (auto &groupPair : _edgeGroups) {
-    auto &edges = groupPair.second->edges;
-    edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
-  }
+  removeEdgeFromGroups(edge);
 
   // 4. Remove from optimized lookup
   int n1 = edge->getStartNode()->getID();
   int n2 = edge->getEndNode()->getID();
-  auto key = std::make_pair(std::min(n1, n2), std::max(n1, n2));
-  _edgeLookup.erase(key);
+  _edgeLookup.erase(edgeKey(n1, n2));
 
   // 5. Clean up chord registration
   removeEdgeFromChord(edge);
@@ -515,6 +540,7 @@ void Topology::deleteEdge(int id) {
 
   // 7. Delete the edge
   _edges.erase(id);
+  _edgeRevisions.erase(id);
   _edgePool.deallocate(edge);
 }
 
@@ -523,12 +549,11 @@ void Topology::rebuildEdgeLookup() {
   for (auto const &[id, edge] : _edges) {
     int n1 = edge->getStartNode()->getID();
     int n2 = edge->getEndNode()->getID();
-    auto key = std::make_pair(std::min(n1, n2), std::max(n1, n2));
-    _edgeLookup[key] = edge;
+    _edgeLookup.insert_or_assign(edgeKey(n1, n2), edge);
   }
 }
 
-const std::map<int, TopoEdge *> &Topology::getEdges() const { return _edges; }
+const SlotMap<TopoEdge> &Topology::getEdges() const { return _edges; }
 
 // ---------------------------------------------------------------------------
 // Edge Dimensions
@@ -545,9 +570,9 @@ std::set<int> Topology::getUniqueEdgeSubdivisions() const {
 void Topology::setSubdivisionsForEdges(const std::vector<int> &edgeIDs,
                                        int subdivisions) {
   for (int id : edgeIDs) {
-    auto it = _edges.find(id);
-    if (it != _edges.end()) {
-      it->second->setSubdivisions(subdivisions);
+    if (TopoEdge *edge = _edges.find(id)) {
+      edge->setSubdivisions(subdivisions);
+      touchSubdivisions(edge);
     }
   }
 }
@@ -570,6 +595,7 @@ void Topology::propagateSubdivisions(int edgeId, int subdivisions) {
       continue;
 
     currEdge->setSubdivisions(subdivisions);
+    touchSubdivisions(currEdge);
 
     // Find "parallel" edges via adjacent faces
     std::vector<TopoHalfEdge *> hes = {currEdge->getForwardHalfEdge(),
@@ -701,17 +727,6 @@ TopoNode *Topology::splitEdge(int edgeId, double t) {
   std::vector<EdgeSplitData> splitData;
   splitData.reserve(edgesToSplit.size());
 
-  // Pre-calculate edge group map
-  std::map<int, std::vector<int>> edgeGroupMap; // edge ID -> group IDs
-  for (const auto &[gid, group] : _edgeGroups) {
-    if (group) {
-      for (TopoEdge *e : group->edges) {
-        if (e)
-          edgeGroupMap[e->getID()].push_back(gid);
-      }
-    }
-  }
-
   // Phase 1: Create all new nodes and edges
   for (int eid : edgesToSplit) {
     TopoEdge *oldEdge = getEdge(eid);
@@ -749,12 +764,14 @@ TopoNode *Topology::splitEdge(int edgeId, double t) {
     data.newEdge1 = createEdge(start, data.newNode);
     data.newEdge2 = createEdge(data.newNode, end);
 
-    // Inherit Edge Groups
-    if (edgeGroupMap.count(eid)) {
-      for (int gid : edgeGroupMap[eid]) {
-        addEdgeToGroup(gid, data.newEdge1);
-        addEdgeToGroup(gid, data.newEdge2);
-        logFile << "      Inherited Group " << gid << " for new edges"
+    // Inherit Edge Groups (copied, since adding may rehash the index)
+    auto oldGroups = _edgeToGroups.find(eid);
+    if (oldGroups != _edgeToGroups.end()) {
+      std::vector<TopoEdgeGroup *> groups = oldGroups->second;
+      for (TopoEdgeGroup *group : groups) {
+        addEdgeToGroup(group->id, data.newEdge1);
+        addEdgeToGroup(group->id, data.newEdge2);
+        logFile << "      Inherited Group " << group->id << " for new edges"
                 << std::endl;
       }
     }
@@ -780,14 +797,6 @@ TopoNode *Topology::splitEdge(int edgeId, double t) {
 
   // Phase 2: Subdivide faces (create connecting edges and new faces)
   std::set<int> facesToDelete;
-  std::map<int, std::vector<int>> faceGroupMap; // old face ID -> group IDs
-
-  // Track which faces have which edge groups
-  for (const auto &[fid, faceGroup] : _faceGroups) {
-    for (TopoFace *face : faceGroup->faces) {
-      faceGroupMap[face->getID()].push_back(fid);
-    }
-  }
 
   // Group splits by face
   std::map<int, std::vector<int>> faceToSplitIndices;
@@ -925,10 +934,11 @@ TopoNode *Topology::splitEdge(int edgeId, double t) {
       // CRITICAL FIX: Delete the old face NOW to unbind its half-edges from the
       // perpendicular edges. If we don't do this, createFace() will fail
       // because the edges are still "owned" by the old face. We have already
-      // extracted all necessary data (perpEdges, faceGroupMap).
-      std::vector<int> currentGroups;
-      if (faceGroupMap.count(fid)) {
-        currentGroups = faceGroupMap[fid];
+      // extracted all necessary data (perpEdges, face groups).
+      std::vector<TopoFaceGroup *> currentGroups;
+      auto oldGroups = _faceToGroups.find(fid);
+      if (oldGroups != _faceToGroups.end()) {
+        currentGroups = oldGroups->second;
       }
 
       logFile << "  Deleting old face " << fid
@@ -943,10 +953,10 @@ TopoNode *Topology::splitEdge(int edgeId, double t) {
                 << newFace2->getID() << std::endl;
 
         // Preserve face groups
-        for (int groupId : currentGroups) {
-          addFaceToGroup(groupId, newFace1);
-          addFaceToGroup(groupId, newFace2);
-          logFile << "  Added new faces to group " << groupId << std::endl;
+        for (TopoFaceGroup *group : currentGroups) {
+          addFaceToGroup(group->id, newFace1);
+          addFaceToGroup(group->id, newFace2);
+          logFile << "  Added new faces to group " << group->id << std::endl;
         }
 
         // facesToDelete.insert(fid); // No longer needed, already deleted
@@ -975,20 +985,6 @@ TopoNode *Topology::splitEdge(int edgeId, double t) {
     }
   }
 
-  // Phase 4: Update edge groups
-  for (const auto &data : splitData) {
-    for (auto &groupPair : _edgeGroups) {
-      auto &group = groupPair.second;
-      auto it =
-          std::find(group->edges.begin(), group->edges.end(), data.oldEdge);
-      if (it != group->edges.end()) {
-        it = group->edges.erase(it);
-        it = group->edges.insert(it, data.newEdge1);
-        group->edges.insert(it + 1, data.newEdge2);
-      }
-    }
-  }
-
   qDebug() << "splitEdge: Successfully split" << splitData.size() << "edges";
   qDebug() << "splitEdge: Total edges now:" << _edges.size()
            << "Total nodes now:" << _nodes.size();
@@ -1017,7 +1013,8 @@ TopoFace *Topology::createFaceWithID(int id,
     return nullptr;
 
   TopoFace *face = _facePool.allocate(id, edges);
-  _faces[id] = face;
+  _faces.insert(id, face);
+  touchFace(id);
   if (id >= _nextId)
     _nextId = id + 1;
 
@@ -1029,13 +1026,7 @@ TopoFace *Topology::createFaceWithID(int id,
   return face;
 }
 
-TopoFace *Topology::getFace(int id) const {
-  auto it = _faces.find(id);
-  if (it != _faces.end()) {
-    return it->second;
-  }
-  return nullptr;
-}
+TopoFace *Topology::getFace(int id) const { return _faces.find(id); }
 
 void Topology::deleteFace(int id) {
   TopoFace *face = getFace(id);
@@ -1047,12 +1038,10 @@ void Topology::deleteFace(int id) {
   resetHalfEdgeLoop(face->getBoundary());
 
   // Remove from face groups
-  for (auto &groupPair : _faceGroups) {
-    auto &faces = groupPair.second->faces;
-    faces.erase(std::remove(faces.begin(), faces.end(), face), faces.end());
-  }
+  removeFaceFromGroups(face);
 
   _faces.erase(id);
+  _faceRevisions.erase(id);
   _facePool.deallocate(face);
 }
 
@@ -1061,6 +1050,8 @@ void Topology::rebuildFaceHalfEdges(int faceId) {
   if (!face)
     return;
 
+  touchFace(faceId);
+
   // 1. Reset existing half-edge loop
   resetHalfEdgeLoop(face->getBoundary());
   face->setBoundary(nullptr);
@@ -1076,7 +1067,7 @@ void Topology::rebuildFaceHalfEdges(int faceId) {
   }
 }
 
-const std::map<int, TopoFace *> &Topology::getFaces() const { return _faces; }
+const SlotMap<TopoFace> &Topology::getFaces() const { return _faces; }
 
 // ---------------------------------------------------------------------------
 // Half-Edge & Chord Management
@@ -1085,6 +1076,7 @@ const std::map<int, TopoFace *> &Topology::getFaces() const { return _faces; }
 TopoHalfEdge *Topology::createHalfEdge() { return _halfEdgePool.allocate(); }
 
 void Topology::deleteHalfEdge(TopoHalfEdge *he) {
+  unlinkOutgoing(he);
   _halfEdgePool.deallocate(he);
 }
 
@@ -1230,8 +1222,7 @@ void Topology::fromJson(const QJsonObject &json) {
   _edges.clear();
   _faces.clear();
   _edgeLookup.clear();
-  _edgeGroups.clear();
-  _faceGroups.clear();
+  clearGroups();
   _nextId = 1;
 
   // Reset pools (now properly calls destructors for live objects)
@@ -1411,10 +1402,16 @@ TopoEdgeGroup *Topology::createEdgeGroup(const std::string &name,
   group->id = id;
   group->name = name;
   group->geometryID = geometryID;
+  group->geometryIds = parseGeometryIds(geometryID);
   _edgeGroups[id] = std::move(group);
   return _edgeGroups[id].get();
 }
 
+TopoEdgeGroup *Topology::createEdgeGroup(const std::string &name,
+                                         const std::vector<int> &geometryIds) {
+  return createEdgeGroup(name, formatGeometryIds(geometryIds));
+}
+
 TopoFaceGroup *Topology::createFaceGroup(const std::string &name,
                                          const std::string &geometryID) {
   int id = generateID();
@@ -1422,20 +1419,143 @@ TopoFaceGroup *Topology::createFaceGroup(const std::string &name,
   group->id = id;
   group->name = name;
   group->geometryID = geometryID;
+  group->geometryIds = parseGeometryIds(geometryID);
   _faceGroups[id] = std::move(group);
   return _faceGroups[id].get();
 }
 
-void Topology::addEdgeToGroup(int groupID, TopoEdge *edge) {
-  if (_edgeGroups.count(groupID)) {
-    _edgeGroups[groupID]->edges.push_back(edge);
+TopoFaceGroup *Topology::createFaceGroup(const std::string &name,
+                                         const std::vector<int> &geometryIds) {
+  return createFaceGroup(name, formatGeometryIds(geometryIds));
+}
+
+std::vector<int> Topology::parseGeometryIds(const std::string &geometryID) {
+  std::vector<int> ids;
+  size_t begin = 0;
+  while (begin <= geometryID.size()) {
+    size_t end = geometryID.find(',', begin);
+    if (end == std::string::npos)
+      end = geometryID.size();
+    std::string item = geometryID.substr(begin, end - begin);
+    size_t first = item.find_first_not_of(" \t");
+    size_t last = item.find_last_not_of(" \t");
+    if (first != std::string::npos) {
+      item = item.substr(first, last - first + 1);
+      char *stop = nullptr;
+      errno = 0;
+      long value = std::strtol(item.c_str(), &stop, 10);
+      if (*stop == '\0' && errno == 0 && value >= INT_MIN &&
+          value <= INT_MAX)
+        ids.push_back((int)value);
+    }
+    begin = end + 1;
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
+}
+
+std::string Topology::formatGeometryIds(const std::vector<int> &geometryIds) {
+  std::vector<int> ids = geometryIds;
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  std::string text;
+  for (int id : ids) {
+    if (!text.empty())
+      text += ',';
+    text += std::to_string(id);
   }
+  return text;
+}
+
+namespace {
+
+// Adds group to the sorted list of member id; false if already there
+template <typename Group>
+bool indexMember(std::unordered_map<int, std::vector<Group *>> &index, int id,
+                 Group *group) {
+  std::vector<Group *> &groups = index[id];
+  auto pos = std::lower_bound(
+      groups.begin(), groups.end(), group,
+      [](const Group *a, const Group *b) { return a->id < b->id; });
+  if (pos != groups.end() && *pos == group)
+    return false;
+  groups.insert(pos, group);
+  return true;
+}
+
+} // namespace
+
+void Topology::addEdgeToGroup(int groupID, TopoEdge *edge) {
+  auto it = _edgeGroups.find(groupID);
+  if (it == _edgeGroups.end() || !edge)
+    return;
+  if (indexMember(_edgeToGroups, edge->getID(), it->second.get()))
+    it->second->edges.push_back(edge);
 }
 
 void Topology::addFaceToGroup(int groupID, TopoFace *face) {
-  if (_faceGroups.count(groupID)) {
-    _faceGroups[groupID]->faces.push_back(face);
+  auto it = _faceGroups.find(groupID);
+  if (it == _faceGroups.end() || !face)
+    return;
+  if (indexMember(_faceToGroups, face->getID(), it->second.get()))
+    it->second->faces.push_back(face);
+}
+
+void Topology::clearEdgeGroup(int groupID) {
+  TopoEdgeGroup *group = getEdgeGroup(groupID);
+  if (!group)
+    return;
+  for (TopoEdge *edge : group->edges) {
+    auto it = _edgeToGroups.find(edge->getID());
+    if (it == _edgeToGroups.end())
+      continue;
+    auto &groups = it->second;
+    groups.erase(std::remove(groups.begin(), groups.end(), group),
+                 groups.end());
+    if (groups.empty())
+      _edgeToGroups.erase(it);
+  }
+  group->edges.clear();
+}
+
+void Topology::clearFaceGroup(int groupID) {
+  TopoFaceGroup *group = getFaceGroup(groupID);
+  if (!group)
+    return;
+  for (TopoFace *face : group->faces) {
+    auto it = _faceToGroups.find(face->getID());
+    if (it == _faceToGroups.end())
+      continue;
+    auto &groups = it->second;
+    groups.erase(std::remove(groups.begin(), groups.end(), group),
+                 groups.end());
+    if (groups.empty())
+      _faceToGroups.erase(it);
+  }
+  group->faces.clear();
+}
+
+void Topology::removeEdgeFromGroups(TopoEdge *edge) {
+  auto it = _edgeToGroups.find(edge->getID());
+  if (it == _edgeToGroups.end())
+    return;
+  for (TopoEdgeGroup *group : it->second) {
+    auto &edges = group->edges;
+    edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+  }
+  _edgeToGroups.erase(it);
+}
+
+void Topology::removeFaceFromGroups(TopoFace *face) {
+  auto it = _faceToGroups.find(face->getID());
+  if (it == _faceToGroups.end())
+    return;
+  for (TopoFaceGroup *group : it->second) {
+    auto &faces = group->faces;
+    faces.erase(std::remove(faces.begin(), faces.end(), face), faces.end());
   }
+  _faceToGroups.erase(it);
 }
 
 TopoEdgeGroup *Topology::getEdgeGroup(int id) const {
@@ -1473,51 +1593,87 @@ TopoFaceGroup *Topology::getFaceGroupByName(const std::string &name) const {
 }
 
 TopoEdgeGroup *Topology::getGroupForEdge(int edgeId) const {
-  qDebug() << "Topology::getGroupForEdge(" << edgeId << ") searching"
-           << _edgeGroups.size() << "groups";
-  for (auto const &pair : _edgeGroups) {
-    qDebug() << "  Checking Group" << pair.second->name.c_str() << "with"
-             << pair.second->edges.size() << "edges";
-    for (TopoEdge *e : pair.second->edges) {
-      if (e && e->getID() == edgeId) {
-        qDebug() << "    FOUND edge" << edgeId << "in group"
-                 << pair.second->name.c_str();
-        return pair.second.get();
-      }
-    }
-  }
-  return nullptr;
+  auto it = _edgeToGroups.find(edgeId);
+  return it != _edgeToGroups.end() ? it->second.front() : nullptr;
 }
 
 TopoFaceGroup *Topology::getGroupForFace(int faceId) const {
-  qDebug() << "Topology::getGroupForFace(" << faceId << ") searching"
-           << _faceGroups.size() << "groups";
-  for (auto const &pair : _faceGroups) {
-    qDebug() << "  Checking Group" << pair.second->name.c_str() << "with"
-             << pair.second->faces.size() << "faces";
-    for (TopoFace *f : pair.second->faces) {
-      if (f && f->getID() == faceId) {
-        qDebug() << "    FOUND face" << faceId << "in group"
-                 << pair.second->name.c_str();
-        return pair.second.get();
-      }
-    }
-  }
-  return nullptr;
+  auto it = _faceToGroups.find(faceId);
+  return it != _faceToGroups.end() ? it->second.front() : nullptr;
 }
 
 std::string Topology::getFaceGeometryID(int faceId) const {
-  for (auto const &pair : _faceGroups) {
-    for (TopoFace *f : pair.second->faces) {
-      if (f->getID() == faceId) {
-        return pair.second->geometryID;
-      }
-    }
-  }
-  return "";
+  TopoFaceGroup *group = getGroupForFace(faceId);
+  return group ? group->geometryID : "";
 }
 
 void Topology::clearGroups() {
   _edgeGroups.clear();
   _faceGroups.clear();
+  _edgeToGroups.clear();
+  _faceToGroups.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Edit Tracking
+// ---------------------------------------------------------------------------
+
+namespace {
+
+uint64_t stampOf(const std::map<int, uint64_t> &stamps, int id) {
+  auto it = stamps.find(id);
+  return it != stamps.end() ? it->second : 0;
+}
+
+} // namespace
+
+uint64_t Topology::getNodeRevision(int id) const {
+  return stampOf(_nodeRevisions, id);
+}
+
+uint64_t Topology::getEdgeRevision(int id) const {
+  return stampOf(_edgeRevisions, id);
+}
+
+uint64_t Topology::getFaceRevision(int id) const {
+  return stampOf(_faceRevisions, id);
+}
+
+void Topology::touchNode(int id) { _nodeRevisions[id] = ++_revision; }
+
+void Topology::touchEdge(int id) { _edgeRevisions[id] = ++_revision; }
+
+void Topology::touchFace(int id) { _faceRevisions[id] = ++_revision; }
+
+void Topology::touchSubdivisions(TopoEdge *edge) {
+  touchEdge(edge->getID());
+  // Edges sharing a chord share its segment count
+  if (DimensionChord *chord = edge->getChord()) {
+    for (TopoEdge *e : chord->registeredEdges) {
+      if (e)
+        touchEdge(e->getID());
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Memory
+// ---------------------------------------------------------------------------
+
+Topology::PoolStats Topology::getPoolStats() const {
+  PoolStats stats;
+  stats.nodes = _nodePool.stats();
+  stats.edges = _edgePool.stats();
+  stats.faces = _facePool.stats();
+  stats.halfEdges = _halfEdgePool.stats();
+  stats.chords = _chordPool.stats();
+  return stats;
+}
+
+void Topology::releaseUnusedMemory() {
+  _nodePool.trim();
+  _edgePool.trim();
+  _facePool.trim();
+  _halfEdgePool.trim();
+  _chordPool.trim();
 }
@@ -2,32 +2,40 @@
 #define TOPOLOGY_H
 
 #include "DimensionChord.h" // Needed for pool
+#include "FlatHashMap.h"
 #include "ObjectPool.h"
+#include "SlotMap.h"
 #include "TopoEdge.h"
 #include "TopoFace.h"
 #include "TopoHalfEdge.h"
 #include "TopoNode.h"
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class QJsonObject;
 
 // Grouping structures
+// Members are indexed by Topology; change them only through its group
+// methods, never through the vectors directly.
 struct TopoEdgeGroup {
   int id;
-  std::string name;       // Added for UI sync
-  std::string geometryID; // Link to geometry constraint
+  std::string name;             // Added for UI sync
+  std::string geometryID;       // Link to geometry constraint, "3,7,12"
+  std::vector<int> geometryIds; // geometryID parsed, sorted and unique
   std::vector<TopoEdge *> edges;
 };
 
 struct TopoFaceGroup {
   int id;
-  std::string name;       // Added for UI sync
-  std::string geometryID; // Link to geometry constraint
+  std::string name;             // Added for UI sync
+  std::string geometryID;       // Link to geometry constraint, "3,7,12"
+  std::vector<int> geometryIds; // geometryID parsed, sorted and unique
   std::vector<TopoFace *> faces;
 };
 
@@ -35,6 +43,12 @@ class Topology {
 public:
   static constexpr int kHalfEdgeLoopLimit = 1000;
 
+  // Handles name an entity like its ID but skip the ID lookup, and read as
+  // null once the entity is deleted (see SlotMap)
+  using NodeHandle = SlotMap<TopoNode>::SlotHandle;
+  using EdgeHandle = SlotMap<TopoEdge>::SlotHandle;
+  using FaceHandle = SlotMap<TopoFace>::SlotHandle;
+
   Topology();
   ~Topology();
 
@@ -46,10 +60,12 @@ public:
   TopoNode *createNode(const gp_Pnt &position);
   TopoNode *createNodeWithID(int id, const gp_Pnt &position);
   TopoNode *getNode(int id) const;
+  TopoNode *getNode(NodeHandle handle) const { return _nodes.get(handle); }
+  NodeHandle getNodeHandle(int id) const { return _nodes.handle(id); }
   void deleteNode(int id);
   bool mergeNodes(int keepId, int removeId);
   void updateNodePosition(int id, const gp_Pnt &pos);
-  const std::map<int, TopoNode *> &getNodes() const;
+  const SlotMap<TopoNode> &getNodes() const;
 
   // Edge Management
   TopoEdge *createEdge(TopoNode *start, TopoNode *end);
@@ -57,11 +73,13 @@ public:
   TopoEdge *getEdge(int id) const;
   TopoEdge *getEdge(TopoNode *start, TopoNode *end) const;
   TopoEdge *getEdge(int n1Id, int n2Id) const;
+  TopoEdge *getEdge(EdgeHandle handle) const { return _edges.get(handle); }
+  EdgeHandle getEdgeHandle(int id) const { return _edges.handle(id); }
   void deleteEdge(int id);
   TopoNode *splitEdge(int edgeId, double t);
   void rebuildEdgeLookup();
 
-  const std::map<int, TopoEdge *> &getEdges() const;
+  const SlotMap<TopoEdge> &getEdges() const;
 
   // Edge Dimensions
   std::set<int> getUniqueEdgeSubdivisions() const;
@@ -73,9 +91,11 @@ public:
   TopoFace *createFace(const std::vector<TopoEdge *> &edges);
   TopoFace *createFaceWithID(int id, const std::vector<TopoEdge *> &edges);
   TopoFace *getFace(int id) const;
+  TopoFace *getFace(FaceHandle handle) const { return _faces.get(handle); }
+  FaceHandle getFaceHandle(int id) const { return _faces.handle(id); }
   void deleteFace(int id);
   void rebuildFaceHalfEdges(int faceId);
-  const std::map<int, TopoFace *> &getFaces() const;
+  const SlotMap<TopoFace> &getFaces() const;
 
   // Half-Edge Internal Management
   TopoHalfEdge *createHalfEdge();
@@ -86,16 +106,29 @@ public:
   void deleteChord(DimensionChord *chord);
 
   // Group Management
+  // The geometry link is given as a comma-separated ID list or as the IDs
+  // themselves; groups keep both forms.
   TopoEdgeGroup *createEdgeGroup(const std::string &name,
                                  const std::string &geometryID);
+  TopoEdgeGroup *createEdgeGroup(const std::string &name,
+                                 const std::vector<int> &geometryIds);
   TopoFaceGroup *createFaceGroup(const std::string &name,
                                  const std::string &geometryID);
+  TopoFaceGroup *createFaceGroup(const std::string &name,
+                                 const std::vector<int> &geometryIds);
+  // Sorted, unique IDs of a list like "3, 7,12"; unparsable items are skipped
+  static std::vector<int> parseGeometryIds(const std::string &geometryID);
+  static std::string formatGeometryIds(const std::vector<int> &geometryIds);
   void addEdgeToGroup(int groupID, TopoEdge *edge);
   void addFaceToGroup(int groupID, TopoFace *face);
+  void clearEdgeGroup(int groupID); // Removes all members, keeps the group
+  void clearFaceGroup(int groupID);
   TopoEdgeGroup *getEdgeGroup(int id) const;
   TopoFaceGroup *getFaceGroup(int id) const;
   TopoEdgeGroup *getEdgeGroupByName(const std::string &name) const;
   TopoFaceGroup *getFaceGroupByName(const std::string &name) const;
+  // An edge or face may belong to several groups; the one with the lowest
+  // ID wins. Constant time, from the reverse indices below.
   TopoEdgeGroup *getGroupForEdge(int edgeId) const;
   TopoFaceGroup *getGroupForFace(int faceId) const;
   std::string getFaceGeometryID(int faceId) const;
@@ -108,6 +141,28 @@ public:
     return _edgeGroups;
   }
 
+  // Edit Tracking
+  // Edits made through Topology stamp the nodes, edges and faces they change
+  // with a new, larger revision. An entity whose stamp is above a revision
+  // seen earlier has changed since then. 0 means never stamped.
+  uint64_t getRevision() const { return _revision; }
+  uint64_t getNodeRevision(int id) const;
+  uint64_t getEdgeRevision(int id) const;
+  uint64_t getFaceRevision(int id) const;
+
+  // Memory
+  // Pools give back blocks as they empty, keeping one spare each;
+  // releaseUnusedMemory() gives back the spares too.
+  struct PoolStats {
+    ObjectPool<TopoNode>::Stats nodes;
+    ObjectPool<TopoEdge>::Stats edges;
+    ObjectPool<TopoFace>::Stats faces;
+    ObjectPool<TopoHalfEdge>::Stats halfEdges;
+    ObjectPool<DimensionChord>::Stats chords;
+  };
+  PoolStats getPoolStats() const;
+  void releaseUnusedMemory();
+
 private:
   int _nextId;
   int generateID();
@@ -118,6 +173,21 @@ private:
   buildHalfEdgeLoop(TopoFace *face, const std::vector<TopoEdge *> &edges);
   void removeEdgeFromChord(TopoEdge *edge);
 
+  // Vertex Star Helpers (nextOut rings, see TopoNode::outgoing())
+  void linkOutgoing(TopoHalfEdge *he);
+  void unlinkOutgoing(TopoHalfEdge *he);
+  void moveOutgoing(TopoNode *from, TopoNode *to); // Re-origins from's ring
+
+  // Group Membership Helpers
+  void removeEdgeFromGroups(TopoEdge *edge);
+  void removeFaceFromGroups(TopoFace *face);
+
+  // Edit Tracking Helpers
+  void touchNode(int id);
+  void touchEdge(int id);
+  void touchFace(int id);
+  void touchSubdivisions(TopoEdge *edge); // Edge and its chord's edges
+
   // Primary Storage (Owning Pools)
   ObjectPool<TopoNode> _nodePool;
   ObjectPool<TopoEdge> _edgePool;
@@ -125,14 +195,25 @@ private:
   ObjectPool<TopoHalfEdge> _halfEdgePool;
   ObjectPool<DimensionChord> _chordPool;
 
-  // ID Lookups (Non-owning)
-  std::map<int, TopoNode *> _nodes;
-  std::map<int, TopoEdge *> _edges;
-  std::map<int, TopoFace *> _faces;
-  std::map<std::pair<int, int>, TopoEdge *> _edgeLookup;
+  // ID Lookups (Non-owning); iteration is in storage order, not ID order
+  SlotMap<TopoNode> _nodes;
+  SlotMap<TopoEdge> _edges;
+  SlotMap<TopoFace> _faces;
+  FlatHashMap<TopoEdge *> _edgeLookup; // Node ID pair -> edge
 
   std::map<int, std::unique_ptr<TopoEdgeGroup>> _edgeGroups;
   std::map<int, std::unique_ptr<TopoFaceGroup>> _faceGroups;
+
+  // Reverse indices: member ID -> groups holding it, sorted by group ID.
+  // Entries are erased when their last group goes.
+  std::unordered_map<int, std::vector<TopoEdgeGroup *>> _edgeToGroups;
+  std::unordered_map<int, std::vector<TopoFaceGroup *>> _faceToGroups;
+
+  // Edit stamps (see getRevision())
+  uint64_t _revision = 0;
+  std::map<int, uint64_t> _nodeRevisions;
+  std::map<int, uint64_t> _edgeRevisions;
+  std::map<int, uint64_t> _faceRevisions;
 };
 
 #endif // TOPOLOGY_H
@@ -0,0 +1,119 @@
+#include "WarmStart.h"
+#include <algorithm>
+#include <gp_XYZ.hxx>
+
+namespace {
+
+// Position k (0 <= k <= n) along n old cells: cell index and fraction
+void locate(double k, int n, int &cell, double &t) {
+  cell = std::min((int)k, n - 1);
+  t = k - cell;
+}
+
+} // namespace
+
+std::vector<gp_Pnt> WarmStart::resampleEdge(const std::vector<gp_Pnt> &previous,
+                                            const gp_Pnt &start,
+                                            const gp_Pnt &end,
+                                            int subdivisions) {
+  const int n = (int)previous.size() - 1;
+  if (n < 1 || subdivisions < 1)
+    return {};
+  if (previous.front().SquareDistance(start) +
+          previous.back().SquareDistance(end) >
+      previous.front().SquareDistance(end) +
+          previous.back().SquareDistance(start))
+    return {};
+
+  const gp_XYZ moveStart = start.XYZ() - previous.front().XYZ();
+  const gp_XYZ moveEnd = end.XYZ() - previous.back().XYZ();
+  std::vector<gp_Pnt> points(subdivisions + 1);
+  for (int i = 0; i <= subdivisions; ++i) {
+    double s = (double)i / subdivisions;
+    int cell;
+    double t;
+    locate(s * n, n, cell, t);
+    gp_XYZ p = previous[cell].XYZ() * (1.0 - t) + previous[cell + 1].XYZ() * t;
+    points[i] = gp_Pnt(p + moveStart * (1.0 - s) + moveEnd * s);
+  }
+  points.front() = start;
+  points.back() = end;
+  return points;
+}
+
+bool WarmStart::resampleGrid(const StructuredGrid &previous,
+                             const std::vector<std::vector<gp_Pnt>> &boundaries,
+                             StructuredGrid &grid) {
+  if (previous.rows() < 2 || previous.cols() < 2 || boundaries.size() != 4)
+    return false;
+  const int M = (int)boundaries[0].size() - 1;
+  const int N = (int)boundaries[1].size() - 1;
+  if (M < 1 || N < 1 || (int)boundaries[2].size() != M + 1 ||
+      (int)boundaries[3].size() != N + 1)
+    return false;
+  const int Mo = previous.rows() - 1;
+  const int No = previous.cols() - 1;
+
+  // Each new corner must lie nearest the old corner in the same place;
+  // otherwise the face's loop starts elsewhere now
+  const gp_Pnt corners[4] = {boundaries[0][0], boundaries[0][M],
+                             boundaries[2][0], boundaries[2][M]};
+  const gp_Pnt oldCorners[4] = {previous.point(0, 0), previous.point(Mo, 0),
+                                previous.point(Mo, No), previous.point(0, No)};
+  for (int c = 0; c < 4; ++c) {
+    for (int o = 0; o < 4; ++o) {
+      if (o != c && corners[c].SquareDistance(oldCorners[o]) <
+                        corners[c].SquareDistance(oldCorners[c]))
+        return false;
+    }
+  }
+
+  // Bilinear in index space
+  grid.resize(M, N);
+  for (int i = 0; i <= M; ++i) {
+    int ci;
+    double ti;
+    locate((double)i * Mo / M, Mo, ci, ti);
+    for (int j = 0; j <= N; ++j) {
+      int cj;
+      double tj;
+      locate((double)j * No / N, No, cj, tj);
+      gp_XYZ p = previous.point(ci, cj).XYZ() * ((1.0 - ti) * (1.0 - tj)) +
+                 previous.point(ci + 1, cj).XYZ() * (ti * (1.0 - tj)) +
+                 previous.point(ci + 1, cj + 1).XYZ() * (ti * tj) +
+                 previous.point(ci, cj + 1).XYZ() * ((1.0 - ti) * tj);
+      grid.setPoint(i, j, gp_Pnt(p));
+    }
+  }
+
+  // Differences on the boundary, blended inwards (TFI)
+  auto boundaryMove = [&](int i, int j) -> gp_XYZ {
+    gp_Pnt target = j == 0   ? boundaries[0][i]
+                    : i == M ? boundaries[1][j]
+                    : j == N ? boundaries[2][M - i]
+                             : boundaries[3][N - j];
+    return target.XYZ() - grid.point(i, j).XYZ();
+  };
+  std::vector<gp_XYZ> bottom(M + 1), top(M + 1), left(N + 1), right(N + 1);
+  for (int i = 0; i <= M; ++i) {
+    bottom[i] = boundaryMove(i, 0);
+    top[i] = boundaryMove(i, N);
+  }
+  for (int j = 0; j <= N; ++j) {
+    left[j] = boundaryMove(0, j);
+    right[j] = boundaryMove(M, j);
+  }
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      double u = (double)i / M;
+      double v = (double)j / N;
+      gp_XYZ cornerMove = (1.0 - u) * (1.0 - v) * bottom[0] +
+                          u * (1.0 - v) * bottom[M] + u * v * top[M] +
+                          (1.0 - u) * v * top[0];
+      gp_XYZ move = (1.0 - v) * bottom[i] + v * top[i] + (1.0 - u) * left[j] +
+                    u * right[j] - cornerMove;
+      grid.setPoint(i, j, gp_Pnt(grid.point(i, j).XYZ() + move));
+    }
+  }
+  return true;
+}
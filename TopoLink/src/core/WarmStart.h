@@ -0,0 +1,48 @@
+#ifndef WARMSTART_H
+#define WARMSTART_H
+
+#include "StructuredGrid.h"
+#include <gp_Pnt.hxx>
+#include <vector>
+
+/**
+ * @brief Starting points for a solve taken from an earlier result.
+ *
+ * A smoothed result is usually much closer to the new solution than a fresh
+ * linear or transfinite interpolation, even after the boundary moved or the
+ * subdivisions changed. The old points are resampled in index space, which
+ * keeps their spacing, and then moved onto the new boundary.
+ */
+class WarmStart {
+public:
+  /**
+   * @brief Resamples an edge's earlier points onto subdivisions + 1 points,
+   * linearly between neighbouring old points.
+   *
+   * The moves of the two ends are blended linearly along the edge, so the
+   * result runs exactly from start to end.
+   * @return Empty if previous has fewer than two points or runs the other
+   * way
+   */
+  static std::vector<gp_Pnt> resampleEdge(const std::vector<gp_Pnt> &previous,
+                                          const gp_Pnt &start,
+                                          const gp_Pnt &end, int subdivisions);
+
+  /**
+   * @brief Resamples a face's earlier grid bilinearly onto the size given by
+   * the new boundaries and fits it to them.
+   *
+   * boundaries are the bottom, right, top and left sides in loop order, as
+   * Smoother builds them (the top and left run backwards). Every point moves
+   * by the transfinite interpolation of the differences on the boundary, so
+   * the boundary of grid matches them exactly. grid is resized, which
+   * clears its fixed flags.
+   * @return False, leaving grid alone, if previous is empty or its corners
+   * are not in the same order as the new ones
+   */
+  static bool resampleGrid(const StructuredGrid &previous,
+                           const std::vector<std::vector<gp_Pnt>> &boundaries,
+                           StructuredGrid &grid);
+};
+
+#endif // WARMSTART_H
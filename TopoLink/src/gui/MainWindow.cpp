@@ -17,6 +17,7 @@
 #include <QShortcut>
 #include <QVBoxLayout>
 #include <cstdio>
+#include <set>
 
 // OCCT Includes
 #include <AIS_ColoredShape.hxx>
@@ -155,17 +156,26 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
   connect(m_smootherPage, &SmootherPage::runSolverRequested, this,
           &MainWindow::onRunSolver);
+  connect(m_smootherPage, &SmootherPage::stopSolverRequested, this,
+          [this]() {
+            if (m_smootherPage->stopButton())
+              m_smootherPage->stopButton()->setEnabled(false);
+            m_smootherPage->setStatusText("Stopping...");
+            m_occView->stopEllipticSolver();
+          });
   connect(m_smootherPage, &SmootherPage::exportRequested, this,
           &MainWindow::onExportMesh);
 
   // Smoother Plotting Connections
   connect(
-      m_occView, &OccView::smootherIterationReported, this,
-      [this](int id, int iter, double error) {
-        if (m_smootherPage) {
+      m_occView, &OccView::smootherIterationsReported, this,
+      [this](const std::vector<ConvergenceTelemetry::Sample> &samples) {
+        if (m_smootherPage && !samples.empty()) {
           if (m_smootherPage->plot())
-            m_smootherPage->plot()->addPoint(id, iter, error);
+            m_smootherPage->plot()->addPoints(samples);
 
+          const ConvergenceTelemetry::Sample &s = samples.back();
+          int id = s.id, iter = s.iteration;
           QString msg =
               (id < 0)
                   ? QString("Smoothing Edge %1 (it %2)").arg(-id).arg(iter + 1)
@@ -178,9 +188,22 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     if (m_smootherPage) {
       if (m_smootherPage->runButton())
         m_smootherPage->runButton()->setEnabled(true);
+      if (m_smootherPage->stopButton())
+        m_smootherPage->stopButton()->setEnabled(false);
       m_smootherPage->setStatusText("");
     }
-    logMessage("Smoothing complete.");
+    Smoother *smoother = m_occView->getSmoother();
+    Smoother::RunStatus status =
+        smoother ? smoother->lastRunStatus() : Smoother::RunStatus::Finished;
+    if (status == Smoother::RunStatus::Cancelled)
+      logMessage("Smoothing cancelled; finished edges and faces are shown.");
+    else if (status == Smoother::RunStatus::OutOfTime)
+      logMessage("Smoothing stopped at the time budget; showing the best "
+                 "result so far.");
+    else
+      logMessage("Smoothing complete.");
+    if (smoother)
+      logRelaxationFactors(*smoother);
   });
 
   // Bottom Console Dock
@@ -497,6 +520,36 @@ MainWindow::~MainWindow() {
 
 void MainWindow::logMessage(const QString &msg) { m_console->append(msg); }
 
+void MainWindow::logRelaxationFactors(const Smoother &smoother) {
+  const std::map<int, double> &factors = smoother.getRelaxationFactors();
+  const Topology *topology = smoother.getTopology();
+  if (!topology)
+    return;
+
+  // A group's faces share its factor, so each group gets one entry
+  QStringList entries;
+  std::set<int> listed;
+  for (const auto &[groupId, group] : topology->getFaceGroups()) {
+    for (TopoFace *face : group->faces) {
+      auto it = factors.find(face->getID());
+      if (it == factors.end())
+        continue;
+      entries << QString("group %1 %2")
+                     .arg(QString::fromStdString(group->name))
+                     .arg(it->second, 0, 'f', 3);
+      for (TopoFace *member : group->faces)
+        listed.insert(member->getID());
+      break;
+    }
+  }
+  for (const auto &[id, omega] : factors) {
+    if (id > 0 && !listed.count(id)) // Negative keys are edges
+      entries << QString("face %1 %2").arg(id).arg(omega, 0, 'f', 3);
+  }
+  if (!entries.isEmpty())
+    logMessage("SOR relaxation factors: " + entries.join(", "));
+}
+
 void MainWindow::onSelectionModeChanged(int id) {
   if (m_occView) {
     m_occView->setSelectionMode(id);
@@ -748,8 +801,7 @@ void MainWindow::onUpdateTopologyGroups() {
           groupName, group.linkedGeometryGroup.toStdString());
     }
     // Update contents (brute force sync for now, clear and re-add)
-    // Core struct uses vector, so clear it
-    coreGroup->edges.clear();
+    m_topology->clearEdgeGroup(coreGroup->id);
     for (int id : group.ids) {
       TopoEdge *e = m_topology->getEdge(id);
       if (e) {
@@ -773,7 +825,7 @@ void MainWindow::onUpdateTopologyGroups() {
       coreGroup = m_topology->createFaceGroup(
           groupName, group.linkedGeometryGroup.toStdString());
     }
-    coreGroup->faces.clear();
+    m_topology->clearFaceGroup(coreGroup->id);
     for (int id : group.ids) {
       TopoFace *f = m_topology->getFace(id);
       if (f) {
@@ -1050,19 +1102,15 @@ void MainWindow::onRunSolver() {
 
     // 1. Sync Face Groups
     for (const auto &g : m_topologyPage->faceGroupModel()->groups()) {
-      QString geoIdsStr;
+      std::vector<int> geoIds;
       if (!g.linkedGeometryGroup.isEmpty()) {
         const GeometryGroup *gg =
             m_geometryPage->getFaceGroupByName(g.linkedGeometryGroup);
-        if (gg) {
-          QStringList sl;
-          for (int id : gg->ids)
-            sl << QString::number(id);
-          geoIdsStr = sl.join(",");
-        }
+        if (gg)
+          geoIds.assign(gg->ids.begin(), gg->ids.end());
       }
-      TopoFaceGroup *fg = m_topology->createFaceGroup(g.name.toStdString(),
-                                                      geoIdsStr.toStdString());
+      TopoFaceGroup *fg =
+          m_topology->createFaceGroup(g.name.toStdString(), geoIds);
       for (int fid : g.ids) {
         TopoFace *f = m_topology->getFace(fid);
         if (f)
@@ -1072,19 +1120,15 @@ void MainWindow::onRunSolver() {
 
     // 2. Sync Edge Groups
     for (const auto &g : m_topologyPage->edgeGroupModel()->groups()) {
-      QString geoIdsStr;
+      std::vector<int> geoIds;
       if (!g.linkedGeometryGroup.isEmpty()) {
         const GeometryGroup *gg =
             m_geometryPage->getEdgeGroupByName(g.linkedGeometryGroup);
-        if (gg) {
-          QStringList sl;
-          for (int id : gg->ids)
-            sl << QString::number(id);
-          geoIdsStr = sl.join(",");
-        }
+        if (gg)
+          geoIds.assign(gg->ids.begin(), gg->ids.end());
       }
-      TopoEdgeGroup *eg = m_topology->createEdgeGroup(g.name.toStdString(),
-                                                      geoIdsStr.toStdString());
+      TopoEdgeGroup *eg =
+          m_topology->createEdgeGroup(g.name.toStdString(), geoIds);
       for (int eid : g.ids) {
         TopoEdge *e = m_topology->getEdge(eid);
         if (e)
@@ -1096,6 +1140,8 @@ void MainWindow::onRunSolver() {
       m_smootherPage->plot()->clear();
     if (m_smootherPage->runButton())
       m_smootherPage->runButton()->setEnabled(false);
+    if (m_smootherPage->stopButton())
+      m_smootherPage->stopButton()->setEnabled(true);
 
     logMessage("Running elliptic grid smoother...");
     m_occView->runEllipticSolver(m_smootherPage->getConfig());
@@ -27,6 +27,8 @@ public:
 
   // Log message to console
   void logMessage(const QString &msg);
+  // Log the SOR factor each face and face group of the last run ended with
+  void logRelaxationFactors(const Smoother &smoother);
 
 private slots:
   void onImportStp(); // Slot for the menu action
@@ -2378,6 +2378,8 @@ void OccView::setShapeData(const TopoDS_Shape &shape,
   m_shape = shape;
   *m_faceMap = faceMap;
   *m_edgeMap = edgeMap;
+  if (m_smoother)
+    m_smoother->invalidate(); // Same map objects, new contents
 
   // Apply deflection settings to the interactive shape if it exists
   // We assume m_aisShape availability or it will be set later via setAisShape
@@ -2419,6 +2421,8 @@ void OccView::reset() {
   m_shape.Nullify();
   m_faceMap->Clear();
   m_edgeMap->Clear();
+  if (m_smoother)
+    m_smoother->invalidate();
 
   // 5. Update Viewer
   m_context->RemoveAll(Standard_True); // Ensure everything is gone
@@ -3394,13 +3398,24 @@ void OccView::runEllipticSolver(const SmootherConfig &config) {
   qDebug() << "OccView::runEllipticSolver: Starting smoother...";
   hideSmootherVisualization();
 
-  if (m_smoother) {
+  if (m_smoother && m_smoother->getTopology() != m_topologyModel) {
     m_smoother->deleteLater();
     m_smoother = nullptr;
   }
 
-  // Create Smoother on heap
-  m_smoother = new Smoother(m_topologyModel);
+  // Create Smoother on heap. It is kept across runs on the same model so its
+  // per-group caches (graph colourings) survive.
+  if (!m_smoother) {
+    m_smoother = new Smoother(m_topologyModel);
+  }
+  // Progress is polled rather than signalled: workers only write to their
+  // telemetry rings, and the GUI picks the samples up in batches
+  if (!m_telemetryTimer) {
+    m_telemetryTimer = new QTimer(this);
+    m_telemetryTimer->setInterval(33); // ~30 Hz
+    connect(m_telemetryTimer, &QTimer::timeout, this,
+            &OccView::drainSmootherTelemetry);
+  }
   m_smoother->setConfig(config);
   m_smoother->setGeometryMaps(m_faceMap, m_edgeMap);
 
@@ -3417,15 +3432,13 @@ void OccView::runEllipticSolver(const SmootherConfig &config) {
   }
   m_smoother->setConstraints(constraints);
 
-  // Connect progress signal
-  connect(m_smoother, &Smoother::iterationCompleted, this,
-          &OccView::smootherIterationReported);
-
   QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
   connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher]() {
     qDebug() << "OccView::runEllipticSolver: Background thread complete.";
+    m_telemetryTimer->stop();
     if (!m_smoother)
       return;
+    drainSmootherTelemetry(); // Whatever came in since the last tick
 
     // Visualize Results (Must be in main thread)
     const auto &edges = m_smoother->getSmoothedEdges();
@@ -3448,16 +3461,16 @@ void OccView::runEllipticSolver(const SmootherConfig &config) {
     const auto &faces = m_smoother->getSmoothedFaces();
     for (auto it = faces.begin(); it != faces.end(); ++it) {
       const auto &sf = it.value();
-      const auto &grid = sf.grid;
-      int M = grid.size() - 1;
-      if (M < 1)
+      const StructuredGrid &grid = sf.grid;
+      int M = grid.rows() - 1;
+      int N = grid.cols() - 1;
+      if (M < 1 || N < 1)
         continue;
-      int N = grid[0].size() - 1;
       Handle(Poly_Triangulation) triangulation =
           new Poly_Triangulation((M + 1) * (N + 1), 2 * M * N, Standard_False);
       for (int j = 0; j <= N; ++j) {
         for (int i = 0; i <= M; ++i)
-          triangulation->SetNode(j * (M + 1) + i + 1, grid[i][j]);
+          triangulation->SetNode(j * (M + 1) + i + 1, grid.point(i, j));
       }
       int triIdx = 1;
       for (int j = 0; j < N; ++j) {
@@ -3482,10 +3495,11 @@ void OccView::runEllipticSolver(const SmootherConfig &config) {
       Quantity_Color gridColor(Quantity_NOC_BLUE1);
       for (int i = 0; i <= M; ++i) {
         for (int j = 0; j < N; ++j) {
-          if (grid[i][j].SquareDistance(grid[i][j + 1]) > 1e-10) {
-            Handle(AIS_Line) line =
-                new AIS_Line(new Geom_CartesianPoint(grid[i][j]),
-                             new Geom_CartesianPoint(grid[i][j + 1]));
+          gp_Pnt p1 = grid.point(i, j);
+          gp_Pnt p2 = grid.point(i, j + 1);
+          if (p1.SquareDistance(p2) > 1e-10) {
+            Handle(AIS_Line) line = new AIS_Line(new Geom_CartesianPoint(p1),
+                                                 new Geom_CartesianPoint(p2));
             line->SetColor(gridColor);
             m_context->Display(line, Standard_False);
             m_smootherObjects.append(line);
@@ -3494,10 +3508,11 @@ void OccView::runEllipticSolver(const SmootherConfig &config) {
       }
       for (int j = 0; j <= N; ++j) {
         for (int i = 0; i < M; ++i) {
-          if (grid[i][j].SquareDistance(grid[i + 1][j]) > 1e-10) {
-            Handle(AIS_Line) line =
-                new AIS_Line(new Geom_CartesianPoint(grid[i][j]),
-                             new Geom_CartesianPoint(grid[i + 1][j]));
+          gp_Pnt p1 = grid.point(i, j);
+          gp_Pnt p2 = grid.point(i + 1, j);
+          if (p1.SquareDistance(p2) > 1e-10) {
+            Handle(AIS_Line) line = new AIS_Line(new Geom_CartesianPoint(p1),
+                                                 new Geom_CartesianPoint(p2));
             line->SetColor(gridColor);
             m_context->Display(line, Standard_False);
             m_smootherObjects.append(line);
@@ -3515,8 +3530,23 @@ void OccView::runEllipticSolver(const SmootherConfig &config) {
   });
 
   Smoother *s = m_smoother;
+  s->resetCancel(); // A Stop from here on applies to this run
   QFuture<void> future = QtConcurrent::run([s]() { s->run(); });
   watcher->setFuture(future);
+  m_telemetryTimer->start();
+}
+
+void OccView::drainSmootherTelemetry() {
+  if (!m_smoother)
+    return;
+  std::vector<ConvergenceTelemetry::Sample> samples;
+  if (m_smoother->telemetry().drain(samples) > 0)
+    emit smootherIterationsReported(samples);
+}
+
+void OccView::stopEllipticSolver() {
+  if (m_smoother)
+    m_smoother->cancel();
 }
 
 void OccView::onSplitEdgePreview(double t) {
@@ -13,6 +13,7 @@
 #include <QObject>
 #include <QPair>
 #include <QPushButton>
+#include <QTimer>
 #include <QWheelEvent>
 #include <QWidget>
 
@@ -25,6 +26,7 @@
 #include <gp_Dir.hxx>
 #include <gp_Pnt.hxx>
 
+#include "../core/ConvergenceTelemetry.h"
 #include "../core/SmootherConfig.h"
 
 class Topology;
@@ -133,6 +135,8 @@ public:
   void hideSmootherVisualization();
   void createTfiMesh(int faceId);
   void runEllipticSolver(const SmootherConfig &config);
+  /** @brief Asks a running smoother to stop; smootherFinished follows. */
+  void stopEllipticSolver();
   Smoother *getSmoother() const { return m_smoother; }
 
   // Topology Group Appearance
@@ -182,7 +186,9 @@ signals:
   void topologySelectionChanged();
   void workbenchRequested(int index);
 
-  void smootherIterationReported(int id, int iter, double error);
+  // Sweeps reported since the last signal, in batches of at most ~30 Hz
+  void smootherIterationsReported(
+      const std::vector<ConvergenceTelemetry::Sample> &samples);
   void smootherFinished();
 
 public slots:
@@ -308,4 +314,6 @@ private:
   Topology *m_topologyModel = nullptr;
   Smoother *m_smoother = nullptr;
   QList<Handle(AIS_InteractiveObject)> m_smootherObjects;
+  void drainSmootherTelemetry();
+  QTimer *m_telemetryTimer = nullptr; // Polls the smoother while it runs
 };
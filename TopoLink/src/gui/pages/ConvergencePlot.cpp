@@ -3,8 +3,97 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QStyleOption>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
+namespace {
+
+constexpr float kEmptyLo = std::numeric_limits<float>::infinity();
+constexpr float kEmptyHi = -std::numeric_limits<float>::infinity();
+
+// Widens a per-bucket min/max pair of arrays to hold bucket b
+void reserveBucket(QVector<float> &lo, QVector<float> &hi, int b) {
+  if (b < lo.size())
+    return;
+  int old = lo.size();
+  lo.resize(b + 1);
+  hi.resize(b + 1);
+  for (int k = old; k <= b; ++k) {
+    lo[k] = kEmptyLo;
+    hi[k] = kEmptyHi;
+  }
+}
+
+// Bucket k takes over buckets 2k and 2k + 1
+void mergeMinMax(QVector<float> &lo, QVector<float> &hi) {
+  int n = (lo.size() + 1) / 2;
+  for (int k = 0; k < n; ++k) {
+    int a = 2 * k, b = std::min(2 * k + 1, lo.size() - 1);
+    lo[k] = std::min(lo[a], lo[b]);
+    hi[k] = std::max(hi[a], hi[b]);
+  }
+  lo.resize(n);
+  hi.resize(n);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Distribution
+// -----------------------------------------------------------------------------
+ConvergencePlot::Distribution::Distribution()
+    : counts((size_t)kBuckets * kBins, 0), totals(kBuckets, 0) {}
+
+void ConvergencePlot::Distribution::add(int bucket, double logValue) {
+  int bin = (int)std::floor((logValue - kLogLow) * 10.0);
+  bin = std::min(std::max(bin, 0), kBins - 1);
+  counts[(size_t)bucket * kBins + bin]++;
+  totals[bucket]++;
+  reserveBucket(lo, hi, bucket);
+  lo[bucket] = std::min(lo[bucket], (float)logValue);
+  hi[bucket] = std::max(hi[bucket], (float)logValue);
+  dirty = true;
+}
+
+void ConvergencePlot::Distribution::mergePairs() {
+  for (int k = 0; k < kBuckets / 2; ++k) {
+    int *out = &counts[(size_t)k * kBins];
+    const int *a = &counts[(size_t)(2 * k) * kBins];
+    const int *b = &counts[(size_t)(2 * k + 1) * kBins];
+    for (int bin = 0; bin < kBins; ++bin)
+      out[bin] = a[bin] + b[bin];
+    totals[k] = totals[2 * k] + totals[2 * k + 1];
+  }
+  std::fill(counts.begin() + (size_t)(kBuckets / 2) * kBins, counts.end(), 0);
+  std::fill(totals.begin() + kBuckets / 2, totals.end(), 0);
+  mergeMinMax(lo, hi);
+  dirty = true;
+}
+
+void ConvergencePlot::Distribution::clear() {
+  std::fill(counts.begin(), counts.end(), 0);
+  std::fill(totals.begin(), totals.end(), 0);
+  lo.clear();
+  hi.clear();
+  dirty = true;
+}
+
+double ConvergencePlot::Distribution::quantile(int b, double q) const {
+  const int *row = &counts[(size_t)b * kBins];
+  const int rank = (int)std::ceil(q * totals[b]);
+  int seen = 0;
+  for (int bin = 0; bin < kBins; ++bin) {
+    seen += row[bin];
+    if (seen >= std::max(rank, 1))
+      return kLogLow + (bin + 0.5) / 10.0;
+  }
+  return kLogLow + (kBins - 0.5) / 10.0;
+}
+
+// -----------------------------------------------------------------------------
+// ConvergencePlot
+// -----------------------------------------------------------------------------
 ConvergencePlot::ConvergencePlot(QWidget *parent) : QWidget(parent) {
   setBackgroundRole(QPalette::Base);
   setAutoFillBackground(true);
@@ -12,6 +101,22 @@ ConvergencePlot::ConvergencePlot(QWidget *parent) : QWidget(parent) {
 }
 
 void ConvergencePlot::addPoint(int id, int iter, double value) {
+  append(id, iter, value);
+  update();
+}
+
+void ConvergencePlot::addPoints(
+    const std::vector<ConvergenceTelemetry::Sample> &samples) {
+  for (const ConvergenceTelemetry::Sample &s : samples)
+    append(s.id, s.iteration, s.error);
+  update();
+}
+
+void ConvergencePlot::append(int id, int iter, double value) {
+  if (!std::isfinite(value) || iter < 0)
+    return;
+  widenRange(iter);
+
   if (!m_series.contains(id)) {
     Series s;
     s.color = getColorForId(id);
@@ -19,96 +124,220 @@ void ConvergencePlot::addPoint(int id, int iter, double value) {
     m_series.insert(id, s);
   }
 
-  m_series[id].values.append(value);
+  // The y axis grows by whole decades so cached paths rarely go stale
+  const double logValue = std::log10(std::max(value, m_minValue));
+  if (logValue > m_logMax) {
+    m_logMax = std::ceil(logValue);
+    invalidate();
+  }
 
-  if (iter > m_maxIter)
-    m_maxIter = iter;
-  if (value > m_maxValue)
-    m_maxValue = value;
-  // We don't update m_minValue here to keep the log scale stable-ish
+  const int bucket = iter / m_bucketWidth;
+  Series &s = m_series[id];
+  reserveBucket(s.lo, s.hi, bucket);
+  s.lo[bucket] = std::min(s.lo[bucket], (float)logValue);
+  s.hi[bucket] = std::max(s.hi[bucket], (float)logValue);
+  s.pathEpoch = -1;
 
-  update();
+  (id < 0 ? m_edges : m_faces).add(bucket, logValue);
+}
+
+void ConvergencePlot::widenRange(int iter) {
+  bool widened = false;
+  while (iter >= kBuckets * m_bucketWidth) {
+    for (auto it = m_series.begin(); it != m_series.end(); ++it)
+      mergeMinMax(it->lo, it->hi);
+    m_edges.mergePairs();
+    m_faces.mergePairs();
+    m_bucketWidth *= 2;
+    widened = true;
+  }
+  if (widened)
+    invalidate();
+}
+
+void ConvergencePlot::invalidate() {
+  ++m_epoch;
+  m_edges.dirty = true;
+  m_faces.dirty = true;
 }
 
 void ConvergencePlot::clear() {
   m_series.clear();
-  m_maxIter = 0;
-  m_maxValue = 1.0;
+  m_edges.clear();
+  m_faces.clear();
+  m_bucketWidth = 1;
+  m_logMax = 0.0;
+  invalidate();
+  update();
+}
+
+void ConvergencePlot::setDisplayMode(DisplayMode mode) {
+  if (mode == m_mode)
+    return;
+  m_mode = mode;
   update();
 }
 
+void ConvergencePlot::resizeEvent(QResizeEvent *event) {
+  invalidate();
+  QWidget::resizeEvent(event);
+}
+
 QColor ConvergencePlot::getColorForId(int id) {
   if (id < 0)
     return QColor(0, 120, 215); // Consistent Blue
   return QColor(0, 150, 0);     // Consistent Green
 }
 
+QRectF ConvergencePlot::plotRect() const {
+  return QRectF(rect().adjusted(45, 10, -10, -35));
+}
+
+QPointF ConvergencePlot::toScreen(const QRectF &rect, double x,
+                                  double logValue) const {
+  const double logMin = std::log10(m_minValue);
+  double xRel = x / kBuckets;
+  double yRel = (logValue - logMin) / (m_logMax - logMin);
+  return QPointF(rect.left() + xRel * rect.width(),
+                 rect.bottom() - yRel * rect.height());
+}
+
 void ConvergencePlot::paintEvent(QPaintEvent *) {
   QPainter painter(this);
   painter.setRenderHint(QPainter::Antialiasing);
 
-  QRect plotRect = rect().adjusted(45, 10, -10, -35);
+  const QRectF plotArea = plotRect();
 
   // Draw Legend
   painter.setPen(QColor(0, 120, 215));
-  painter.drawText(plotRect.left() + 5, plotRect.bottom() + 20, "Edges (Blue)");
+  painter.drawText(QPointF(plotArea.left() + 5, plotArea.bottom() + 20),
+                   "Edges (Blue)");
   painter.setPen(QColor(0, 150, 0));
-  painter.drawText(plotRect.left() + 100, plotRect.bottom() + 20,
+  painter.drawText(QPointF(plotArea.left() + 100, plotArea.bottom() + 20),
                    "Faces (Green)");
 
   // Draw background
-  painter.fillRect(plotRect, Qt::black);
+  painter.fillRect(plotArea, Qt::black);
 
   if (m_series.isEmpty()) {
     painter.setPen(Qt::gray);
-    painter.drawText(plotRect, Qt::AlignCenter, "Waiting for data...");
+    painter.drawText(plotArea, Qt::AlignCenter, "Waiting for data...");
     return;
   }
 
-  // Draw Grid (Log Scale Y)
+  // Draw Grid (Log Scale Y), one line per decade
   painter.setPen(QColor(60, 60, 60));
-  double logMin = std::log10(m_minValue);
-  double logMax = std::log10(std::max(m_maxValue, 1.1 * m_minValue));
-
-  for (double power = std::floor(logMin); power <= std::ceil(logMax);
-       power += 1.0) {
-    double val = std::pow(10, power);
-    double yRel = (power - logMin) / (logMax - logMin);
-    int y = plotRect.bottom() - yRel * plotRect.height();
-
-    if (y >= plotRect.top() && y <= plotRect.bottom()) {
-      painter.drawLine(plotRect.left(), y, plotRect.right(), y);
-      painter.drawText(5, y + 5, QString("1e%1").arg(power));
+  const double logMin = std::log10(m_minValue);
+  for (double power = std::floor(logMin); power <= m_logMax; power += 1.0) {
+    QPointF p = toScreen(plotArea, 0.0, power);
+    if (p.y() >= plotArea.top() && p.y() <= plotArea.bottom()) {
+      painter.drawLine(QPointF(plotArea.left(), p.y()),
+                       QPointF(plotArea.right(), p.y()));
+      painter.drawText(QPointF(5, p.y() + 5), QString("1e%1").arg(power));
     }
   }
 
-  // Draw Series
+  painter.save();
+  painter.setClipRect(plotArea);
+  bool bands = m_mode == DisplayMode::Bands ||
+               (m_mode == DisplayMode::Auto && m_series.size() > kMaxLines);
+  if (bands) {
+    drawBands(painter, plotArea, m_edges, getColorForId(-1));
+    drawBands(painter, plotArea, m_faces, getColorForId(1));
+  } else {
+    drawLines(painter, plotArea);
+  }
+  painter.restore();
+
+  // Draw axis labels
+  painter.setPen(Qt::white);
+  painter.drawText(rect().adjusted(0, 0, 0, -5),
+                   Qt::AlignBottom | Qt::AlignHCenter,
+                   QString("Iterations (0 - %1%2)")
+                       .arg(kBuckets * m_bucketWidth)
+                       .arg(bands ? ", median and 10-90% band" : ""));
+}
+
+void ConvergencePlot::drawLines(QPainter &painter, const QRectF &rect) {
   for (auto it = m_series.begin(); it != m_series.end(); ++it) {
-    const Series &s = it.value();
-    if (s.values.isEmpty())
+    Series &s = it.value();
+    if (s.lo.isEmpty())
       continue;
 
-    painter.setPen(QPen(s.color, 1.5));
-    QPainterPath path;
+    // Min/max decimation: every bucket is drawn as the vertical span of its
+    // values, joined to the next bucket
+    if (s.pathEpoch != m_epoch) {
+      s.path = QPainterPath();
+      bool started = false;
+      for (int b = 0; b < s.lo.size(); ++b) {
+        if (s.lo[b] > s.hi[b])
+          continue;
+        QPointF top = toScreen(rect, b + 0.5, s.hi[b]);
+        QPointF bottom = toScreen(rect, b + 0.5, s.lo[b]);
+        if (!started)
+          s.path.moveTo(top);
+        else
+          s.path.lineTo(top);
+        if (s.lo[b] < s.hi[b])
+          s.path.lineTo(bottom);
+        started = true;
+      }
+      s.pathEpoch = m_epoch;
+    }
 
-    for (int i = 0; i < s.values.size(); ++i) {
-      double xRel = m_maxIter > 0 ? (double)i / m_maxIter : 0.0;
-      double val = std::max(s.values[i], m_minValue);
-      double yRel = (std::log10(val) - logMin) / (logMax - logMin);
+    painter.setPen(QPen(s.color, 1.5));
+    painter.drawPath(s.path);
+  }
+}
 
-      QPoint p(plotRect.left() + xRel * plotRect.width(),
-               plotRect.bottom() - yRel * plotRect.height());
+void ConvergencePlot::drawBands(QPainter &painter, const QRectF &rect,
+                                Distribution &dist, const QColor &color) {
+  if (dist.lo.isEmpty())
+    return;
 
-      if (i == 0)
-        path.moveTo(p);
+  if (dist.dirty || dist.epoch != m_epoch) {
+    QPolygonF envTop, envBottom, bandTop, bandBottom;
+    dist.median = QPainterPath();
+    for (int b = 0; b < dist.lo.size(); ++b) {
+      if (dist.totals[b] == 0)
+        continue;
+      const double x = b + 0.5;
+      envTop << toScreen(rect, x, dist.hi[b]);
+      envBottom << toScreen(rect, x, dist.lo[b]);
+      // Bin centres can fall outside the exact extremes; keep them inside
+      auto clampToEnvelope = [&](double v) {
+        return std::min<double>(std::max<double>(v, dist.lo[b]), dist.hi[b]);
+      };
+      bandTop << toScreen(rect, x, clampToEnvelope(dist.quantile(b, 0.9)));
+      bandBottom << toScreen(rect, x,
+                             clampToEnvelope(dist.quantile(b, 0.1)));
+      QPointF median =
+          toScreen(rect, x, clampToEnvelope(dist.quantile(b, 0.5)));
+      if (dist.median.elementCount() == 0)
+        dist.median.moveTo(median);
       else
-        path.lineTo(p);
+        dist.median.lineTo(median);
     }
-    painter.drawPath(path);
+    std::reverse(envBottom.begin(), envBottom.end());
+    std::reverse(bandBottom.begin(), bandBottom.end());
+    dist.envelope = envTop;
+    dist.envelope << envBottom;
+    dist.band = bandTop;
+    dist.band << bandBottom;
+    dist.dirty = false;
+    dist.epoch = m_epoch;
   }
 
-  // Draw axis labels
-  painter.setPen(Qt::white);
-  painter.drawText(rect().adjusted(0, 0, 0, -5),
-                   Qt::AlignBottom | Qt::AlignHCenter, "Iterations");
+  QColor envelopeColor = color;
+  envelopeColor.setAlpha(60);
+  QColor bandColor = color;
+  bandColor.setAlpha(130);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(envelopeColor);
+  painter.drawPolygon(dist.envelope);
+  painter.setBrush(bandColor);
+  painter.drawPolygon(dist.band);
+  painter.setBrush(Qt::NoBrush);
+  painter.setPen(QPen(color.lighter(150), 1.5));
+  painter.drawPath(dist.median);
 }
@@ -1,31 +1,102 @@
 #pragma once
 
+#include "../../core/ConvergenceTelemetry.h"
 #include <QColor>
 #include <QMap>
+#include <QPainterPath>
+#include <QPolygonF>
 #include <QVector>
 #include <QWidget>
 
+class QPainter;
+
+/**
+ * @brief Log-scale plot of solver errors against iterations.
+ *
+ * Samples are binned on arrival into kBuckets iteration buckets spanning
+ * the x range, which doubles (merging bucket pairs) whenever an iteration
+ * falls beyond it. Each series keeps the minimum and maximum of every
+ * bucket, so a line costs a fixed number of points however long the run.
+ * Lines are cached as paths and rebuilt only when their series gets new
+ * samples or the scales change.
+ *
+ * With many series, lines are replaced by bands per kind (edges, faces):
+ * the min/max envelope, the 10th to 90th percentile and the median of the
+ * errors in each bucket, from a per-bucket histogram of log10(error).
+ */
 class ConvergencePlot : public QWidget {
   Q_OBJECT
 public:
+  enum class DisplayMode {
+    Auto,  // Lines up to kMaxLines series, bands beyond
+    Lines, // One line per edge or face
+    Bands  // Envelope and percentile band per kind
+  };
+
+  static constexpr int kBuckets = 512;
+  static constexpr int kMaxLines = 64;
+
   explicit ConvergencePlot(QWidget *parent = nullptr);
 
   void addPoint(int id, int iter, double value);
+  /** @brief Adds a batch of points with a single repaint. */
+  void addPoints(const std::vector<ConvergenceTelemetry::Sample> &samples);
   void clear();
 
+  void setDisplayMode(DisplayMode mode);
+  DisplayMode displayMode() const { return m_mode; }
+
 protected:
   void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
 
 private:
   struct Series {
-    QVector<double> values;
+    QVector<float> lo, hi; // Per bucket; lo > hi marks an empty bucket
     QColor color;
     QString label;
+    QPainterPath path; // Cached line, valid while pathEpoch == m_epoch
+    int pathEpoch = -1;
+  };
+
+  // Errors of all series of one kind, per bucket
+  struct Distribution {
+    static constexpr int kBins = 240; // 0.1 decade each
+    static constexpr double kLogLow = -16.0;
+
+    std::vector<int> counts; // kBuckets x kBins
+    std::vector<int> totals; // kBuckets
+    QVector<float> lo, hi;
+    bool dirty = true;
+    QPolygonF envelope, band; // Cached, valid while !dirty
+    QPainterPath median;
+    int epoch = -1;
+
+    Distribution();
+    void add(int bucket, double logValue);
+    void mergePairs();
+    void clear();
+    // log10 of the q-quantile in bucket b (bin centre)
+    double quantile(int b, double q) const;
   };
 
+  void append(int id, int iter, double value);
+  void widenRange(int iter);
+  void invalidate(); // Scales changed: every cached path is stale
+
+  QRectF plotRect() const;
+  QPointF toScreen(const QRectF &rect, double x, double logValue) const;
+  void drawLines(QPainter &painter, const QRectF &rect);
+  void drawBands(QPainter &painter, const QRectF &rect, Distribution &dist,
+                 const QColor &color);
+
   QMap<int, Series> m_series;
-  int m_maxIter = 0;
-  double m_maxValue = 1.0;
+  Distribution m_edges, m_faces;
+  DisplayMode m_mode = DisplayMode::Auto;
+
+  int m_bucketWidth = 1; // Iterations per bucket, a power of two
+  int m_epoch = 0;       // Bumped whenever the mapping to pixels changes
+  double m_logMax = 0.0; // Top of the y axis, whole decades only
   double m_minValue = 1e-10;
 
   QColor getColorForId(int id);
@@ -1,6 +1,7 @@
 #include "SmootherPage.h"
 #include "ConvergencePlot.h"
 #include <QPushButton>
+#include <cmath>
 
 SmootherPage::SmootherPage(QWidget *parent) : QWidget(parent) { setupUI(); }
 
@@ -44,6 +45,7 @@ void SmootherPage::setupUI() {
   m_edgeRelax = new QDoubleSpinBox();
   m_edgeRelax->setRange(0.0, 1.0);
   m_edgeRelax->setSingleStep(0.05);
+  m_edgeRelax->setSpecialValueText("Auto"); // Shown at the minimum
   m_edgeRelax->setValue(0.9);
   m_edgeBCRelax = new QDoubleSpinBox();
   m_edgeBCRelax->setRange(0.0, 1.0);
@@ -60,16 +62,31 @@ void SmootherPage::setupUI() {
   m_faceIters->setRange(1, 10000);
   m_faceIters->setValue(1000);
   m_faceRelax = new QDoubleSpinBox();
-  m_faceRelax->setRange(0.0, 1.0);
+  m_faceRelax->setRange(0.0, 1.95);
   m_faceRelax->setSingleStep(0.05);
+  m_faceRelax->setSpecialValueText("Auto"); // Shown at the minimum
   m_faceRelax->setValue(0.9);
   m_faceBCRelax = new QDoubleSpinBox();
   m_faceBCRelax->setRange(0.0, 1.0);
   m_faceBCRelax->setSingleStep(0.05);
   m_faceBCRelax->setValue(0.1);
+  m_faceParallel = new QCheckBox("Colour sweeps (multi-threaded)");
+  m_faceParallel->setChecked(false);
+  m_faceMethod = new QComboBox();
+  m_faceMethod->addItem("SOR");
+  m_faceMethod->addItem("Multigrid");
+  m_faceMethod->addItem("SOR (surface UV)");
+  m_groupSolver = new QComboBox();
+  m_groupSolver->addItem("Relaxation");
+  m_groupSolver->addItem("PCG (Jacobi)");
+  m_groupSolver->addItem("PCG (IC0)");
+  m_groupSolver->addItem("PCG (AMG)");
+  faceLayout->addRow("Method:", m_faceMethod);
+  faceLayout->addRow("Group Method:", m_groupSolver);
   faceLayout->addRow("Iterations:", m_faceIters);
   faceLayout->addRow("Relaxation:", m_faceRelax);
   faceLayout->addRow("BC Relaxation:", m_faceBCRelax);
+  faceLayout->addRow("Ordering:", m_faceParallel);
   configLayout->addWidget(faceGroup);
 
   QGroupBox *miscGroup = new QGroupBox("Global parameters");
@@ -81,16 +98,49 @@ void SmootherPage::setupUI() {
   m_growthRateRelax->setRange(0.0, 0.1);
   m_growthRateRelax->setDecimals(4);
   m_growthRateRelax->setValue(0.002);
+  // Sweeps per projection pass: starting value and adaptive upper limit
   m_subIters = new QSpinBox();
-  m_subIters->setRange(1, 16);
-  m_subIters->setValue(4);
+  m_subIters->setRange(1, 100);
+  m_subIters->setValue(1);
+  m_subIters->setToolTip("Most sweeps between two projections; 1 projects "
+                         "every point as soon as it moves");
   m_projFreq = new QSpinBox();
   m_projFreq->setRange(1, 100);
   m_projFreq->setValue(1);
+  m_projFreq->setToolTip("Sweeps between projections to start with (PCG "
+                         "steps between projections for face groups)");
   miscLayout->addRow("Singularity Relax:", m_singularityRelax);
   miscLayout->addRow("Growth Rate Relax:", m_growthRateRelax);
-  miscLayout->addRow("Sub-iterations:", m_subIters);
-  miscLayout->addRow("Proj. Frequency:", m_projFreq);
+  miscLayout->addRow("Proj. Interval:", m_projFreq);
+  miscLayout->addRow("Max Proj. Interval:", m_subIters);
+  m_incremental = new QCheckBox("Re-solve only what changed");
+  m_incremental->setChecked(false);
+  m_incremental->setToolTip("Keep the results of edges and faces the "
+                            "topology edits since the last run did not "
+                            "touch");
+  miscLayout->addRow("Updates:", m_incremental);
+  m_warmStart = new QCheckBox("Start from the last result");
+  m_warmStart->setChecked(false);
+  m_warmStart->setToolTip("Resample the previous grids onto the current "
+                          "subdivisions instead of interpolating anew");
+  miscLayout->addRow("Warm Start:", m_warmStart);
+  m_warmStepTolerance = new QSpinBox(); // Decimal exponent
+  m_warmStepTolerance->setRange(3, 15);
+  m_warmStepTolerance->setPrefix("1e-");
+  m_warmStepTolerance->setValue(6);
+  m_warmStepTolerance->setToolTip(
+      "Warm-started solves stop once a sweep moves no point further than "
+      "this fraction of the edge, face or group size");
+  miscLayout->addRow("Warm Step Tol.:", m_warmStepTolerance);
+  m_timeBudget = new QDoubleSpinBox(); // Seconds
+  m_timeBudget->setRange(0.0, 3600.0);
+  m_timeBudget->setDecimals(1);
+  m_timeBudget->setSuffix(" s");
+  m_timeBudget->setSpecialValueText("Unlimited"); // Shown at the minimum
+  m_timeBudget->setValue(0.0);
+  m_timeBudget->setToolTip("Stop the run after this long and keep the best "
+                           "result so far");
+  miscLayout->addRow("Time Budget:", m_timeBudget);
   configLayout->addWidget(miscGroup);
 
   m_runBtn = new QPushButton("Run Solver");
@@ -99,6 +149,13 @@ void SmootherPage::setupUI() {
       "bold; padding: 10px; border-radius: 4px;");
   configLayout->addWidget(m_runBtn);
 
+  m_stopBtn = new QPushButton("Stop");
+  m_stopBtn->setStyleSheet(
+      "background-color: #d9534f; color: white; font-weight: "
+      "bold; padding: 10px; border-radius: 4px;");
+  m_stopBtn->setEnabled(false); // Only while a run is in progress
+  configLayout->addWidget(m_stopBtn);
+
   m_exportBtn = new QPushButton("Export Mesh");
   m_exportBtn->setStyleSheet(
       "background-color: #28a745; color: white; font-weight: "
@@ -115,7 +172,22 @@ void SmootherPage::setupUI() {
   plotLayout->setContentsMargins(5, 5, 5, 5);
 
   m_plot = new ConvergencePlot(this);
+  QComboBox *plotMode = new QComboBox();
+  plotMode->addItem("Auto");
+  plotMode->addItem("Lines");
+  plotMode->addItem("Bands");
+  plotMode->setToolTip("Bands show the spread of all edges and faces "
+                       "instead of one line each; Auto switches to them "
+                       "for large models");
+  QFormLayout *plotOptions = new QFormLayout();
+  plotOptions->addRow("Display:", plotMode);
+  plotLayout->addLayout(plotOptions);
   plotLayout->addWidget(m_plot);
+  connect(plotMode, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+          [this](int index) {
+            m_plot->setDisplayMode(
+                static_cast<ConvergencePlot::DisplayMode>(index));
+          });
 
   m_tabWidget->addTab(plotTab, "Convergence Plot");
 
@@ -123,6 +195,8 @@ void SmootherPage::setupUI() {
 
   connect(m_runBtn, &QPushButton::clicked, this,
           &SmootherPage::runSolverRequested);
+  connect(m_stopBtn, &QPushButton::clicked, this,
+          &SmootherPage::stopSolverRequested);
   connect(m_exportBtn, &QPushButton::clicked, this,
           &SmootherPage::exportRequested);
 }
@@ -141,13 +215,24 @@ SmootherConfig SmootherPage::getConfig() const {
   SmootherConfig cfg;
   cfg.edgeIters = m_edgeIters->value();
   cfg.edgeRelax = m_edgeRelax->value();
+  cfg.edgeAutoRelax = m_edgeRelax->value() == m_edgeRelax->minimum();
   cfg.edgeBCRelax = m_edgeBCRelax->value();
   cfg.faceIters = m_faceIters->value();
   cfg.faceRelax = m_faceRelax->value();
+  cfg.faceAutoRelax = m_faceRelax->value() == m_faceRelax->minimum();
   cfg.faceBCRelax = m_faceBCRelax->value();
+  cfg.faceParallel = m_faceParallel->isChecked();
+  cfg.faceMultigrid = m_faceMethod->currentIndex() == 1;
+  cfg.faceParametric = m_faceMethod->currentIndex() == 2;
+  cfg.groupMethod =
+      static_cast<SmootherConfig::GroupMethod>(m_groupSolver->currentIndex());
   cfg.singularityRelax = m_singularityRelax->value();
   cfg.growthRateRelax = m_growthRateRelax->value();
   cfg.subIters = m_subIters->value();
   cfg.projFreq = m_projFreq->value();
+  cfg.incremental = m_incremental->isChecked();
+  cfg.warmStart = m_warmStart->isChecked();
+  cfg.warmStepTolerance = std::pow(10.0, -m_warmStepTolerance->value());
+  cfg.timeBudget = m_timeBudget->value();
   return cfg;
 }
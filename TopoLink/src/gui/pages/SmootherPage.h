@@ -1,5 +1,7 @@
 #pragma once
 #include "../../core/SmootherConfig.h"
+#include <QCheckBox>
+#include <QComboBox>
 #include <QDoubleSpinBox>
 #include <QFormLayout>
 #include <QGroupBox>
@@ -21,10 +23,12 @@ public:
 
   ConvergencePlot *plot() const { return m_plot; }
   QPushButton *runButton() const { return m_runBtn; }
+  QPushButton *stopButton() const { return m_stopBtn; }
   void setStatusText(const QString &text);
 
 signals:
   void runSolverRequested();
+  void stopSolverRequested();
   void exportRequested();
 
 public slots:
@@ -37,6 +41,7 @@ private:
   QTabWidget *m_tabWidget;
   ConvergencePlot *m_plot;
   QPushButton *m_runBtn;
+  QPushButton *m_stopBtn;
   QPushButton *m_exportBtn;
   QLabel *m_statusLabel;
 
@@ -46,8 +51,15 @@ private:
   QSpinBox *m_faceIters;
   QDoubleSpinBox *m_faceRelax;
   QDoubleSpinBox *m_faceBCRelax;
+  QCheckBox *m_faceParallel;
+  QComboBox *m_faceMethod;
+  QComboBox *m_groupSolver;
   QDoubleSpinBox *m_singularityRelax;
   QDoubleSpinBox *m_growthRateRelax;
   QSpinBox *m_subIters;
   QSpinBox *m_projFreq;
+  QCheckBox *m_incremental;
+  QCheckBox *m_warmStart;
+  QSpinBox *m_warmStepTolerance;
+  QDoubleSpinBox *m_timeBudget;
 };
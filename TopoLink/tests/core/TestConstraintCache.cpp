@@ -0,0 +1,62 @@
+#include "ConstraintCache.h"
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <gtest/gtest.h>
+
+class ConstraintCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    TopoDS_Shape box = BRepPrimAPI_MakeBox(1.0, 2.0, 3.0).Shape();
+    TopExp::MapShapes(box, TopAbs_FACE, faceMap);
+    TopExp::MapShapes(box, TopAbs_EDGE, edgeMap);
+    cache.setGeometryMaps(&faceMap, &edgeMap);
+  }
+
+  TopTools_IndexedMapOfShape faceMap;
+  TopTools_IndexedMapOfShape edgeMap;
+  ConstraintCache cache;
+};
+
+TEST_F(ConstraintCacheTest, PermutedAndRepeatedIdsShareOneTarget) {
+  ConstraintCache::TargetPtr first = cache.find(QList<int>({3, 1}), false);
+  ASSERT_NE(first, nullptr);
+  EXPECT_FALSE(first->isNull());
+  EXPECT_EQ(cache.find(QList<int>({1, 3}), false), first);
+  EXPECT_EQ(cache.find(QList<int>({3, 1, 3, 1}), false), first);
+  EXPECT_EQ(cache.find(QList<int>({1, 1, 3}), false), first);
+  EXPECT_EQ(cache.stats().misses, 1);
+  EXPECT_EQ(cache.stats().hits, 3);
+
+  // The same IDs on edges are a different constraint
+  ConstraintCache::TargetPtr edges = cache.find(QList<int>({1, 3}), true);
+  ASSERT_NE(edges, nullptr);
+  EXPECT_NE(edges, first);
+}
+
+TEST_F(ConstraintCacheTest, UnknownIdsGiveNull) {
+  EXPECT_EQ(cache.find(QList<int>(), false), nullptr);
+  EXPECT_EQ(cache.find(QList<int>({0, 99}), false), nullptr);
+  EXPECT_EQ(cache.find(QList<int>({-1}), true), nullptr);
+  // Null results are cached like any other
+  EXPECT_EQ(cache.find(QList<int>({99, 0}), false), nullptr);
+  EXPECT_EQ(cache.stats().hits, 1);
+
+  // IDs that name no shape are ignored when others do
+  EXPECT_NE(cache.find(QList<int>({2, 99}), false), nullptr);
+}
+
+TEST_F(ConstraintCacheTest, ClearDropsEntriesAndCounts) {
+  ConstraintCache::TargetPtr before = cache.find(QList<int>({2}), false);
+  cache.find(QList<int>({2}), false);
+  cache.clear();
+  EXPECT_EQ(cache.stats().hits, 0);
+  EXPECT_EQ(cache.stats().misses, 0);
+
+  // Held targets stay usable; the next lookup builds a new one
+  ConstraintCache::TargetPtr after = cache.find(QList<int>({2}), false);
+  ASSERT_NE(after, nullptr);
+  EXPECT_NE(after, before);
+  EXPECT_FALSE(before->isNull());
+  EXPECT_EQ(cache.stats().misses, 1);
+}
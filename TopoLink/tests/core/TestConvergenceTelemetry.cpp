@@ -0,0 +1,56 @@
+#include "ConvergenceTelemetry.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <map>
+#include <thread>
+
+TEST(ConvergenceTelemetryTest, DrainsConcurrentProducersInOrder) {
+  const int producers = 4, perProducer = 20000;
+  ConvergenceTelemetry telemetry(256); // Small, so some samples drop
+  std::atomic<int> running{producers};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < producers; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int it = 0; it < perProducer; ++it)
+        telemetry.push({t, it, 1.0 / (it + 1)});
+      --running;
+    });
+  }
+
+  // Drain while they push, then once more after they are done
+  std::vector<ConvergenceTelemetry::Sample> samples;
+  while (running > 0)
+    telemetry.drain(samples);
+  for (std::thread &thread : threads)
+    thread.join();
+  telemetry.drain(samples);
+
+  // Nothing lost but the counted drops, and each producer's samples keep
+  // their order
+  EXPECT_EQ(samples.size() + telemetry.dropped(),
+            (size_t)producers * perProducer);
+  std::map<int, int> last;
+  for (const auto &s : samples) {
+    auto it = last.find(s.id);
+    if (it != last.end()) {
+      EXPECT_GT(s.iteration, it->second);
+    }
+    last[s.id] = s.iteration;
+    EXPECT_DOUBLE_EQ(s.error, 1.0 / (s.iteration + 1));
+  }
+}
+
+TEST(ConvergenceTelemetryTest, DropsWhenFullUntilDrained) {
+  ConvergenceTelemetry telemetry(5); // Rounded up to 8
+  for (int it = 0; it < 8; ++it)
+    EXPECT_TRUE(telemetry.push({1, it, 0.0}));
+  EXPECT_FALSE(telemetry.push({1, 8, 0.0}));
+  EXPECT_EQ(telemetry.dropped(), 1u);
+
+  std::vector<ConvergenceTelemetry::Sample> samples;
+  EXPECT_EQ(telemetry.drain(samples), 8);
+  EXPECT_EQ(samples.back().iteration, 7);
+  EXPECT_TRUE(telemetry.push({1, 9, 0.0}));
+  EXPECT_EQ(telemetry.drain(samples), 1);
+  EXPECT_EQ(samples.back().iteration, 9);
+}
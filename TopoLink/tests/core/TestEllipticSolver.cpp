@@ -0,0 +1,653 @@
+#include "CancelToken.h"
+#include "EllipticSolver.h"
+#include "FastPoissonSolver.h"
+#include "MultigridSolver.h"
+#include "ProjectionSchedule.h"
+#include "RelaxationControl.h"
+#include "StencilKernels.h"
+#include "StructuredGrid.h"
+#include "WarmStart.h"
+#include <atomic>
+#include <cmath>
+#include <gp_Pnt.hxx>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Builds an (M+1)x(N+1) grid on a bent rectangle with a perturbed interior
+void makeGrid(int M, int N, std::vector<std::vector<gp_Pnt>> &grid,
+              std::vector<std::vector<bool>> &isFixed) {
+  grid.assign(M + 1, std::vector<gp_Pnt>(N + 1));
+  isFixed.assign(M + 1, std::vector<bool>(N + 1, false));
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      double u = (double)i / M;
+      double v = (double)j / N;
+      bool boundary = (i == 0 || i == M || j == 0 || j == N);
+      double wobble = boundary ? 0.0 : 0.05 * ((i * 7 + j * 3) % 5);
+      grid[i][j] = gp_Pnt(u + wobble, v - wobble, u * v);
+      isFixed[i][j] = boundary;
+    }
+  }
+}
+
+// Quarter cylinder of radius 2, parameterised by angle u and height v
+constexpr double kCylinderRadius = 2.0;
+constexpr double kCylinderAngle = M_PI / 2;
+
+void cylinderSurface(double &u, double &v, gp_Pnt &p, gp_Vec &du,
+                     gp_Vec &dv) {
+  const double R = kCylinderRadius;
+  u = std::min(std::max(u, 0.0), kCylinderAngle);
+  v = std::min(std::max(v, 0.0), 1.0);
+  p = gp_Pnt(R * std::cos(u), R * std::sin(u), v);
+  du = gp_Vec(-R * std::sin(u), R * std::cos(u), 0.0);
+  dv = gp_Vec(0.0, 0.0, 1.0);
+}
+
+gp_Pnt cylinderProjection(int, int, const gp_Pnt &p) {
+  double u = std::atan2(p.Y(), p.X());
+  return gp_Pnt(kCylinderRadius * std::cos(u), kCylinderRadius * std::sin(u),
+                p.Z());
+}
+
+// Grid on the quarter cylinder with a perturbed interior, and its (u, v)
+void makeCylinderGrid(int M, int N, StructuredGrid &grid,
+                      std::vector<double> &uv) {
+  grid.resize(M, N);
+  uv.assign(2 * (size_t)grid.rows() * grid.stride(), 0.0);
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      bool boundary = (i == 0 || i == M || j == 0 || j == N);
+      double wobble = boundary ? 0.0 : 0.03 * ((i * 7 + j * 3) % 5);
+      double u = kCylinderAngle * i / M + wobble;
+      double v = (double)j / N - wobble;
+      uv[2 * grid.index(i, j)] = u;
+      uv[2 * grid.index(i, j) + 1] = v;
+      gp_Vec du, dv;
+      gp_Pnt p;
+      cylinderSurface(u, v, p, du, dv);
+      grid.setPoint(i, j, p);
+      grid.setFixed(i, j, boundary);
+    }
+  }
+}
+
+} // namespace
+
+TEST(StructuredGridTest, LayoutAndFixedMask) {
+  StructuredGrid grid(6, 9);
+  EXPECT_EQ(grid.rows(), 7);
+  EXPECT_EQ(grid.cols(), 10);
+  EXPECT_EQ(grid.stride() % StructuredGrid::kRowAlign, 0);
+  EXPECT_GE(grid.stride(), grid.cols());
+
+  grid.setPoint(3, 4, gp_Pnt(1.0, 2.0, 3.0));
+  grid.setFixed(3, 4, true);
+  EXPECT_EQ(grid.x()[grid.index(3, 4)], 1.0);
+  EXPECT_EQ(grid.z()[grid.index(3, 4)], 3.0);
+  EXPECT_TRUE(grid.isFixed(3, 4));
+  EXPECT_FALSE(grid.isFixed(3, 5));
+
+  grid.setFixed(3, 4, false);
+  EXPECT_FALSE(grid.isFixed(3, 4));
+}
+
+TEST(EllipticSolverTest, FlatMatchesNested) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(12, 7, nested, isFixed);
+
+  StructuredGrid flat = StructuredGrid::fromNested(nested, isFixed);
+
+  EllipticSolver::Params params;
+  params.iterations = 50;
+  params.directSolve = false;
+  auto histNested = EllipticSolver::smoothGrid(nested, isFixed, params);
+  auto histFlat = EllipticSolver::smoothGrid(flat, params);
+
+  ASSERT_EQ(histNested.size(), histFlat.size());
+  for (int i = 0; i <= 12; ++i) {
+    for (int j = 0; j <= 7; ++j) {
+      EXPECT_EQ(nested[i][j].X(), flat.point(i, j).X());
+      EXPECT_EQ(nested[i][j].Y(), flat.point(i, j).Y());
+      EXPECT_EQ(nested[i][j].Z(), flat.point(i, j).Z());
+    }
+  }
+}
+
+TEST(EllipticSolverTest, RedBlackIsDeterministic) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(40, 33, nested, isFixed);
+
+  EllipticSolver::Params params;
+  params.iterations = 30;
+  params.directSolve = false;
+  params.ordering = EllipticSolver::Ordering::RedBlack;
+
+  StructuredGrid a = StructuredGrid::fromNested(nested, isFixed);
+  StructuredGrid b = StructuredGrid::fromNested(nested, isFixed);
+  auto histA = EllipticSolver::smoothGrid(a, params);
+  auto histB = EllipticSolver::smoothGrid(b, params);
+
+  EXPECT_EQ(histA, histB);
+  for (int i = 0; i <= 40; ++i) {
+    for (int j = 0; j <= 33; ++j) {
+      EXPECT_EQ(a.point(i, j).X(), b.point(i, j).X());
+      EXPECT_EQ(a.point(i, j).Y(), b.point(i, j).Y());
+    }
+  }
+}
+
+TEST(EllipticSolverTest, RedBlackConvergesToLexicographic) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(16, 12, nested, isFixed);
+
+  EllipticSolver::Params params;
+  params.iterations = 5000;
+  params.directSolve = false;
+  params.relaxation = 1.5;
+
+  StructuredGrid lex = StructuredGrid::fromNested(nested, isFixed);
+  StructuredGrid rb = StructuredGrid::fromNested(nested, isFixed);
+  EllipticSolver::smoothGrid(lex, params);
+  params.ordering = EllipticSolver::Ordering::RedBlack;
+  EllipticSolver::smoothGrid(rb, params);
+
+  for (int i = 0; i <= 16; ++i) {
+    for (int j = 0; j <= 12; ++j) {
+      EXPECT_NEAR(lex.point(i, j).Distance(rb.point(i, j)), 0.0, 1e-7);
+    }
+  }
+}
+
+TEST(MultigridSolverTest, CoarsensOddAndThinGrids) {
+  // 37 intervals -> 19 -> 10 -> 5 -> 3; the 3-interval axis is never halved
+  StructuredGrid grid(37, 3);
+  MultigridSolver multigrid(grid);
+  EXPECT_EQ(multigrid.numLevels(), 5);
+
+  StructuredGrid tiny(3, 2);
+  EXPECT_EQ(MultigridSolver(tiny).numLevels(), 1);
+}
+
+TEST(EllipticSolverTest, MultigridConvergesToSORSolution) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(37, 24, nested, isFixed);
+
+  EllipticSolver::Params params;
+  params.iterations = 20000;
+  params.directSolve = false;
+  params.relaxation = 1.8;
+  StructuredGrid sor = StructuredGrid::fromNested(nested, isFixed);
+  auto histSOR = EllipticSolver::smoothGrid(sor, params);
+
+  params.iterations = 100;
+  params.method = EllipticSolver::Method::Multigrid;
+  StructuredGrid mg = StructuredGrid::fromNested(nested, isFixed);
+  auto histMG = EllipticSolver::smoothGrid(mg, params);
+
+  ASSERT_LT(histMG.size(), 30u);
+  EXPECT_LT(histMG.back(), 1e-9);
+  EXPECT_LT(histMG.size() * 10, histSOR.size());
+  for (int i = 0; i <= 37; ++i) {
+    for (int j = 0; j <= 24; ++j) {
+      EXPECT_NEAR(mg.point(i, j).Distance(sor.point(i, j)), 0.0, 1e-7);
+    }
+  }
+}
+
+TEST(EllipticSolverTest, MultigridWithProjection) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(32, 32, nested, isFixed);
+
+  // Project onto the plane z = 0.5
+  auto constraint = [](int, int, const gp_Pnt &p) {
+    return gp_Pnt(p.X(), p.Y(), 0.5);
+  };
+
+  EllipticSolver::Params params;
+  params.iterations = 100;
+  params.method = EllipticSolver::Method::Multigrid;
+  StructuredGrid mg = StructuredGrid::fromNested(nested, isFixed);
+  auto hist = EllipticSolver::smoothGrid(mg, params, constraint);
+
+  EXPECT_LT(hist.back(), 1e-9);
+  for (int i = 1; i < 32; ++i) {
+    for (int j = 1; j < 32; ++j) {
+      EXPECT_DOUBLE_EQ(mg.point(i, j).Z(), 0.5);
+      // In-plane coordinates are harmonic, i.e. the bilinear boundary map
+      EXPECT_NEAR(mg.point(i, j).X(), i / 32.0, 1e-7);
+      EXPECT_NEAR(mg.point(i, j).Y(), j / 32.0, 1e-7);
+    }
+  }
+}
+
+TEST(EllipticSolverTest, AutoRelaxationBeatsDefault) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(40, 30, nested, isFixed);
+
+  EllipticSolver::Params params;
+  params.iterations = 20000;
+  params.directSolve = false;
+  StructuredGrid fixedOmega = StructuredGrid::fromNested(nested, isFixed);
+  auto histFixed = EllipticSolver::smoothGrid(fixedOmega, params);
+
+  params.autoRelaxation = true;
+  double omega = 0.0;
+  StructuredGrid autoOmega = StructuredGrid::fromNested(nested, isFixed);
+  auto histAuto =
+      EllipticSolver::smoothGrid(autoOmega, params, nullptr, nullptr, &omega);
+
+  EXPECT_DOUBLE_EQ(omega, EllipticSolver::optimalRelaxation(41, 31));
+  EXPECT_GT(omega, 1.8);
+  EXPECT_LT(omega, 2.0);
+  EXPECT_LT(histAuto.back(), 1e-9);
+  EXPECT_LT(histAuto.size() * 10, histFixed.size());
+  params.directSolve = true;
+  StructuredGrid exact = StructuredGrid::fromNested(nested, isFixed);
+  EllipticSolver::smoothGrid(exact, params);
+  for (int i = 0; i <= 40; ++i) {
+    for (int j = 0; j <= 30; ++j) {
+      EXPECT_NEAR(autoOmega.point(i, j).Distance(exact.point(i, j)), 0.0,
+                  1e-7);
+    }
+  }
+}
+
+TEST(EllipticSolverTest, ParametricMatchesProjection) {
+  const int M = 20, N = 16;
+  StructuredGrid start;
+  std::vector<double> uv;
+  makeCylinderGrid(M, N, start, uv);
+  const double uMax = kCylinderAngle;
+
+  EllipticSolver::Params params;
+  params.iterations = 5000;
+  params.autoRelaxation = true;
+  StructuredGrid projected = start;
+  auto histProj =
+      EllipticSolver::smoothGrid(projected, params, cylinderProjection);
+  ASSERT_LT(histProj.back(), 1e-9);
+
+  for (auto ordering : {EllipticSolver::Ordering::Lexicographic,
+                        EllipticSolver::Ordering::RedBlack}) {
+    params.ordering = ordering;
+    StructuredGrid grid = start;
+    std::vector<double> gridUV = uv;
+    auto hist = EllipticSolver::smoothParametric(grid, gridUV, params,
+                                                 cylinderSurface);
+    EXPECT_LT(hist.back(), 1e-9);
+    for (int i = 0; i <= M; ++i) {
+      for (int j = 0; j <= N; ++j) {
+        gp_Pnt p = grid.point(i, j);
+        EXPECT_NEAR(std::hypot(p.X(), p.Y()), kCylinderRadius, 1e-12);
+        EXPECT_NEAR(p.Distance(projected.point(i, j)), 0.0, 1e-7);
+        if (i > 0 && i < M && j > 0 && j < N) {
+          // On a developable surface the fixed point is the uniform grid
+          EXPECT_NEAR(gridUV[2 * grid.index(i, j)], uMax * i / M, 1e-7);
+          EXPECT_NEAR(gridUV[2 * grid.index(i, j) + 1], (double)j / N,
+                      1e-7);
+        }
+      }
+    }
+  }
+}
+
+TEST(EllipticSolverTest, ScheduledProjectionMatchesInline) {
+  const int M = 24, N = 20;
+  StructuredGrid start;
+  std::vector<double> uv;
+  makeCylinderGrid(M, N, start, uv);
+
+  // RedBlack projects from worker threads
+  std::atomic<int> calls{0};
+  auto countingProjection = [&](int i, int j, const gp_Pnt &p) {
+    ++calls;
+    return cylinderProjection(i, j, p);
+  };
+
+  EllipticSolver::Params params;
+  params.iterations = 5000;
+  params.autoRelaxation = true;
+  StructuredGrid inlineGrid = start;
+  auto histInline =
+      EllipticSolver::smoothGrid(inlineGrid, params, countingProjection);
+  ASSERT_LT(histInline.back(), 1e-9);
+  const int inlineCalls = calls.load();
+
+  for (auto ordering : {EllipticSolver::Ordering::Lexicographic,
+                        EllipticSolver::Ordering::RedBlack}) {
+    calls = 0;
+    params.ordering = ordering;
+    params.projectionInterval = 2;
+    params.maxProjectionInterval = 16;
+    StructuredGrid grid = start;
+    auto hist = EllipticSolver::smoothGrid(grid, params, countingProjection);
+    EXPECT_LT(hist.back(), 1e-9);
+    EXPECT_LT(calls.load(), inlineCalls);
+    for (int i = 0; i <= M; ++i) {
+      for (int j = 0; j <= N; ++j) {
+        gp_Pnt p = grid.point(i, j);
+        EXPECT_NEAR(std::hypot(p.X(), p.Y()), kCylinderRadius, 1e-12);
+        EXPECT_NEAR(p.Distance(inlineGrid.point(i, j)), 0.0, 1e-7);
+      }
+    }
+  }
+}
+
+TEST(EllipticSolverTest, WarmStartAfterRefinementStopsEarly) {
+  const int M = 16, N = 12;
+  StructuredGrid coarse;
+  std::vector<double> uv;
+  makeCylinderGrid(M, N, coarse, uv);
+
+  EllipticSolver::Params params;
+  params.iterations = 5000;
+  params.autoRelaxation = true;
+  params.tolerance = 1e-6;
+  EllipticSolver::smoothGrid(coarse, params, cylinderProjection);
+
+  // Twice the subdivisions: cold start from the perturbed grid versus the
+  // coarse solution resampled onto the new boundary
+  StructuredGrid cold;
+  makeCylinderGrid(2 * M, 2 * N, cold, uv);
+  std::vector<std::vector<gp_Pnt>> boundaries(4);
+  for (int i = 0; i <= 2 * M; ++i) {
+    boundaries[0].push_back(cold.point(i, 0));
+    boundaries[2].push_back(cold.point(2 * M - i, 2 * N));
+  }
+  for (int j = 0; j <= 2 * N; ++j) {
+    boundaries[1].push_back(cold.point(2 * M, j));
+    boundaries[3].push_back(cold.point(0, 2 * N - j));
+  }
+  StructuredGrid warm;
+  ASSERT_TRUE(WarmStart::resampleGrid(coarse, boundaries, warm));
+  for (int i = 0; i <= 2 * M; ++i) {
+    for (int j = 0; j <= 2 * N; ++j)
+      warm.setFixed(i, j, cold.isFixed(i, j));
+  }
+
+  auto histCold = EllipticSolver::smoothGrid(cold, params, cylinderProjection);
+  auto histWarm = EllipticSolver::smoothGrid(warm, params, cylinderProjection);
+  ASSERT_LT(histCold.back(), params.tolerance);
+  ASSERT_LT(histWarm.back(), params.tolerance);
+  EXPECT_LT(2 * histWarm.size(), histCold.size());
+  for (int i = 0; i <= 2 * M; ++i) {
+    for (int j = 0; j <= 2 * N; ++j)
+      EXPECT_NEAR(warm.point(i, j).Distance(cold.point(i, j)), 0.0, 1e-4);
+  }
+}
+
+TEST(EllipticSolverTest, StopsOnRequestWithCurrentGrid) {
+  StructuredGrid grid;
+  std::vector<double> uv;
+  makeCylinderGrid(16, 12, grid, uv);
+
+  CancelToken token;
+  EllipticSolver::Params params;
+  params.iterations = 500;
+  params.cancel = &token;
+  int stopAt = 5;
+  auto progress = [&](int it, double) {
+    if (it == stopAt)
+      token.cancel();
+  };
+  auto history =
+      EllipticSolver::smoothGrid(grid, params, cylinderProjection, progress);
+  EXPECT_EQ((int)history.size(), stopAt + 1);
+
+  // Multigrid and parametric sweeps check too; a spent budget stops them
+  // after their first pass
+  token.reset();
+  token.setTimeBudget(1e-9);
+  params.method = EllipticSolver::Method::Multigrid;
+  EXPECT_EQ(EllipticSolver::smoothGrid(grid, params, cylinderProjection).size(),
+            1u);
+  EXPECT_EQ(
+      EllipticSolver::smoothParametric(grid, uv, params, cylinderSurface)
+          .size(),
+      1u);
+}
+
+TEST(CancelTokenTest, CancelAndDeadline) {
+  CancelToken token;
+  EXPECT_FALSE(token.stopRequested());
+  EXPECT_FALSE(CancelToken::shouldStop(nullptr));
+
+  token.setTimeBudget(3600.0);
+  EXPECT_FALSE(token.isExpired());
+  token.setTimeBudget(1e-9);
+  EXPECT_TRUE(token.isExpired());
+  EXPECT_FALSE(token.isCancelled());
+  EXPECT_TRUE(CancelToken::shouldStop(&token));
+  token.setTimeBudget(0.0); // No limit
+  EXPECT_FALSE(token.stopRequested());
+
+  token.cancel();
+  EXPECT_TRUE(token.isCancelled());
+  token.reset();
+  EXPECT_FALSE(token.stopRequested());
+}
+
+TEST(ProjectionScheduleTest, AdaptsToDrift) {
+  ProjectionSchedule schedule(2, 8);
+  EXPECT_TRUE(schedule.adaptive());
+  EXPECT_FALSE(schedule.projects(0, 100));
+  schedule.skipped();
+  EXPECT_TRUE(schedule.projects(1, 100));
+
+  // Small corrections lengthen the interval up to the maximum
+  schedule.projected(0.01, 1.0);
+  EXPECT_EQ(schedule.interval(), 4);
+  schedule.projected(0.01, 1.0);
+  schedule.projected(0.01, 1.0);
+  EXPECT_EQ(schedule.interval(), 8);
+  schedule.projected(0.3, 1.0); // In between: unchanged
+  EXPECT_EQ(schedule.interval(), 8);
+
+  // The last sweep always projects
+  EXPECT_FALSE(schedule.projects(10, 100));
+  EXPECT_TRUE(schedule.projects(99, 100));
+
+  // Drift dominating the motion brings it back to every sweep
+  for (int k = 0; k < 4; ++k)
+    schedule.projected(1.0, 1e-3);
+  EXPECT_EQ(schedule.interval(), 1);
+  EXPECT_TRUE(schedule.projects(0, 100));
+
+  EXPECT_FALSE(ProjectionSchedule(10, 1).adaptive());
+  EXPECT_EQ(ProjectionSchedule(10, 1).interval(), 1);
+}
+
+TEST(RelaxationControlTest, BacksOffOnlyOnDivergence) {
+  RelaxationControl control(1.75);
+  control.update(1.0);
+  control.update(0.5);
+  control.update(1.5); // Transient growth within the ratio
+  EXPECT_FALSE(control.update(1.9));
+  EXPECT_DOUBLE_EQ(control.omega(), 1.75);
+
+  EXPECT_TRUE(control.update(2.5));
+  EXPECT_DOUBLE_EQ(control.omega(), 1.375);
+
+  // Each further blow-up halves the over-relaxation until Gauss-Seidel
+  double err = 2.5;
+  for (int k = 0; k < 20; ++k) {
+    err *= 2.0 * RelaxationControl::kDivergenceRatio;
+    control.update(err);
+  }
+  EXPECT_DOUBLE_EQ(control.omega(), 1.0);
+  EXPECT_FALSE(control.update(1e300));
+}
+
+TEST(FastPoissonSolverTest, CanSolveOnlyBoundaryFixedGrids) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(9, 6, nested, isFixed);
+  StructuredGrid grid = StructuredGrid::fromNested(nested, isFixed);
+  EXPECT_TRUE(FastPoissonSolver::canSolve(grid));
+
+  grid.setFixed(4, 3, true);
+  EXPECT_FALSE(FastPoissonSolver::canSolve(grid));
+
+  grid.setFixed(4, 3, false);
+  grid.setFixed(0, 2, false);
+  EXPECT_FALSE(FastPoissonSolver::canSolve(grid));
+
+  EXPECT_FALSE(FastPoissonSolver::canSolve(StructuredGrid(1, 5)));
+}
+
+TEST(FastPoissonSolverTest, MatchesConvergedSOR) {
+  // 16 uses the radix-2 path, 23 and 10 go through Bluestein
+  const int sizes[][2] = {{16, 16}, {23, 10}};
+  for (const auto &size : sizes) {
+    int M = size[0];
+    int N = size[1];
+    std::vector<std::vector<gp_Pnt>> nested;
+    std::vector<std::vector<bool>> isFixed;
+    makeGrid(M, N, nested, isFixed);
+
+    EllipticSolver::Params params;
+    params.iterations = 20000;
+    params.relaxation = 1.8;
+    params.directSolve = false;
+    StructuredGrid sor = StructuredGrid::fromNested(nested, isFixed);
+    EllipticSolver::smoothGrid(sor, params);
+
+    params.directSolve = true;
+    StructuredGrid direct = StructuredGrid::fromNested(nested, isFixed);
+    auto hist = EllipticSolver::smoothGrid(direct, params);
+    EXPECT_EQ(hist.size(), 1u);
+
+    for (int i = 0; i <= M; ++i) {
+      for (int j = 0; j <= N; ++j) {
+        EXPECT_NEAR(direct.point(i, j).Distance(sor.point(i, j)), 0.0, 1e-7);
+      }
+    }
+  }
+}
+
+namespace {
+
+// Runs the same sweeps through the SIMD kernels (no constraint) and through
+// the scalar per-point update (identity constraint) and compares bit for bit
+// Red-black SOR written out point by point, for interior points with four
+// neighbours; the solver itself sends every interior row through a kernel
+void redBlackReference(StructuredGrid &grid, double omega, int iterations) {
+  for (int it = 0; it < iterations; ++it) {
+    for (int colour = 0; colour < 2; ++colour) {
+      for (int i = 1; i + 1 < grid.rows(); ++i) {
+        for (int j = 1; j + 1 < grid.cols(); ++j) {
+          if ((i + j) % 2 != colour || grid.isFixed(i, j))
+            continue;
+          gp_XYZ sum = grid.point(i - 1, j).XYZ();
+          sum += grid.point(i + 1, j).XYZ();
+          sum += grid.point(i, j - 1).XYZ();
+          sum += grid.point(i, j + 1).XYZ();
+          gp_XYZ old = grid.point(i, j).XYZ();
+          grid.setPoint(i, j,
+                        gp_Pnt(old * (1.0 - omega) + (sum / 4.0) * omega));
+        }
+      }
+    }
+  }
+}
+
+void expectKernelMatchesScalar(EllipticSolver::Ordering ordering) {
+  std::vector<std::vector<gp_Pnt>> nested;
+  std::vector<std::vector<bool>> isFixed;
+  makeGrid(21, 30, nested, isFixed);
+  isFixed[7][9] = true; // interior hard point
+  isFixed[8][10] = true;
+
+  EllipticSolver::Params params;
+  params.iterations = 25;
+  params.relaxation = 1.3;
+  params.ordering = ordering;
+  params.directSolve = false;
+
+  StructuredGrid simd = StructuredGrid::fromNested(nested, isFixed);
+  StructuredGrid scalar = StructuredGrid::fromNested(nested, isFixed);
+  auto histSimd = EllipticSolver::smoothGrid(simd, params);
+  if (ordering == EllipticSolver::Ordering::RedBlack) {
+    redBlackReference(scalar, params.relaxation, params.iterations);
+  } else {
+    auto histScalar = EllipticSolver::smoothGrid(
+        scalar, params, [](int, int, const gp_Pnt &p) { return p; });
+    EXPECT_EQ(histSimd, histScalar);
+  }
+  for (int i = 0; i <= 21; ++i) {
+    for (int j = 0; j <= 30; ++j) {
+      EXPECT_EQ(simd.point(i, j).X(), scalar.point(i, j).X());
+      EXPECT_EQ(simd.point(i, j).Y(), scalar.point(i, j).Y());
+      EXPECT_EQ(simd.point(i, j).Z(), scalar.point(i, j).Z());
+    }
+  }
+}
+
+} // namespace
+
+TEST(StencilKernelsTest, BitExactWithScalarUpdate) {
+  const StencilKernels::Isa detected = StencilKernels::isa();
+  const StencilKernels::Isa all[] = {StencilKernels::Isa::Scalar,
+                                     StencilKernels::Isa::AVX2,
+                                     StencilKernels::Isa::NEON};
+  for (StencilKernels::Isa isa : all) {
+    if (!StencilKernels::setIsa(isa))
+      continue;
+    SCOPED_TRACE(static_cast<int>(isa));
+    expectKernelMatchesScalar(EllipticSolver::Ordering::Lexicographic);
+    expectKernelMatchesScalar(EllipticSolver::Ordering::RedBlack);
+  }
+  StencilKernels::setIsa(detected);
+}
+
+TEST(StencilKernelsTest, ProjectedRedBlackSameOnEveryIsa) {
+  // Constrained red-black sweeps relax rows with the kernel and project
+  // them afterwards
+  const int M = 24, N = 20;
+  StructuredGrid start;
+  std::vector<double> uv;
+  makeCylinderGrid(M, N, start, uv);
+
+  EllipticSolver::Params params;
+  params.iterations = 40;
+  params.relaxation = 1.3;
+  params.ordering = EllipticSolver::Ordering::RedBlack;
+
+  const StencilKernels::Isa detected = StencilKernels::isa();
+  ASSERT_TRUE(StencilKernels::setIsa(StencilKernels::Isa::Scalar));
+  StructuredGrid reference = start;
+  auto histReference =
+      EllipticSolver::smoothGrid(reference, params, cylinderProjection);
+
+  const StencilKernels::Isa all[] = {StencilKernels::Isa::AVX2,
+                                     StencilKernels::Isa::NEON};
+  for (StencilKernels::Isa isa : all) {
+    if (!StencilKernels::setIsa(isa))
+      continue;
+    SCOPED_TRACE(static_cast<int>(isa));
+    StructuredGrid grid = start;
+    auto hist = EllipticSolver::smoothGrid(grid, params, cylinderProjection);
+    EXPECT_EQ(hist, histReference);
+    for (int i = 0; i <= M; ++i) {
+      for (int j = 0; j <= N; ++j)
+        EXPECT_EQ(grid.point(i, j).X(), reference.point(i, j).X());
+    }
+  }
+  StencilKernels::setIsa(detected);
+
+  // On the cylinder, like the projection
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      gp_Pnt p = reference.point(i, j);
+      EXPECT_NEAR(std::hypot(p.X(), p.Y()), kCylinderRadius, 1e-12);
+    }
+  }
+}
@@ -0,0 +1,326 @@
+#include "CancelToken.h"
+#include "GraphSolver.h"
+#include "SparseSolver.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+
+namespace {
+
+// (n+1)x(n+1) grid graph with the boundary fixed, numbered in a scrambled
+// order so that neighbours are far apart in memory
+GraphSolver::Graph makeScrambledGrid(int n) {
+  const int side = n + 1;
+  const int count = side * side;
+  std::vector<int> label(count);
+  for (int k = 0; k < count; ++k)
+    label[k] = (k * 37) % count; // 37 is coprime with count for n = 10
+  std::vector<int> cell(count);
+  for (int k = 0; k < count; ++k)
+    cell[label[k]] = k;
+
+  GraphSolver::Graph graph;
+  for (int l = 0; l < count; ++l) {
+    int i = cell[l] / side;
+    int j = cell[l] % side;
+    bool boundary = (i == 0 || i == n || j == 0 || j == n);
+    double wobble = boundary ? 0.0 : 0.1 * ((i + 2 * j) % 3);
+    graph.addNode(gp_Pnt(i + wobble, j, wobble), boundary);
+  }
+
+  std::vector<std::pair<int, int>> links;
+  for (int i = 0; i <= n; ++i) {
+    for (int j = 0; j <= n; ++j) {
+      int k = i * side + j;
+      if (i < n)
+        links.emplace_back(label[k], label[k + side]);
+      if (j < n)
+        links.emplace_back(label[k], label[k + 1]);
+    }
+  }
+  graph.setLinks(links);
+  return graph;
+}
+
+int bandwidth(const GraphSolver::Graph &graph) {
+  int band = 0;
+  for (int i = 0; i < graph.size(); ++i) {
+    for (int k = graph.offsets[i]; k < graph.offsets[i + 1]; ++k)
+      band = std::max(band, std::abs(graph.neighbors[k] - i));
+  }
+  return band;
+}
+
+} // namespace
+
+TEST(GraphSolverTest, SetLinksBuildsSortedUniqueRows) {
+  GraphSolver::Graph graph;
+  for (int k = 0; k < 4; ++k)
+    graph.addNode(gp_Pnt(k, 0, 0), false);
+  graph.setLinks({{0, 2}, {2, 0}, {1, 1}, {0, 1}, {3, 0}, {0, 2}});
+
+  ASSERT_EQ(graph.offsets.size(), 5u);
+  EXPECT_EQ(graph.degree(0), 3);
+  EXPECT_EQ(graph.degree(1), 1);
+  EXPECT_EQ(graph.degree(2), 1);
+  EXPECT_EQ(graph.degree(3), 1);
+  std::vector<int> row0(graph.neighbors.begin() + graph.offsets[0],
+                        graph.neighbors.begin() + graph.offsets[1]);
+  EXPECT_EQ(row0, (std::vector<int>{1, 2, 3}));
+  EXPECT_EQ(graph.neighbors[graph.offsets[1]], 0);
+}
+
+TEST(GraphSolverTest, ReorderRCMIsPermutationAndNarrowsBand) {
+  GraphSolver::Graph graph = makeScrambledGrid(10);
+  GraphSolver::Graph original = graph;
+  int before = bandwidth(graph);
+
+  std::vector<int> newIndex = GraphSolver::reorderRCM(graph);
+
+  ASSERT_EQ((int)newIndex.size(), original.size());
+  std::vector<int> sorted = newIndex;
+  std::sort(sorted.begin(), sorted.end());
+  for (int k = 0; k < (int)sorted.size(); ++k)
+    EXPECT_EQ(sorted[k], k);
+
+  for (int old = 0; old < original.size(); ++old) {
+    int idx = newIndex[old];
+    EXPECT_EQ(graph.point(idx).X(), original.point(old).X());
+    EXPECT_EQ(graph.isFixed(idx), original.isFixed(old));
+    ASSERT_EQ(graph.degree(idx), original.degree(old));
+    for (int k = original.offsets[old]; k < original.offsets[old + 1]; ++k) {
+      int nb = newIndex[original.neighbors[k]];
+      EXPECT_TRUE(std::binary_search(
+          graph.neighbors.begin() + graph.offsets[idx],
+          graph.neighbors.begin() + graph.offsets[idx + 1], nb));
+    }
+  }
+
+  EXPECT_LE(bandwidth(graph), 12);
+  EXPECT_LT(bandwidth(graph), before);
+}
+
+TEST(GraphSolverTest, ReorderedGraphConvergesToSameSolution) {
+  GraphSolver::Graph plain = makeScrambledGrid(10);
+  GraphSolver::Graph reordered = plain;
+  std::vector<int> newIndex = GraphSolver::reorderRCM(reordered);
+
+  GraphSolver::Params params;
+  params.iterations = 5000;
+  params.relaxation = 1.0;
+  GraphSolver::smoothGraph(plain, params);
+  GraphSolver::smoothGraph(reordered, params);
+
+  for (int old = 0; old < plain.size(); ++old) {
+    EXPECT_NEAR(plain.point(old).Distance(reordered.point(newIndex[old])),
+                0.0, 1e-7);
+  }
+}
+
+TEST(GraphSolverTest, GreedyColouringIsProper) {
+  GraphSolver::Graph graph = makeScrambledGrid(10);
+  GraphSolver::reorderRCM(graph);
+  GraphSolver::Colouring colouring = GraphSolver::colourGreedy(graph);
+
+  ASSERT_EQ((int)colouring.nodes.size(), graph.size());
+  EXPECT_LE(colouring.numColours(), 5); // max degree 4
+  std::vector<int> colour(graph.size(), -1);
+  for (int c = 0; c < colouring.numColours(); ++c) {
+    for (int k = colouring.offsets[c]; k < colouring.offsets[c + 1]; ++k) {
+      EXPECT_EQ(colour[colouring.nodes[k]], -1);
+      colour[colouring.nodes[k]] = c;
+    }
+  }
+  for (int i = 0; i < graph.size(); ++i) {
+    for (int k = graph.offsets[i]; k < graph.offsets[i + 1]; ++k)
+      EXPECT_NE(colour[i], colour[graph.neighbors[k]]);
+  }
+}
+
+TEST(GraphSolverTest, ColouredSweepIsDeterministicAndConverges) {
+  GraphSolver::Graph sequential = makeScrambledGrid(10);
+  GraphSolver::reorderRCM(sequential);
+  GraphSolver::Graph colouredA = sequential;
+  GraphSolver::Graph colouredB = sequential;
+  GraphSolver::Colouring colouring = GraphSolver::colourGreedy(sequential);
+
+  GraphSolver::Params params;
+  params.iterations = 5000;
+  params.relaxation = 1.0;
+  GraphSolver::smoothGraph(sequential, params);
+
+  params.ordering = GraphSolver::Ordering::Coloured;
+  auto histA =
+      GraphSolver::smoothGraph(colouredA, params, nullptr, nullptr, &colouring);
+  auto histB = GraphSolver::smoothGraph(colouredB, params);
+
+  EXPECT_EQ(histA, histB);
+  for (int i = 0; i < sequential.size(); ++i) {
+    EXPECT_EQ(colouredA.x[i], colouredB.x[i]);
+    EXPECT_EQ(colouredA.y[i], colouredB.y[i]);
+    EXPECT_NEAR(colouredA.point(i).Distance(sequential.point(i)), 0.0, 1e-7);
+  }
+}
+
+TEST(GraphSolverTest, AutoRelaxationEstimatesOmega) {
+  GraphSolver::Graph plain = makeScrambledGrid(40);
+  GraphSolver::reorderRCM(plain);
+  GraphSolver::Graph tuned = plain;
+
+  GraphSolver::Params params;
+  params.iterations = 20000;
+  params.relaxation = 1.0;
+  auto histPlain = GraphSolver::smoothGraph(plain, params);
+
+  params.autoRelaxation = true;
+  double omega = 0.0;
+  auto histTuned = GraphSolver::smoothGraph(tuned, params, nullptr, nullptr,
+                                            nullptr, &omega);
+
+  // Optimal for the 40x40 Laplacian is about 1.855; the estimate tends to
+  // land a little above
+  EXPECT_GT(omega, 1.7);
+  EXPECT_LT(omega, 1.99);
+  EXPECT_LT(histTuned.back(), 1e-9);
+  EXPECT_LT(histTuned.size() * 5, histPlain.size());
+
+  GraphSolver::Graph exact = plain;
+  SparseSolver(exact, SparseSolver::Preconditioner::IC0)
+      .solve(exact, 1000, 1e-13);
+  for (int i = 0; i < plain.size(); ++i)
+    EXPECT_NEAR(tuned.point(i).Distance(exact.point(i)), 0.0, 1e-7);
+}
+
+TEST(GraphSolverTest, ScheduledProjectionMatchesInline) {
+  GraphSolver::Graph inlineGraph = makeScrambledGrid(10);
+  GraphSolver::Graph scheduledGraph = inlineGraph;
+
+  // Sphere of radius 20 below the grid
+  int calls = 0;
+  const gp_Pnt centre(5, 5, -20);
+  auto toSphere = [&](int, const gp_Pnt &p) {
+    ++calls;
+    gp_XYZ d = p.XYZ() - centre.XYZ();
+    return gp_Pnt(centre.XYZ() + d * (20.0 / d.Modulus()));
+  };
+
+  GraphSolver::Params params;
+  params.iterations = 5000;
+  params.relaxation = 1.0;
+  auto histInline = GraphSolver::smoothGraph(inlineGraph, params, toSphere);
+  ASSERT_LT(histInline.back(), 1e-9);
+  const int inlineCalls = calls;
+
+  calls = 0;
+  params.projectionInterval = 4;
+  params.maxProjectionInterval = 16;
+  auto hist = GraphSolver::smoothGraph(scheduledGraph, params, toSphere);
+  EXPECT_LT(hist.back(), 1e-9);
+  EXPECT_LT(calls, inlineCalls);
+  for (int i = 0; i < inlineGraph.size(); ++i) {
+    EXPECT_NEAR(scheduledGraph.point(i).Distance(inlineGraph.point(i)), 0.0,
+                1e-7);
+  }
+}
+
+TEST(SparseSolverTest, PCGMatchesRelaxedSolution) {
+  GraphSolver::Graph relaxed = makeScrambledGrid(10);
+  GraphSolver::reorderRCM(relaxed);
+  GraphSolver::Graph jacobi = relaxed;
+  GraphSolver::Graph ic0 = relaxed;
+
+  GraphSolver::Params params;
+  params.iterations = 5000;
+  params.relaxation = 1.0;
+  GraphSolver::smoothGraph(relaxed, params);
+
+  SparseSolver jacobiSolver(jacobi, SparseSolver::Preconditioner::Jacobi);
+  SparseSolver ic0Solver(ic0, SparseSolver::Preconditioner::IC0);
+  EXPECT_EQ(jacobiSolver.numUnknowns(), 81);
+  auto jacobiHist = jacobiSolver.solve(jacobi, 500, 1e-12);
+  auto ic0Hist = ic0Solver.solve(ic0, 500, 1e-12);
+
+  ASSERT_FALSE(jacobiHist.empty());
+  EXPECT_LT(jacobiHist.back(), 1e-12);
+  EXPECT_LT(ic0Hist.back(), 1e-12);
+  EXPECT_LT(ic0Hist.size(), jacobiHist.size());
+  for (int i = 0; i < relaxed.size(); ++i) {
+    EXPECT_NEAR(jacobi.point(i).Distance(relaxed.point(i)), 0.0, 1e-8);
+    EXPECT_NEAR(ic0.point(i).Distance(relaxed.point(i)), 0.0, 1e-8);
+  }
+}
+
+TEST(SparseSolverTest, ProjectedSolveConvergesOnConstraint) {
+  GraphSolver::Graph relaxed = makeScrambledGrid(10);
+  GraphSolver::Graph projected = relaxed;
+
+  // Flatten onto z = 0 as the "surface"
+  auto flatten = [](int, const gp_Pnt &p) { return gp_Pnt(p.X(), p.Y(), 0); };
+  GraphSolver::Params params;
+  params.iterations = 5000;
+  params.relaxation = 1.0;
+  GraphSolver::smoothGraph(relaxed, params, flatten);
+
+  SparseSolver solver(projected, SparseSolver::Preconditioner::IC0);
+  auto hist = solver.solveProjected(projected, 200, 5, flatten);
+
+  ASSERT_FALSE(hist.empty());
+  EXPECT_LT(hist.back(), 1e-9);
+  for (int i = 0; i < relaxed.size(); ++i) {
+    EXPECT_EQ(projected.point(i).Z(), 0.0);
+    EXPECT_NEAR(projected.point(i).Distance(relaxed.point(i)), 0.0, 1e-8);
+  }
+}
+
+TEST(SparseSolverTest, StopsOnRequestWithCurrentPositions) {
+  GraphSolver::Graph graph = makeScrambledGrid(10);
+  CancelToken token;
+  token.cancel();
+
+  GraphSolver::Params params;
+  params.cancel = &token;
+  EXPECT_EQ(GraphSolver::smoothGraph(graph, params).size(), 1u);
+
+  // PCG checks before every step, so nothing moves
+  GraphSolver::Graph before = graph;
+  SparseSolver solver(graph, SparseSolver::Preconditioner::IC0);
+  EXPECT_TRUE(solver.solve(graph, 500, 1e-12, nullptr, &token).empty());
+  for (int i = 0; i < graph.size(); ++i)
+    EXPECT_EQ(graph.point(i).Distance(before.point(i)), 0.0);
+
+  auto flatten = [](int, const gp_Pnt &p) { return gp_Pnt(p.X(), p.Y(), 0); };
+  EXPECT_EQ(
+      solver.solveProjected(graph, 200, 5, flatten, nullptr, 1e-9, &token)
+          .size(),
+      1u);
+}
+
+TEST(SparseSolverTest, AMGConvergesInFewCyclesAndIsReusable) {
+  GraphSolver::Graph graph = makeScrambledGrid(40);
+  GraphSolver::reorderRCM(graph);
+  GraphSolver::Graph reference = graph;
+
+  SparseSolver ic0(reference, SparseSolver::Preconditioner::IC0);
+  ic0.solve(reference, 1000, 1e-12);
+
+  SparseSolver amg(graph, SparseSolver::Preconditioner::AMG);
+  ASSERT_NE(amg.multigrid(), nullptr);
+  EXPECT_GE(amg.multigrid()->numLevels(), 3);
+  EXPECT_LE(amg.multigrid()->levelSize(amg.multigrid()->numLevels() - 1),
+            AlgebraicMultigrid::kMaxCoarseSize);
+
+  auto hist = amg.solve(graph, 1000, 1e-12);
+  EXPECT_LT(hist.size(), 30u);
+  EXPECT_LT(hist.back(), 1e-12);
+  for (int i = 0; i < graph.size(); ++i)
+    EXPECT_NEAR(graph.point(i).Distance(reference.point(i)), 0.0, 1e-8);
+
+  // Same connectivity, new positions: the hierarchy is reused as is
+  for (int i = 0; i < graph.size(); ++i) {
+    if (!graph.isFixed(i))
+      graph.setPoint(i, gp_Pnt(0, 0, 0));
+  }
+  auto again = amg.solve(graph, 1000, 1e-12);
+  EXPECT_LT(again.size(), 30u);
+  for (int i = 0; i < graph.size(); ++i)
+    EXPECT_NEAR(graph.point(i).Distance(reference.point(i)), 0.0, 1e-8);
+}
@@ -0,0 +1,90 @@
+#include "ObjectPool.h"
+#include "Topology.h"
+#include <gp_Pnt.hxx>
+#include <gtest/gtest.h>
+#include <set>
+
+namespace {
+
+struct Tracked {
+  static int alive;
+  int value;
+  explicit Tracked(int v) : value(v) { ++alive; }
+  ~Tracked() { --alive; }
+};
+int Tracked::alive = 0;
+
+} // namespace
+
+TEST(ObjectPoolTest, IteratesLiveObjectsAndDestroysThemOnClear) {
+  ObjectPool<Tracked, 256> pool; // A few dozen per block
+  std::vector<Tracked *> objects;
+  for (int i = 0; i < 200; ++i)
+    objects.push_back(pool.allocate(i));
+  for (int i = 0; i < 200; i += 3)
+    pool.deallocate(objects[i]);
+
+  std::set<int> seen;
+  pool.forEachLive([&](Tracked &t) { seen.insert(t.value); });
+  EXPECT_EQ(seen.size(), (size_t)Tracked::alive);
+  EXPECT_EQ(pool.stats().live, seen.size());
+  EXPECT_EQ(seen.count(0), 0u);
+  EXPECT_EQ(seen.count(1), 1u);
+
+  // Freed slots are reused before a new block is taken
+  size_t capacity = pool.stats().capacity;
+  for (int i = 0; i < 200; i += 3)
+    pool.allocate(-i);
+  EXPECT_EQ(pool.stats().capacity, capacity);
+
+  pool.clear();
+  EXPECT_EQ(Tracked::alive, 0);
+  EXPECT_EQ(pool.stats().blocks, 0u);
+}
+
+TEST(ObjectPoolTest, GivesBackEmptyBlocks) {
+  ObjectPool<Tracked, 256> pool;
+  std::vector<Tracked *> objects;
+  for (int i = 0; i < 1000; ++i)
+    objects.push_back(pool.allocate(i));
+  ObjectPool<Tracked, 256>::Stats full = pool.stats();
+  EXPECT_EQ(full.live, 1000u);
+  EXPECT_GE(full.capacity, 1000u);
+  EXPECT_GT(full.blocks, 10u);
+  EXPECT_GT(full.bytes, full.capacity * sizeof(Tracked));
+
+  // Emptied blocks go back at once, except one kept as a spare
+  for (Tracked *t : objects)
+    pool.deallocate(t);
+  EXPECT_EQ(pool.stats().live, 0u);
+  EXPECT_EQ(pool.stats().blocks, 1u);
+  EXPECT_EQ(pool.trim(), 1u);
+  EXPECT_EQ(pool.stats().bytes, 0u);
+
+  // Still usable afterwards
+  Tracked *t = pool.allocate(7);
+  EXPECT_EQ(t->value, 7);
+  EXPECT_EQ(pool.stats().live, 1u);
+  pool.deallocate(t);
+}
+
+TEST(ObjectPoolTest, TopologyPoolsShrinkAfterMassDeletion) {
+  Topology topology;
+  std::vector<int> nodes;
+  for (int i = 0; i < 2000; ++i)
+    nodes.push_back(topology.createNode(gp_Pnt(i, 0, 0))->getID());
+  for (int i = 0; i + 1 < 2000; ++i)
+    topology.createEdge(topology.getNode(nodes[i]),
+                        topology.getNode(nodes[i + 1]));
+  Topology::PoolStats before = topology.getPoolStats();
+  EXPECT_EQ(before.edges.live, 1999u);
+  EXPECT_EQ(before.halfEdges.live, 2 * 1999u);
+
+  for (int id : nodes)
+    topology.deleteNode(id);
+  topology.releaseUnusedMemory();
+  Topology::PoolStats after = topology.getPoolStats();
+  EXPECT_EQ(after.nodes.live + after.edges.live + after.halfEdges.live, 0u);
+  EXPECT_EQ(after.nodes.bytes + after.edges.bytes + after.halfEdges.bytes,
+            0u);
+}
@@ -0,0 +1,104 @@
+#include "EllipticSolver.h"
+#include "ProjectionTarget.h"
+#include "StructuredGrid.h"
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <Geom_CylindricalSurface.hxx>
+#include <Precision.hxx>
+#include <cmath>
+#include <gp_Ax3.hxx>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Cylinder face of radius 2 and height 1 whose angle runs from -0.5 to 0.5,
+// so it straddles the surface's seam at angle 0
+constexpr double kRadius = 2.0;
+constexpr double kHalfAngle = 0.5;
+
+TopoDS_Shape makeSeamFace() {
+  Handle(Geom_CylindricalSurface) surface =
+      new Geom_CylindricalSurface(gp_Ax3(), kRadius);
+  return BRepBuilderAPI_MakeFace(surface, -kHalfAngle, kHalfAngle, 0.0, 1.0,
+                                 Precision::Confusion())
+      .Face();
+}
+
+gp_Pnt cylinderPoint(double u, double v) {
+  return gp_Pnt(kRadius * std::cos(u), kRadius * std::sin(u), v);
+}
+
+} // namespace
+
+TEST(ProjectionTargetTest, EvaluateWrapsAcrossSeam) {
+  ProjectionTarget target(makeSeamFace());
+  ASSERT_TRUE(target.isSingleFace());
+
+  // One period away from the face: same point, not clamped to its end
+  double u = 2 * M_PI - 0.2, v = 0.5;
+  gp_Pnt p;
+  gp_Vec du, dv;
+  target.evaluate(u, v, p, du, dv);
+  EXPECT_NEAR(u, -0.2, 1e-12);
+  EXPECT_NEAR(p.Distance(cylinderPoint(-0.2, 0.5)), 0.0, 1e-12);
+
+  // Outside the face within its period: clamped as before
+  u = 0.7;
+  target.evaluate(u, v, p, du, dv);
+  EXPECT_NEAR(u, kHalfAngle, 1e-12);
+}
+
+TEST(ProjectionTargetTest, HintsLieInTheFacePeriod) {
+  ProjectionTarget target(makeSeamFace());
+  for (double angle : {-0.3, -0.01, 0.01, 0.3}) {
+    ProjectionTarget::Hint hint;
+    gp_Pnt p = target.project(cylinderPoint(angle, 0.4), hint);
+    ASSERT_GE(hint.patch, 0) << angle;
+    EXPECT_NEAR(hint.u, angle, 1e-7);
+    EXPECT_NEAR(p.Distance(cylinderPoint(angle, 0.4)), 0.0, 1e-7);
+  }
+}
+
+TEST(ProjectionTargetTest, ParametricSmoothingCrossesSeam) {
+  ProjectionTarget target(makeSeamFace());
+  const int M = 12, N = 8;
+  const double uStart = -0.8 * kHalfAngle, uEnd = 0.8 * kHalfAngle;
+
+  // Perturbed grid seeded from projection, as the smoother does
+  StructuredGrid grid;
+  grid.resize(M, N);
+  std::vector<double> uv(2 * (size_t)grid.rows() * grid.stride(), 0.0);
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      bool boundary = (i == 0 || i == M || j == 0 || j == N);
+      double wobble = boundary ? 0.0 : 0.02 * ((i * 7 + j * 3) % 5);
+      ProjectionTarget::Hint hint;
+      gp_Pnt p = target.project(
+          cylinderPoint(uStart + (uEnd - uStart) * i / M + wobble,
+                        (double)j / N - wobble),
+          hint);
+      grid.setPoint(i, j, p);
+      grid.setFixed(i, j, boundary);
+      uv[2 * grid.index(i, j)] = hint.u;
+      uv[2 * grid.index(i, j) + 1] = hint.v;
+    }
+  }
+
+  EllipticSolver::Params params;
+  params.iterations = 5000;
+  params.autoRelaxation = true;
+  auto surface = [&target](double &u, double &v, gp_Pnt &p, gp_Vec &du,
+                           gp_Vec &dv) { target.evaluate(u, v, p, du, dv); };
+  auto hist = EllipticSolver::smoothParametric(grid, uv, params, surface);
+  EXPECT_LT(hist.back(), 1e-9);
+
+  // On a developable surface the fixed point is the uniform grid
+  for (int i = 1; i < M; ++i) {
+    for (int j = 1; j < N; ++j) {
+      double u = uStart + (uEnd - uStart) * i / M;
+      EXPECT_NEAR(uv[2 * grid.index(i, j)], u, 1e-7);
+      EXPECT_NEAR(uv[2 * grid.index(i, j) + 1], (double)j / N, 1e-7);
+      EXPECT_NEAR(grid.point(i, j).Distance(cylinderPoint(u, (double)j / N)),
+                  0.0, 1e-7);
+    }
+  }
+}
@@ -0,0 +1,109 @@
+#include "FlatHashMap.h"
+#include "SlotMap.h"
+#include <climits>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+
+TEST(SlotMapTest, HandlesGoStaleWhenErased) {
+  int a = 1, b = 2, c = 3;
+  SlotMap<int> map;
+  auto ha = map.insert(10, &a);
+  auto hb = map.insert(20, &b);
+  EXPECT_EQ(map.find(10), &a);
+  EXPECT_EQ(map.get(hb), &b);
+  EXPECT_EQ(map.handle(20), hb);
+  EXPECT_EQ(map.find(15), nullptr);
+  EXPECT_EQ(map.find(-1), nullptr);
+
+  // Erasing moves the last entry into the hole; its handle still works
+  EXPECT_TRUE(map.erase(10));
+  EXPECT_FALSE(map.erase(10));
+  EXPECT_EQ(map.get(ha), nullptr);
+  EXPECT_EQ(map.get(hb), &b);
+  EXPECT_EQ(map.size(), 1u);
+  EXPECT_EQ(map.begin()->first, 20);
+
+  // The freed slot is reused under a new generation
+  auto hc = map.insert(30, &c);
+  EXPECT_EQ(hc.slot, ha.slot);
+  EXPECT_EQ(map.get(ha), nullptr);
+  EXPECT_EQ(map.get(hc), &c);
+  EXPECT_TRUE(map.handle(10).isNull());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.get(hb), nullptr);
+  EXPECT_EQ(map.count(20), 0u);
+}
+
+TEST(SlotMapTest, AcceptsNegativeAndSparseIds) {
+  int a = 1, b = 2, c = 3;
+  SlotMap<int> map;
+  auto ha = map.insert(-7, &a);
+  auto hb = map.insert(INT_MAX, &b);
+  map.insert(3, &c);
+  EXPECT_FALSE(ha.isNull());
+  EXPECT_EQ(map.find(-7), &a);
+  EXPECT_EQ(map.get(hb), &b);
+  EXPECT_EQ(map.handle(INT_MAX), hb);
+  EXPECT_EQ(map.count(-8), 0u);
+  EXPECT_EQ(map.size(), 3u);
+
+  // Replacing and erasing work the same as for table IDs
+  map.insert(-7, &c);
+  EXPECT_EQ(map.get(ha), &c);
+  EXPECT_TRUE(map.erase(INT_MAX));
+  EXPECT_EQ(map.get(hb), nullptr);
+  EXPECT_EQ(map.find(INT_MAX), nullptr);
+  EXPECT_EQ(map.find(3), &c);
+}
+
+TEST(SlotMapTest, MatchesStdMapUnderRandomEdits) {
+  std::mt19937 rng(7);
+  std::vector<int> values(500);
+  SlotMap<int> map;
+  std::map<int, int *> reference;
+  for (int step = 0; step < 20000; ++step) {
+    // Mostly dense IDs, with negative and far-off ones mixed in
+    int id = (int)(rng() % values.size());
+    if (rng() % 8 == 0)
+      id = id % 2 ? -id : id * 1000;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(map.erase(id), reference.erase(id) > 0);
+    } else {
+      int *value = &values[std::abs(id) % values.size()];
+      map.insert(id, value);
+      reference[id] = value;
+    }
+  }
+  ASSERT_EQ(map.size(), reference.size());
+  for (const auto &[id, value] : map)
+    EXPECT_EQ(reference.at(id), value);
+  for (const auto &[id, value] : reference)
+    EXPECT_EQ(map.get(map.handle(id)), value);
+}
+
+TEST(FlatHashMapTest, MatchesStdMapUnderRandomEdits) {
+  std::mt19937_64 rng(11);
+  FlatHashMap<int> map;
+  std::map<uint64_t, int> reference;
+  for (int step = 0; step < 50000; ++step) {
+    // Few distinct keys, so erases often hit long probe runs
+    uint64_t key = (rng() % 2000) << 32 | (rng() % 4);
+    if (rng() % 2 == 0) {
+      EXPECT_EQ(map.erase(key), reference.erase(key) > 0);
+    } else {
+      map.insert_or_assign(key, step);
+      reference[key] = step;
+    }
+  }
+  ASSERT_EQ(map.size(), reference.size());
+  for (const auto &[key, value] : reference) {
+    const int *found = map.find(key);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(*found, value);
+  }
+  EXPECT_EQ(map.find(uint64_t(1) << 40), nullptr);
+}
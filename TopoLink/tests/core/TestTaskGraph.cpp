@@ -0,0 +1,125 @@
+#include "TaskGraph.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(TaskGraphTest, RunsEveryTaskAfterItsDependencies) {
+  // Layers of 8 tasks, each depending on two tasks of the layer before
+  const int layers = 6, width = 8;
+  TaskGraph graph;
+  QMutex mutex;
+  std::vector<int> finishOrder;
+  for (int t = 0; t < layers * width; ++t) {
+    graph.addTask(
+        [&, t]() {
+          QMutexLocker locker(&mutex);
+          finishOrder.push_back(t);
+        },
+        1.0 + t % 3);
+  }
+  for (int l = 1; l < layers; ++l) {
+    for (int k = 0; k < width; ++k) {
+      graph.addDependency((l - 1) * width + k, l * width + k);
+      graph.addDependency((l - 1) * width + (k + 3) % width, l * width + k);
+    }
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  ASSERT_TRUE(graph.run(&pool));
+
+  ASSERT_EQ((int)finishOrder.size(), layers * width);
+  std::vector<int> position(layers * width, -1);
+  for (int k = 0; k < (int)finishOrder.size(); ++k) {
+    ASSERT_EQ(position[finishOrder[k]], -1); // Each task exactly once
+    position[finishOrder[k]] = k;
+  }
+  for (int l = 1; l < layers; ++l) {
+    for (int k = 0; k < width; ++k) {
+      int t = l * width + k;
+      EXPECT_LT(position[(l - 1) * width + k], position[t]);
+      EXPECT_LT(position[(l - 1) * width + (k + 3) % width], position[t]);
+    }
+  }
+}
+
+TEST(TaskGraphTest, StartsLongestCriticalPathFirst) {
+  // One thread, so the run order is the priority order
+  TaskGraph graph;
+  std::vector<int> order;
+  auto record = [&](int t) { return [&order, t]() { order.push_back(t); }; };
+  int small = graph.addTask(record(0), 1.0);
+  int large = graph.addTask(record(1), 10.0);
+  int medium = graph.addTask(record(2), 5.0);
+  // A cheap task feeding a huge one outranks all of them
+  int feeder = graph.addTask(record(3), 0.5);
+  int huge = graph.addTask(record(4), 100.0);
+  graph.addDependency(feeder, huge);
+
+  std::vector<double> priority = graph.priorities();
+  EXPECT_DOUBLE_EQ(priority[feeder], 100.5);
+  EXPECT_DOUBLE_EQ(priority[small], 1.0);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(1);
+  ASSERT_TRUE(graph.run(&pool));
+  EXPECT_EQ(order, (std::vector<int>{feeder, huge, large, medium, small}));
+}
+
+TEST(TaskGraphTest, RejectsCycles) {
+  TaskGraph graph;
+  int runs = 0;
+  int a = graph.addTask([&]() { ++runs; }, 1.0);
+  int b = graph.addTask([&]() { ++runs; }, 1.0);
+  graph.addDependency(a, b);
+  graph.addDependency(b, a);
+  EXPECT_TRUE(graph.priorities().empty());
+  EXPECT_FALSE(graph.run());
+  EXPECT_EQ(runs, 0);
+}
+
+TEST(TaskGraphTest, IdleHelpersLeaveThePoolToNestedWork) {
+  // While the first task runs, every helper has nothing to do. A
+  // blockingMap inside it must still get the pool's other threads.
+  QThreadPool *pool = QThreadPool::globalInstance();
+  const int maxThreads = pool->maxThreadCount();
+  pool->setMaxThreadCount(4);
+
+  std::atomic<int> inside{0}, peak{0};
+  auto item = [&](int) {
+    int now = ++inside;
+    int seen = peak.load();
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+    // Hold the item until three run at once, or give up after a while
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (peak < 3 && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    --inside;
+  };
+
+  TaskGraph graph;
+  int nested = graph.addTask(
+      [&]() {
+        // Wait until the helpers are idle, then map
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (pool->activeThreadCount() > 1 &&
+               std::chrono::steady_clock::now() < deadline)
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::vector<int> items(16);
+        QtConcurrent::blockingMap(items, item);
+      },
+      10.0);
+  for (int k = 0; k < 3; ++k)
+    graph.addDependency(nested, graph.addTask([]() {}, 1.0));
+
+  EXPECT_TRUE(graph.run(pool));
+  pool->setMaxThreadCount(maxThreads);
+  EXPECT_GE(peak.load(), 3);
+}
@@ -572,3 +572,203 @@ TEST_F(TopoTest, SplitEdge_Connectivity) {
     }
   }
 }
+
+TEST_F(TopoTest, RevisionStampsTrackEdits) {
+  TopoNode *n1 = topology.createNode(gp_Pnt(0, 0, 0));
+  TopoNode *n2 = topology.createNode(gp_Pnt(1, 0, 0));
+  TopoNode *n3 = topology.createNode(gp_Pnt(1, 1, 0));
+  TopoNode *n4 = topology.createNode(gp_Pnt(0, 1, 0));
+  TopoEdge *e1 = topology.createEdge(n1, n2);
+  TopoEdge *e2 = topology.createEdge(n2, n3);
+  TopoEdge *e3 = topology.createEdge(n3, n4);
+  TopoEdge *e4 = topology.createEdge(n4, n1);
+  TopoFace *face = topology.createFace({e1, e2, e3, e4});
+  ASSERT_NE(face, nullptr);
+
+  // Everything created so far is stamped at or below the current revision
+  const uint64_t seen = topology.getRevision();
+  EXPECT_GT(topology.getNodeRevision(n1->getID()), 0u);
+  EXPECT_LE(topology.getFaceRevision(face->getID()), seen);
+
+  topology.updateNodePosition(n3->getID(), gp_Pnt(1.2, 1.1, 0));
+  EXPECT_GT(topology.getNodeRevision(n3->getID()), seen);
+  EXPECT_LE(topology.getNodeRevision(n1->getID()), seen);
+
+  // Subdivisions propagate to the opposite edge of the quad
+  topology.propagateSubdivisions(e1->getID(), 7);
+  EXPECT_GT(topology.getEdgeRevision(e1->getID()), seen);
+  EXPECT_GT(topology.getEdgeRevision(e3->getID()), seen);
+  EXPECT_LE(topology.getEdgeRevision(e2->getID()), seen);
+  EXPECT_LE(topology.getEdgeRevision(e4->getID()), seen);
+
+  // Stamps go away with the entity
+  int faceId = face->getID();
+  topology.deleteFace(faceId);
+  EXPECT_EQ(topology.getFaceRevision(faceId), 0u);
+}
+
+TEST_F(TopoTest, GroupLookupsFollowEdits) {
+  TopoNode *n1 = topology.createNode(gp_Pnt(0, 0, 0));
+  TopoNode *n2 = topology.createNode(gp_Pnt(1, 0, 0));
+  TopoNode *n3 = topology.createNode(gp_Pnt(1, 1, 0));
+  TopoNode *n4 = topology.createNode(gp_Pnt(0, 1, 0));
+  TopoEdge *e1 = topology.createEdge(n1, n2);
+  TopoEdge *e2 = topology.createEdge(n2, n3);
+  TopoEdge *e3 = topology.createEdge(n3, n4);
+  TopoEdge *e4 = topology.createEdge(n4, n1);
+  TopoFace *face = topology.createFace({e1, e2, e3, e4});
+  ASSERT_NE(face, nullptr);
+
+  TopoEdgeGroup *wall = topology.createEdgeGroup("Wall", "geo_wall");
+  TopoEdgeGroup *inlet = topology.createEdgeGroup("Inlet", "geo_inlet");
+  TopoFaceGroup *body = topology.createFaceGroup("Body", "geo_body");
+
+  // The group with the lowest ID wins, whatever the insertion order
+  topology.addEdgeToGroup(inlet->id, e1);
+  topology.addEdgeToGroup(wall->id, e1);
+  topology.addEdgeToGroup(wall->id, e1); // Already a member
+  topology.addFaceToGroup(body->id, face);
+  EXPECT_EQ(topology.getGroupForEdge(e1->getID()), wall);
+  EXPECT_EQ(wall->edges.size(), 1u);
+  EXPECT_EQ(topology.getGroupForEdge(e2->getID()), nullptr);
+  EXPECT_EQ(topology.getFaceGeometryID(face->getID()), "geo_body");
+
+  // Splitting hands the groups on to the new edges and faces
+  int oldEdge = e1->getID(), oldFace = face->getID();
+  ASSERT_NE(topology.splitEdge(oldEdge, 0.5), nullptr);
+  EXPECT_EQ(topology.getGroupForEdge(oldEdge), nullptr);
+  EXPECT_EQ(topology.getGroupForFace(oldFace), nullptr);
+  EXPECT_EQ(wall->edges.size(), 2u);
+  EXPECT_EQ(inlet->edges.size(), 2u);
+  for (TopoEdge *edge : wall->edges)
+    EXPECT_EQ(topology.getGroupForEdge(edge->getID()), wall);
+  ASSERT_EQ(body->faces.size(), 2u);
+  for (TopoFace *f : body->faces)
+    EXPECT_EQ(topology.getFaceGeometryID(f->getID()), "geo_body");
+
+  // Deleting or clearing drops the membership
+  int splitEdge = wall->edges.front()->getID();
+  topology.deleteEdge(splitEdge);
+  EXPECT_EQ(topology.getGroupForEdge(splitEdge), nullptr);
+  EXPECT_EQ(wall->edges.size(), 1u);
+  int remaining = wall->edges.front()->getID();
+  topology.clearEdgeGroup(wall->id);
+  EXPECT_EQ(topology.getGroupForEdge(remaining), inlet);
+
+  int grouped = body->faces.front()->getID();
+  topology.clearGroups();
+  EXPECT_EQ(topology.getGroupForEdge(remaining), nullptr);
+  EXPECT_EQ(topology.getFaceGeometryID(grouped), "");
+}
+
+TEST_F(TopoTest, GroupGeometryIdsParsedOnCreation) {
+  EXPECT_EQ(Topology::parseGeometryIds(" 12,3, 7,,x,3 "),
+            std::vector<int>({3, 7, 12}));
+  EXPECT_TRUE(Topology::parseGeometryIds("").empty());
+  EXPECT_TRUE(Topology::parseGeometryIds("geo_face").empty());
+  EXPECT_EQ(Topology::formatGeometryIds({12, 3, 7, 3}), "3,7,12");
+
+  TopoFaceGroup *faces = topology.createFaceGroup("Body", "5,2");
+  EXPECT_EQ(faces->geometryIds, std::vector<int>({2, 5}));
+  TopoEdgeGroup *edges =
+      topology.createEdgeGroup("Rim", std::vector<int>{9, 4});
+  EXPECT_EQ(edges->geometryID, "4,9");
+  EXPECT_EQ(edges->geometryIds, std::vector<int>({4, 9}));
+}
+
+TEST_F(TopoTest, HandlesOutliveOtherEdits) {
+  TopoNode *n1 = topology.createNode(gp_Pnt(0, 0, 0));
+  TopoNode *n2 = topology.createNode(gp_Pnt(1, 0, 0));
+  TopoNode *n3 = topology.createNode(gp_Pnt(1, 1, 0));
+  TopoEdge *e1 = topology.createEdge(n1, n2);
+  TopoEdge *e2 = topology.createEdge(n2, n3);
+  Topology::EdgeHandle h1 = topology.getEdgeHandle(e1->getID());
+  Topology::EdgeHandle h2 = topology.getEdgeHandle(e2->getID());
+  Topology::NodeHandle h3 = topology.getNodeHandle(n3->getID());
+  EXPECT_EQ(topology.getEdge(h1), e1);
+
+  // Deleting e1 moves e2 in storage; its handle and lookups still work
+  topology.deleteEdge(e1->getID());
+  EXPECT_EQ(topology.getEdge(h1), nullptr);
+  EXPECT_EQ(topology.getEdge(h2), e2);
+  EXPECT_EQ(topology.getEdge(n3, n2), e2);
+  EXPECT_EQ(topology.getEdge(n1, n2), nullptr);
+
+  topology.deleteNode(n3->getID());
+  EXPECT_EQ(topology.getNode(h3), nullptr);
+  EXPECT_EQ(topology.getEdge(h2), nullptr);
+  EXPECT_EQ(topology.getEdges().size(), 0u);
+}
+
+TEST_F(TopoTest, AcceptsNegativeAndSparseIds) {
+  // IDs are taken verbatim from files, so they need not be small
+  TopoNode *low = topology.createNodeWithID(-4, gp_Pnt(0, 0, 0));
+  TopoNode *high = topology.createNodeWithID(5000000, gp_Pnt(1, 0, 0));
+  TopoEdge *edge = topology.createEdgeWithID(-9, low, high);
+  ASSERT_NE(edge, nullptr);
+  EXPECT_EQ(topology.getNode(-4), low);
+  EXPECT_EQ(topology.getNode(5000000), high);
+  EXPECT_EQ(topology.getEdge(-9), edge);
+  EXPECT_EQ(topology.getEdge(high, low), edge);
+  EXPECT_EQ(topology.createNode(gp_Pnt(2, 0, 0))->getID(), 5000001);
+
+  topology.deleteNode(-4);
+  EXPECT_EQ(topology.getNode(-4), nullptr);
+  EXPECT_EQ(topology.getEdge(-9), nullptr);
+  EXPECT_EQ(topology.getNodes().size(), 2u);
+}
+
+TEST_F(TopoTest, NodeStarsFollowMergeAndDelete) {
+  // Two quads side by side: a0 a1 a2 along the bottom, b0 b1 b2 on top
+  std::vector<TopoNode *> a, b;
+  for (int i = 0; i < 3; ++i) {
+    a.push_back(topology.createNode(gp_Pnt(i, 0, 0)));
+    b.push_back(topology.createNode(gp_Pnt(i, 1, 0)));
+  }
+  std::vector<TopoEdge *> bottom, top, sides;
+  for (int i = 0; i < 2; ++i) {
+    bottom.push_back(topology.createEdge(a[i], a[i + 1]));
+    top.push_back(topology.createEdge(b[i], b[i + 1]));
+  }
+  for (int i = 0; i < 3; ++i)
+    sides.push_back(topology.createEdge(a[i], b[i]));
+  topology.createFace({bottom[0], sides[1], top[0], sides[0]});
+  int right =
+      topology.createFace({bottom[1], sides[2], top[1], sides[1]})->getID();
+
+  auto degree = [](TopoNode *node) {
+    int n = 0;
+    for (TopoHalfEdge *he : node->outgoing()) {
+      EXPECT_EQ(he->origin, node);
+      ++n;
+    }
+    return n;
+  };
+  EXPECT_EQ(degree(a[1]), 3);
+  EXPECT_EQ(degree(b[2]), 2);
+
+  // Collapsing the right side turns the right quad into a triangle
+  int bTop = top[1]->getID();
+  ASSERT_TRUE(topology.mergeNodes(a[2]->getID(), b[2]->getID()));
+  EXPECT_EQ(topology.getFace(right), nullptr);
+  EXPECT_EQ(topology.getFaces().size(), 1u);
+  EXPECT_EQ(topology.getEdges().size(), 6u);
+  EXPECT_EQ(degree(a[2]), 2);
+  EXPECT_EQ(topology.getEdge(b[1], a[2]), topology.getEdge(bTop));
+
+  // Deleting a node takes exactly its star, and faces with it
+  topology.deleteNode(a[1]->getID());
+  EXPECT_EQ(topology.getEdges().size(), 3u);
+  EXPECT_TRUE(topology.getFaces().empty());
+  EXPECT_EQ(degree(a[0]), 1);
+  EXPECT_EQ(degree(a[2]), 1);
+
+  // Merging b0 into a2 makes b0-b1 parallel to the old b1-b2; the older
+  // edge stays
+  int older = top[0]->getID();
+  ASSERT_TRUE(topology.mergeNodes(a[2]->getID(), b[0]->getID()));
+  EXPECT_EQ(topology.getEdge(a[2], b[1])->getID(), older);
+  EXPECT_EQ(topology.getEdges().size(), 2u);
+  EXPECT_EQ(degree(a[2]), 2);
+  EXPECT_EQ(degree(b[1]), 1);
+}
@@ -0,0 +1,122 @@
+#include "WarmStart.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Sides of the grid (i, j) -> (x(i), y(j)) in Smoother's loop order
+std::vector<std::vector<gp_Pnt>> sides(const StructuredGrid &grid) {
+  const int M = grid.rows() - 1, N = grid.cols() - 1;
+  std::vector<std::vector<gp_Pnt>> b(4);
+  for (int i = 0; i <= M; ++i)
+    b[0].push_back(grid.point(i, 0));
+  for (int j = 0; j <= N; ++j)
+    b[1].push_back(grid.point(M, j));
+  for (int i = M; i >= 0; --i)
+    b[2].push_back(grid.point(i, N));
+  for (int j = N; j >= 0; --j)
+    b[3].push_back(grid.point(0, j));
+  return b;
+}
+
+// Graded tensor grid on [0, 1]^2: points cluster towards x = 0 and y = 0
+StructuredGrid gradedGrid(int M, int N) {
+  StructuredGrid grid(M, N);
+  for (int i = 0; i <= M; ++i) {
+    for (int j = 0; j <= N; ++j) {
+      double x = std::pow((double)i / M, 2.0);
+      double y = std::pow((double)j / N, 2.0);
+      grid.setPoint(i, j, gp_Pnt(x, y, 0.0));
+    }
+  }
+  return grid;
+}
+
+} // namespace
+
+TEST(WarmStartTest, EdgeKeepsSpacingAndFollowsEnds) {
+  // Old edge clustered towards its start
+  std::vector<gp_Pnt> previous;
+  for (int i = 0; i <= 4; ++i) {
+    double s = (double)i / 4;
+    previous.push_back(gp_Pnt(s * s, 0, 0));
+  }
+
+  // Same subdivisions, end node moved up: ends exact, spacing kept
+  std::vector<gp_Pnt> moved =
+      WarmStart::resampleEdge(previous, gp_Pnt(0, 0, 0), gp_Pnt(1, 1, 0), 4);
+  ASSERT_EQ(moved.size(), 5u);
+  EXPECT_NEAR(moved[4].Y(), 1.0, 1e-12);
+  EXPECT_NEAR(moved[2].X(), 0.25, 1e-12);
+  EXPECT_NEAR(moved[2].Y(), 0.5, 1e-12);
+
+  // Doubled subdivisions: old points reappear at every other index
+  std::vector<gp_Pnt> finer =
+      WarmStart::resampleEdge(previous, gp_Pnt(0, 0, 0), gp_Pnt(1, 0, 0), 8);
+  ASSERT_EQ(finer.size(), 9u);
+  for (int i = 0; i <= 4; ++i)
+    EXPECT_NEAR(finer[2 * i].Distance(previous[i]), 0.0, 1e-12);
+  EXPECT_NEAR(finer[1].X(), 0.5 * previous[1].X(), 1e-12);
+
+  // An edge that now runs the other way is not reused
+  EXPECT_TRUE(
+      WarmStart::resampleEdge(previous, gp_Pnt(1, 0, 0), gp_Pnt(0, 0, 0), 4)
+          .empty());
+}
+
+TEST(WarmStartTest, GridResamplesAndFitsNewBoundary) {
+  StructuredGrid previous = gradedGrid(8, 6);
+
+  // Refined: the resampled grid interpolates the old one bilinearly
+  StructuredGrid refinedTarget = gradedGrid(16, 12);
+  std::vector<std::vector<gp_Pnt>> boundaries(4);
+  {
+    // Boundary of the bilinear refinement of the old grid
+    StructuredGrid bilinear(16, 12);
+    for (int i = 0; i <= 16; ++i) {
+      for (int j = 0; j <= 12; ++j) {
+        const gp_Pnt a = previous.point(i / 2, j / 2);
+        const gp_Pnt b = previous.point((i + 1) / 2, (j + 1) / 2);
+        bilinear.setPoint(i, j, gp_Pnt(0.5 * (a.X() + b.X()),
+                                       0.5 * (a.Y() + b.Y()), 0.0));
+      }
+    }
+    boundaries = sides(bilinear);
+  }
+  StructuredGrid refined;
+  ASSERT_TRUE(WarmStart::resampleGrid(previous, boundaries, refined));
+  ASSERT_EQ(refined.rows(), 17);
+  ASSERT_EQ(refined.cols(), 13);
+  for (int i = 0; i <= 8; ++i) {
+    for (int j = 0; j <= 6; ++j) {
+      EXPECT_NEAR(refined.point(2 * i, 2 * j).Distance(previous.point(i, j)),
+                  0.0, 1e-12);
+    }
+  }
+  EXPECT_LT(refined.point(5, 5).Distance(refinedTarget.point(5, 5)), 0.02);
+
+  // Same size, boundary translated: every point follows it exactly
+  StructuredGrid moved = previous;
+  for (int i = 0; i <= 8; ++i) {
+    for (int j = 0; j <= 6; ++j) {
+      gp_Pnt p = previous.point(i, j);
+      moved.setPoint(i, j, gp_Pnt(p.X() + 0.2, p.Y() - 0.1, p.Z() + 0.3));
+    }
+  }
+  StructuredGrid fitted;
+  ASSERT_TRUE(WarmStart::resampleGrid(previous, sides(moved), fitted));
+  for (int i = 0; i <= 8; ++i) {
+    for (int j = 0; j <= 6; ++j)
+      EXPECT_NEAR(fitted.point(i, j).Distance(moved.point(i, j)), 0.0, 1e-12);
+  }
+}
+
+TEST(WarmStartTest, GridRejectsRotatedLoop) {
+  StructuredGrid previous = gradedGrid(4, 4);
+  std::vector<std::vector<gp_Pnt>> b = sides(previous);
+  // Same face, loop now starting at the next corner
+  std::vector<std::vector<gp_Pnt>> rotated = {b[1], b[2], b[3], b[0]};
+  StructuredGrid grid;
+  EXPECT_FALSE(WarmStart::resampleGrid(previous, rotated, grid));
+  EXPECT_TRUE(grid.empty());
+}